@@ -3,11 +3,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
 #include <time.h>
+#include <stdatomic.h>
 #define CloseWindow CloseWindow_Win
 #define ShowCursor ShowCursor_Win
 #define DrawText DrawText_Win
 #define Rectangle Rectangle_Win
+#include <pthread.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #include <curl/curl.h>
 #include <cjson/cJSON.h>
 #undef CloseWindow
@@ -20,17 +33,57 @@
 #define GROQ_API_KEY "sua_chave_api"
 #define GROQ_API_URL "https://api.groq.com/openai/v1/chat/completions"
 #define GROQ_MODEL "llama-3.3-70b-versatile"
+#define GROQ_MODEL_RAPIDO "llama-3.1-8b-instant"
+// Limites da conta na Groq - o agendador nunca ultrapassa esses valores
+// Podem ser sobrescritos pelas variáveis de ambiente GROQ_RPM e GROQ_TPM
+#define GROQ_LIMITE_RPM 30
+#define GROQ_LIMITE_TPM 6000
+#define GROQ_MAX_TOKENS 20
+#define GROQ_TENTATIVAS 3
 #define SCREEN_WIDTH 1280
 #define SCREEN_HEIGHT 720
 #define PECA_WIDTH 60
 #define PECA_HEIGHT 120
+// Conjunto de peças, escolhido na compilação: duplo-6 (28 peças, padrão),
+// duplo-9 (55) ou duplo-12 (91) com -DMAX_PONTO=9 ou -DMAX_PONTO=12.
+// Tamanhos de vetores, largura das máscaras e tabelas saem daqui, sem desvios
+// em tempo de execução
+#ifndef MAX_PONTO
+#define MAX_PONTO 6
+#endif
+#define NUM_PONTOS (MAX_PONTO + 1)
+#define NUM_PECAS (NUM_PONTOS * (NUM_PONTOS + 1) / 2)
+#ifndef PECAS_POR_MAO
+#if MAX_PONTO <= 6
+#define PECAS_POR_MAO 6
+#else
+#define PECAS_POR_MAO 7
+#endif
+#endif
+#define PECAS_MONTE (NUM_PECAS - 2 * PECAS_POR_MAO)
+// Soma dos pontos de todas as peças (cada número aparece NUM_PONTOS + 1 vezes)
+#define PONTOS_BARALHO (MAX_PONTO * NUM_PECAS)
+_Static_assert(MAX_PONTO >= 2 && MAX_PONTO <= 12, "conjuntos suportados: duplo-2 a duplo-12");
+_Static_assert(PECAS_MONTE >= 0, "pecas insuficientes para as duas maos");
 
 // Estrutura que representa uma peça de dominó
 typedef struct
 {
-    int lado1, lado2; // Valores de cada lado da peça (0-6)
+    int lado1, lado2; // Valores de cada lado da peça (0 a MAX_PONTO)
 } Peca;
 
+// Conjunto de peças como máscara de bits (uma peça = um bit), no menor
+// inteiro que comporta o conjunto
+#if NUM_PECAS <= 32
+typedef uint32_t MascaraPecas;
+#elif NUM_PECAS <= 64
+typedef uint64_t MascaraPecas;
+#else
+typedef unsigned __int128 MascaraPecas;
+#endif
+#define BIT_PECA(i) ((MascaraPecas)1 << (i))
+#define TODAS_PECAS ((BIT_PECA(NUM_PECAS - 1) << 1) - 1)
+
 // Lista duplamente encadeada - usado no tabuleiro
 typedef struct No
 {
@@ -42,6 +95,8 @@ typedef struct
 {
     No *inicio, *fim;
     int pontoInicio, pontoFim;
+    uint64_t chave; // chave Zobrist das duas pontas
+    int pecasPorPonto[NUM_PONTOS]; // peças na mesa com cada número (a dupla conta uma vez)
 } Tabuleiro;
 
 // Lista encadeada simples - usado na mão dos jogadores
@@ -57,6 +112,9 @@ typedef struct
 {
     NoMao *pecas;
     int quantidade;
+    int pontos;    // soma dos lados das peças, mantida a cada entrada e saída
+    int jogador;   // 0 = humano, 1 = IA (escolhe a tabela Zobrist)
+    uint64_t chave; // XOR das chaves das peças na mão
 } Mao;
 
 // Pilha LIFO (Last In, First Out) - monte de compras
@@ -64,33 +122,73 @@ typedef struct
 // Comportamento similar a uma pilha de pratos
 typedef struct
 {
-    Peca pecas[16];
+    Peca pecas[PECAS_MONTE];
     int topo;
+    uint64_t chave; // chave Zobrist da quantidade de peças
 } Monte;
 
+// Limite teórico de lances numa partida: cada peça é jogada e comprada no
+// máximo uma vez, e entre duas jogadas cabe no máximo um passe (dois encerram)
+#define MAX_JOGADAS (3 * NUM_PECAS + 2)
+
 typedef struct
 {
     int jogador;
     Peca peca;
     char lado, tipo;
+    // Dados para desfazer - só em lances aplicados por fazerJogada()
+    char desfazivel;
+    int passadasAntes;
+    NoMao *noMao, *anterior; // nó que saiu da mão e seu antecessor na lista
+    No noMesa;               // nó da mesa: vive na própria pilha, sem malloc
+    NoMao noCompra;          // nó da peça comprada, idem
 } Jogada;
 
+// Pilha de lances da partida - também é a pilha de desfazer
+// Como nunca passa de MAX_JOGADAS, não precisa crescer nem alocar
 typedef struct
 {
-    Jogada jogadas[100];
+    Jogada jogadas[MAX_JOGADAS];
     int topo;
 } Historico;
 
+// Referências às estruturas de uma partida, usadas por fazerJogada/desfazerJogada
+typedef struct
+{
+    Tabuleiro *tab;
+    Mao *maos[2]; // [0] = jogador 1 (humano), [1] = jogador 2 (IA)
+    Monte *monte;
+    Historico *hist;
+    int *passadas;
+} Partida;
+
 typedef enum
 {
     TELA_MENU,
     TELA_JOGO,
     TELA_REGRAS,
+    TELA_DESAFIOS,
     TELA_SOBRE,
     TELA_FIM
 } EstadoJogo;
 
+// Quem decide a jogada da IA: o modelo na Groq, a busca local, o MCTS, a
+// heurística com pesos ajustados ou a política destilada
+// (DOMINO_MOTOR=busca, mcts, heuristica ou destilada)
+typedef enum
+{
+    MOTOR_GROQ,
+    MOTOR_BUSCA,
+    MOTOR_MCTS,
+    MOTOR_HEURISTICA,
+    MOTOR_DESTILADA
+} MotorIA;
+
 EstadoJogo estadoAtual = TELA_MENU;
+MotorIA motorIA = MOTOR_GROQ;
+const char *modeloGroq = GROQ_MODEL; // escolhido pelo nível de dificuldade
+const char *urlGroq = GROQ_API_URL;   // GROQ_URL aponta para outro servidor compatível (ex.: um simulado)
+double tetoGroq = 30.0;              // segundos por jogada, somando esperas e tentativas
 Tabuleiro tabuleiro;
 Mao maoHumano, maoIA;
 Monte monte;
@@ -106,6 +204,21 @@ Peca ultimaPecaIA = {-1, -1};
 char ultimoLadoIA = '-';
 int mostrarJogadaIA = 0;
 int tempoJogadaIA = 0;
+Partida partidaAtual = {&tabuleiro, {&maoHumano, &maoIA}, &monte, &historico, &passadas};
+
+// Tabelas de peças e chaves Zobrist, montadas uma vez por inicializarMotor()
+// A chave do jogo é o XOR das chaves das peças em cada mão, das duas pontas,
+// da quantidade no monte, de quem joga e do contador de passadas
+Peca pecaMotor[NUM_PECAS];              // índice -> peça (lado1 <= lado2)
+int indicePeca[NUM_PONTOS][NUM_PONTOS]; // peça -> índice
+int pontosPeca[NUM_PECAS];              // soma dos dois lados
+MascaraPecas pecasComPonto[NUM_PONTOS]; // peças que têm o número p
+uint64_t binomial[NUM_PECAS + 1][NUM_PECAS + 1]; // C(n, k), para numerar subconjuntos de peças
+uint64_t zobMao[2][NUM_PECAS], zobMonte[NUM_PECAS], zobQtdMonte[NUM_PECAS + 1];
+uint64_t zobPonta[2][NUM_PONTOS + 1], zobVez, zobPassadas[3];
+// Ponta vazia (-1) usa a última posição da tabela
+#define ZOB_PONTA(l, p) zobPonta[l][(p) < 0 ? NUM_PONTOS : (p)]
+#define ZOB_PECA(j, p) zobMao[j][indicePeca[(p).lado1][(p).lado2]]
 
 typedef struct
 {
@@ -113,15 +226,96 @@ typedef struct
     size_t size;
 } HttpResponse;
 
+// Prioridade de uma chamada à API: mesas com humano sempre passam na frente
+// de trabalhos em segundo plano (avaliações, torneios, simulações)
+typedef enum
+{
+    PRIORIDADE_MESA,
+    PRIORIDADE_FUNDO
+} PrioridadeAPI;
+
+// Balde de fichas (token bucket) - agendador de chamadas à API Groq
+// Dois baldes recarregam continuamente: requisições/minuto e tokens/minuto
+// Cada chamada consome 1 requisição + tokens estimados pelo tamanho do prompt
+// Os cabeçalhos x-ratelimit-* da resposta corrigem os baldes com o valor real
+typedef struct
+{
+    pthread_mutex_t trava;
+    pthread_cond_t liberado;
+    int configurado;
+    double requisicoes, tokens;          // fichas disponíveis agora
+    double limiteReq, limiteTok;         // capacidade por minuto
+    double ultimaRecarga, bloqueadoAte;  // em segundos (relógio monotônico)
+    int mesasEsperando;
+} Agendador;
+
+Agendador agendador = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER};
+
+// Valores lidos dos cabeçalhos de limite da resposta (-1 = ausente)
+typedef struct
+{
+    double restantesReq, restantesTok;
+    double resetReq, resetTok, retryAfter;
+} LimitesResposta;
+
+// Fita de gravação/reprodução (cassete) das chamadas à API
+// GRAVAR: salva cada par prompt/resposta com a latência medida
+// REPRODUZIR: devolve as respostas do disco, sem rede - benchmarks determinísticos
+typedef enum
+{
+    FITA_DESLIGADA,
+    FITA_GRAVAR,
+    FITA_REPRODUZIR
+} ModoFita;
+
+typedef struct
+{
+    char *prompt, *resposta; // resposta NULL = chamada que falhou
+    double latencia;
+    int usada;
+} EntradaFita;
+
+typedef struct
+{
+    ModoFita modo;
+    char arquivo[256];
+    int respeitarLatencia; // reproduz com a latência original da rede
+    EntradaFita *entradas;
+    int quantidade, capacidade;
+    int acertos, faltas;
+    pthread_mutex_t trava;
+} Fita;
+
+Fita fita = {FITA_DESLIGADA, "", 0, NULL, 0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER};
+
+// Bytes trafegados pelas chamadas à API (cabeçalhos + corpo, como vão na rede)
+typedef struct
+{
+    long chamadas;
+    long long enviados, recebidos, descomprimidos;
+    pthread_mutex_t trava;
+} EstatisticasRede;
+
+EstatisticasRede estatisticasRede = {0, 0, 0, 0, PTHREAD_MUTEX_INITIALIZER};
+
 void inicializar(Tabuleiro *tab, Mao *j1, Mao *j2, Monte *monte, Historico *hist)
 {
     tab->inicio = tab->fim = NULL;
     tab->pontoInicio = tab->pontoFim = -1;
+    tab->chave = ZOB_PONTA(0, -1) ^ ZOB_PONTA(1, -1);
+    memset(tab->pecasPorPonto, 0, sizeof(tab->pecasPorPonto));
     j1->pecas = NULL;
     j1->quantidade = 0;
+    j1->pontos = 0;
+    j1->jogador = 0;
+    j1->chave = 0;
     j2->pecas = NULL;
     j2->quantidade = 0;
+    j2->pontos = 0;
+    j2->jogador = 1;
+    j2->chave = 0;
     monte->topo = -1;
+    monte->chave = zobQtdMonte[0];
     hist->topo = -1;
 }
 // Adiciona uma peça no início da lista (mão do jogador)
@@ -135,6 +329,8 @@ void adicionarPeca(Mao *mao, Peca peca)
     novo->proximo = mao->pecas;
     mao->pecas = novo;
     mao->quantidade++;
+    mao->pontos += peca.lado1 + peca.lado2;
+    mao->chave ^= ZOB_PECA(mao->jogador, peca);
 }
 // Remove uma peça específica da mão do jogador
 // Busca linear O(n) - percorre a lista até encontrar a peça
@@ -150,6 +346,8 @@ int removerPeca(Mao *mao, int lado1, int lado2)
                 anterior->proximo = atual->proximo;
             else
                 mao->pecas = atual->proximo;
+            mao->chave ^= ZOB_PECA(mao->jogador, atual->peca);
+            mao->pontos -= atual->peca.lado1 + atual->peca.lado2;
             free(atual);
             mao->quantidade--;
             return 1;
@@ -165,11 +363,11 @@ void ordenarMao(Mao *mao)
     if (mao->quantidade <= 1)
         return;
 
-    Peca temp[20];
+    Peca temp[NUM_PECAS];
     NoMao *atual = mao->pecas;
     int i = 0;
 
-    while (atual && i < 20)
+    while (atual && i < NUM_PECAS)
     {
         temp[i] = atual->peca;
         atual = atual->proximo;
@@ -205,18 +403,16 @@ void ordenarMao(Mao *mao)
 
     mao->pecas = NULL;
     mao->quantidade = 0;
+    mao->pontos = 0;
+    mao->chave = 0; // as mesmas peças voltam e restauram a chave e os pontos
 
     for (i = 0; i < total; i++)
         adicionarPeca(mao, temp[i]);
 }
-// Calcula a pontuação total somando os valores de todas as peças
-// Percorre a lista encadeada acumulando os valores
+// Pontuação total da mão: O(1), o total acompanha cada peça que entra ou sai
 int calcularPontos(Mao *mao)
 {
-    int total = 0;
-    for (NoMao *atual = mao->pecas; atual; atual = atual->proximo)
-        total += atual->peca.lado1 + atual->peca.lado2;
-    return total;
+    return mao->pontos;
 }
 // Verifica se uma peça pode ser encaixada no tabuleiro
 // Checa se algum lado da peça corresponde às pontas do tabuleiro
@@ -227,23 +423,45 @@ int encaixa(Tabuleiro *tab, Peca peca)
     return (peca.lado1 == tab->pontoInicio || peca.lado2 == tab->pontoInicio ||
             peca.lado1 == tab->pontoFim || peca.lado2 == tab->pontoFim);
 }
-// Insere peça no tabuleiro (lista duplamente encadeada)
+// Troca as pontas do tabuleiro mantendo a chave Zobrist em dia (sai a antiga, entra a nova)
+static void atualizarPontas(Tabuleiro *tab, int inicio, int fim)
+{
+    tab->chave ^= ZOB_PONTA(0, tab->pontoInicio) ^ ZOB_PONTA(1, tab->pontoFim);
+    tab->pontoInicio = inicio;
+    tab->pontoFim = fim;
+    tab->chave ^= ZOB_PONTA(0, inicio) ^ ZOB_PONTA(1, fim);
+}
+
+// Conta (delta = 1) ou descarta (delta = -1) os números de uma peça da mesa
+static int contarPontosMesa(Tabuleiro *tab, Peca peca, int delta)
+{
+    tab->pecasPorPonto[peca.lado1] += delta;
+    if (peca.lado2 != peca.lado1)
+        tab->pecasPorPonto[peca.lado2] += delta;
+    return 1;
+}
+
+// Jogo travado: todas as NUM_PONTOS peças de cada número das pontas já estão na mesa,
+// então ninguém (nem comprando) vai jogar de novo
+int jogoTravado(const Tabuleiro *tab)
+{
+    return tab->inicio && tab->pecasPorPonto[tab->pontoInicio] == NUM_PONTOS &&
+           tab->pecasPorPonto[tab->pontoFim] == NUM_PONTOS;
+}
+
+// Encaixa um nó já existente no tabuleiro (lista duplamente encadeada)
 // Permite inserção na esquerda ou direita, invertendo a peça se necessário
-int inserir(Tabuleiro *tab, Peca peca, char lado)
+static int encaixarNo(Tabuleiro *tab, No *novo, char lado)
 {
-    No *novo = (No *)malloc(sizeof(No));
-    if (!novo)
-        return 0;
-    novo->peca = peca;
+    Peca peca = novo->peca;
     novo->prox = novo->ant = NULL;
 
     // Primeira peça do tabuleiro
     if (!tab->inicio)
     {
         tab->inicio = tab->fim = novo;
-        tab->pontoInicio = peca.lado1;
-        tab->pontoFim = peca.lado2;
-        return 1;
+        atualizarPontas(tab, peca.lado1, peca.lado2);
+        return contarPontosMesa(tab, peca, 1);
     }
 
     // Inserção na esquerda
@@ -254,8 +472,8 @@ int inserir(Tabuleiro *tab, Peca peca, char lado)
             novo->prox = tab->inicio;
             tab->inicio->ant = novo;
             tab->inicio = novo;
-            tab->pontoInicio = peca.lado1;
-            return 1;
+            atualizarPontas(tab, peca.lado1, tab->pontoFim);
+            return contarPontosMesa(tab, peca, 1);
         }
         else if (peca.lado1 == tab->pontoInicio)
         {
@@ -265,8 +483,8 @@ int inserir(Tabuleiro *tab, Peca peca, char lado)
             novo->prox = tab->inicio;
             tab->inicio->ant = novo;
             tab->inicio = novo;
-            tab->pontoInicio = novo->peca.lado1;
-            return 1;
+            atualizarPontas(tab, novo->peca.lado1, tab->pontoFim);
+            return contarPontosMesa(tab, peca, 1);
         }
     }
 
@@ -278,8 +496,8 @@ int inserir(Tabuleiro *tab, Peca peca, char lado)
             tab->fim->prox = novo;
             novo->ant = tab->fim;
             tab->fim = novo;
-            tab->pontoFim = peca.lado2;
-            return 1;
+            atualizarPontas(tab, tab->pontoInicio, peca.lado2);
+            return contarPontosMesa(tab, peca, 1);
         }
         else if (peca.lado2 == tab->pontoFim)
         {
@@ -289,10 +507,22 @@ int inserir(Tabuleiro *tab, Peca peca, char lado)
             tab->fim->prox = novo;
             novo->ant = tab->fim;
             tab->fim = novo;
-            tab->pontoFim = novo->peca.lado2;
-            return 1;
+            atualizarPontas(tab, tab->pontoInicio, novo->peca.lado2);
+            return contarPontosMesa(tab, peca, 1);
         }
     }
+    return 0;
+}
+
+// Insere peça no tabuleiro, alocando um nó novo
+int inserir(Tabuleiro *tab, Peca peca, char lado)
+{
+    No *novo = (No *)malloc(sizeof(No));
+    if (!novo)
+        return 0;
+    novo->peca = peca;
+    if (encaixarNo(tab, novo, lado))
+        return 1;
     free(novo);
     return 0;
 }
@@ -304,17 +534,17 @@ int contarJogadas(Mao *mao, Tabuleiro *tab)
             count++;
     return count;
 }
-// Cria as 28 peças do dominó (0-0 até 6-6) e embaralha
-void embaralhar(Peca baralho[28])
+// Cria as peças do dominó (0-0 até MAX_PONTO-MAX_PONTO) e embaralha
+void embaralhar(Peca baralho[NUM_PECAS])
 {
     int index = 0;
     // Gera todas as combinações possíveis
-    for (int i = 0; i <= 6; i++)
-        for (int j = i; j <= 6; j++)
+    for (int i = 0; i <= MAX_PONTO; i++)
+        for (int j = i; j <= MAX_PONTO; j++)
             baralho[index++] = (Peca){i, j};
     // Algoritmo Fisher-Yates para embaralhar
     // Garante distribuição uniforme - cada peça tem chance igual de ficar em qualquer posição
-    for (int i = 27; i > 0; i--)
+    for (int i = NUM_PECAS - 1; i > 0; i--)
     {
         int j = rand() % (i + 1);
         Peca temp = baralho[i];
@@ -322,19 +552,20 @@ void embaralhar(Peca baralho[28])
         baralho[j] = temp;
     }
 }
-// Distribui 6 peças para cada jogador e restante vai para o monte
+// Distribui PECAS_POR_MAO peças para cada jogador e restante vai para o monte
 void distribuir(Mao *j1, Mao *j2, Monte *monte)
 {
-    Peca baralho[28];
+    Peca baralho[NUM_PECAS];
     embaralhar(baralho);
-    // Cada jogador recebe 6 peças
-    for (int i = 0; i < 6; i++)
+    // Cada jogador recebe PECAS_POR_MAO peças
+    for (int i = 0; i < PECAS_POR_MAO; i++)
         adicionarPeca(j1, baralho[i]);
-    for (int i = 6; i < 12; i++)
+    for (int i = PECAS_POR_MAO; i < 2 * PECAS_POR_MAO; i++)
         adicionarPeca(j2, baralho[i]);
-    // Restante das peças (16) vai para a pilha do monte
-    for (int i = 12; i < 28; i++)
+    // Restante das peças (PECAS_MONTE) vai para a pilha do monte
+    for (int i = 2 * PECAS_POR_MAO; i < NUM_PECAS; i++)
         monte->pecas[++monte->topo] = baralho[i];
+    monte->chave = zobQtdMonte[monte->topo + 1];
 }
 // Compra uma peça do monte (operação POP da pilha)
 int comprar(Monte *monte, Peca *peca)
@@ -342,366 +573,6304 @@ int comprar(Monte *monte, Peca *peca)
     if (monte->topo < 0)
         return 0;
     *peca = monte->pecas[monte->topo--];
+    monte->chave ^= zobQtdMonte[monte->topo + 2] ^ zobQtdMonte[monte->topo + 1];
     return 1;
 }
 void registrar(Historico *hist, int jogador, Peca peca, char lado, char tipo)
 {
-    if (hist->topo >= 99)
+    if (hist->topo >= MAX_JOGADAS - 1)
         return;
     hist->jogadas[++hist->topo] = (Jogada){jogador, peca, lado, tipo};
 }
-void mostrarMensagem(const char *msg)
+static inline int mesmaPeca(Peca a, Peca b)
 {
-    strncpy(mensagem, msg, 255);
-    mensagem[255] = '\0';
-    tempoMensagem = 420; // 7 segundos a 60 FPS
+    return (a.lado1 == b.lado1 && a.lado2 == b.lado2) || (a.lado1 == b.lado2 && a.lado2 == b.lado1);
 }
 
-// Função callback para receber dados da requisição HTTP
-// Chamada automaticamente pela libcurl conforme a resposta chega
-static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp)
+// Aplica um lance ('J' jogada, 'C' compra, 'P' passe) do jogador (1 ou 2) e
+// empilha no histórico o necessário para desfazê-lo. Não aloca memória: o nó
+// da mesa e o da compra vivem na própria entrada do histórico, e o nó que sai
+// da mão fica guardado nela. A vez de jogar fica a cargo de quem chama.
+// Entre fazer e desfazer não se deve chamar ordenarMao (ela recria os nós).
+int fazerJogada(Partida *p, int jogador, Peca peca, char lado, char tipo)
 {
-    size_t realsize = size * nmemb;
-    HttpResponse *mem = (HttpResponse *)userp;
+    Historico *hist = p->hist;
+    if (hist->topo >= MAX_JOGADAS - 1)
+        return 0;
 
-    char *ptr = realloc(mem->data, mem->size + realsize + 1);
-    if (!ptr)
+    Mao *mao = p->maos[jogador - 1];
+    Jogada *j = &hist->jogadas[hist->topo + 1];
+    *j = (Jogada){jogador, peca, lado, tipo};
+    j->desfazivel = 1;
+    j->passadasAntes = *p->passadas;
+
+    if (tipo == 'J')
     {
-        return 0;
-    }
+        NoMao *atual = mao->pecas, *anterior = NULL;
+        while (atual && !mesmaPeca(atual->peca, peca))
+        {
+            anterior = atual;
+            atual = atual->proximo;
+        }
+        if (!atual)
+            return 0;
 
-    mem->data = ptr;
-    memcpy(&(mem->data[mem->size]), contents, realsize);
-    mem->size += realsize;
-    mem->data[mem->size] = 0;
+        j->noMesa.peca = atual->peca;
+        if (!encaixarNo(p->tab, &j->noMesa, lado))
+            return 0;
 
-    return realsize;
+        if (anterior)
+            anterior->proximo = atual->proximo;
+        else
+            mao->pecas = atual->proximo;
+        mao->quantidade--;
+        mao->pontos -= atual->peca.lado1 + atual->peca.lado2;
+        mao->chave ^= ZOB_PECA(mao->jogador, atual->peca);
+        j->noMao = atual;
+        j->anterior = anterior;
+        j->peca = atual->peca;
+        *p->passadas = 0;
+    }
+    else if (tipo == 'C')
+    {
+        if (!comprar(p->monte, &j->noCompra.peca))
+            return 0;
+        j->peca = j->noCompra.peca;
+        j->noCompra.proximo = mao->pecas;
+        mao->pecas = &j->noCompra;
+        mao->quantidade++;
+        mao->pontos += j->peca.lado1 + j->peca.lado2;
+        mao->chave ^= ZOB_PECA(mao->jogador, j->peca);
+    }
+    else
+    {
+        (*p->passadas)++;
+    }
+
+    hist->topo++;
+    return 1;
 }
 
-// Constrói o prompt contextualizado para enviar à IA
-// Inclui as peças disponíveis e o estado atual do tabuleiro
-char *construirPromptIA(Mao *maoIA, Tabuleiro *tab)
+// Desfaz exatamente o último lance feito por fazerJogada (pilha LIFO)
+// As pontas antigas saem da própria peça: quem foi para a esquerda mostra a
+// ponta anterior no lado2, quem foi para a direita no lado1 (já com a inversão)
+int desfazerJogada(Partida *p)
 {
-    static char prompt[2048], temp[64];
-    char pecas[512];
+    Historico *hist = p->hist;
+    if (hist->topo < 0 || !hist->jogadas[hist->topo].desfazivel)
+        return 0;
 
-    strcpy(pecas, "[");
+    Jogada *j = &hist->jogadas[hist->topo];
+    Mao *mao = p->maos[j->jogador - 1];
 
-    for (NoMao *atual = maoIA->pecas; atual; atual = atual->proximo)
+    if (j->tipo == 'J')
     {
-        snprintf(temp, 64, "%s[%d|%d]", pecas[1] ? ", " : "", atual->peca.lado1, atual->peca.lado2);
-        strcat(pecas, temp);
+        Tabuleiro *tab = p->tab;
+        No *no = &j->noMesa;
+        contarPontosMesa(tab, no->peca, -1);
+        if (tab->inicio == tab->fim)
+        {
+            tab->inicio = tab->fim = NULL;
+            atualizarPontas(tab, -1, -1);
+        }
+        else if (no == tab->inicio)
+        {
+            tab->inicio = no->prox;
+            tab->inicio->ant = NULL;
+            atualizarPontas(tab, no->peca.lado2, tab->pontoFim);
+        }
+        else
+        {
+            tab->fim = no->ant;
+            tab->fim->prox = NULL;
+            atualizarPontas(tab, tab->pontoInicio, no->peca.lado1);
+        }
+
+        // O nó volta para a mesma posição da lista da mão
+        NoMao *n = j->noMao;
+        if (j->anterior)
+        {
+            n->proximo = j->anterior->proximo;
+            j->anterior->proximo = n;
+        }
+        else
+        {
+            n->proximo = mao->pecas;
+            mao->pecas = n;
+        }
+        mao->quantidade++;
+        mao->pontos += n->peca.lado1 + n->peca.lado2;
+        mao->chave ^= ZOB_PECA(mao->jogador, n->peca);
+    }
+    else if (j->tipo == 'C')
+    {
+        // A peça comprada está na cabeça da mão (tudo depois dela já foi desfeito)
+        mao->pecas = j->noCompra.proximo;
+        mao->quantidade--;
+        mao->pontos -= j->peca.lado1 + j->peca.lado2;
+        mao->chave ^= ZOB_PECA(mao->jogador, j->peca);
+        p->monte->pecas[++p->monte->topo] = j->peca;
+        p->monte->chave ^= zobQtdMonte[p->monte->topo] ^ zobQtdMonte[p->monte->topo + 1];
     }
-    strcat(pecas, "]");
 
-    if (!tab->inicio)
-        snprintf(prompt, 2048, "DOMINÓ - Mesa vazia\nSuas pecas: %s\n\nEscolha qualquer peca.\nResposta: [numero1|numero2]\nExemplo: [6|4]", pecas);
-    else
-        snprintf(prompt, 2048, "DOMINÓ\nSuas pecas: %s\nMesa: esquerda=%d direita=%d\n\nVOCE PRECISA:\n1. Escolher UMA peca sua que tenha o numero %d OU %d\n2. Decidir o lado: E (esquerda) ou D (direita)\n\nCOMO JOGAR:\n- Para jogar na ESQUERDA: sua peca PRECISA ter o numero %d\n- Para jogar na DIREITA: sua peca PRECISA ter o numero %d\n\nEXEMPLO PRATICO:\nSe voce tem [%d|2] e quer jogar na esquerda: [%d|2] E\nSe voce tem [1|%d] e quer jogar na direita: [1|%d] D\n\nResposta (formato obrigatorio): [numero1|numero2] LADO", pecas, tab->pontoInicio, tab->pontoFim, tab->pontoInicio, tab->pontoFim, tab->pontoInicio, tab->pontoFim, tab->pontoInicio, tab->pontoInicio, tab->pontoFim, tab->pontoFim);
+    *p->passadas = j->passadasAntes;
+    hist->topo--;
+    return 1;
+}
 
-    return prompt;
+// Chave Zobrist de 64 bits do estado do jogo, em O(1): as partes já são
+// mantidas por adicionarPeca, removerPeca, inserir e comprar
+// Serve de chave para tabelas de transposição, caches e índices de posições
+uint64_t chavePartida(const Partida *p, int turno)
+{
+    uint64_t chave = p->maos[0]->chave ^ p->maos[1]->chave ^ p->tab->chave ^ p->monte->chave;
+    chave ^= zobPassadas[*p->passadas > 2 ? 2 : *p->passadas];
+    if (turno == 2)
+        chave ^= zobVez;
+    return chave;
 }
 
-// Requisição HTTP para API Groq (libcurl + cJSON)
-char *chamarGroqAPI(const char *prompt)
+uint64_t chaveEstado()
 {
-    CURL *curl;
-    CURLcode res;
-    HttpResponse chunk = {0};
-    chunk.data = malloc(1);
-    chunk.size = 0;
+    return chavePartida(&partidaAtual, turnoAtual);
+}
 
-    curl = curl_easy_init();
-    if (!curl)
+void mostrarMensagem(const char *msg)
+{
+    strncpy(mensagem, msg, 255);
+    mensagem[255] = '\0';
+    tempoMensagem = 420; // 7 segundos a 60 FPS
+}
+
+// Relógio monotônico em segundos (não volta no tempo se o relógio do sistema mudar)
+double agoraSegundos()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+void dormirSegundos(double segundos)
+{
+    if (segundos <= 0)
+        return;
+    struct timespec ts = {(time_t)segundos, (long)((segundos - (time_t)segundos) * 1e9)};
+    nanosleep(&ts, NULL);
+}
+
+// Número de núcleos lógicos da máquina (1 se não der para descobrir)
+int numeroNucleos()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int n = (int)info.dwNumberOfProcessors;
+#else
+    int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return n > 0 ? n : 1;
+}
+
+// Arquivo somente leitura mapeado na memória: as páginas são carregadas pelo
+// sistema sob demanda e divididas entre processos que abrem o mesmo arquivo
+typedef struct
+{
+    const uint8_t *dados;
+    size_t tamanho;
+#ifdef _WIN32
+    HANDLE arquivo, mapeamento;
+#endif
+} ArquivoMapeado;
+
+int mapearArquivo(const char *caminho, ArquivoMapeado *m)
+{
+    memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+    m->arquivo = CreateFileA(caminho, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (m->arquivo == INVALID_HANDLE_VALUE)
+        return 0;
+    LARGE_INTEGER tamanho;
+    if (GetFileSizeEx(m->arquivo, &tamanho) && tamanho.QuadPart > 0)
+        m->mapeamento = CreateFileMappingA(m->arquivo, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (m->mapeamento)
+        m->dados = MapViewOfFile(m->mapeamento, FILE_MAP_READ, 0, 0, 0);
+    if (!m->dados)
     {
-        free(chunk.data);
-        return NULL;
+        if (m->mapeamento)
+            CloseHandle(m->mapeamento);
+        CloseHandle(m->arquivo);
+        return 0;
     }
+    m->tamanho = (size_t)tamanho.QuadPart;
+#else
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0)
+        return 0;
+    struct stat info;
+    void *mapa = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+        mapa = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // o mapeamento continua válido sem o descritor
+    if (mapa == MAP_FAILED)
+        return 0;
+    m->dados = mapa;
+    m->tamanho = (size_t)info.st_size;
+#endif
+    return 1;
+}
 
-    cJSON *root = cJSON_CreateObject();
-    cJSON *messages = cJSON_CreateArray();
+void desmapearArquivo(ArquivoMapeado *m)
+{
+    if (!m->dados)
+        return;
+#ifdef _WIN32
+    UnmapViewOfFile(m->dados);
+    CloseHandle(m->mapeamento);
+    CloseHandle(m->arquivo);
+#else
+    munmap((void *)m->dados, m->tamanho);
+#endif
+    memset(m, 0, sizeof(*m));
+}
 
-    cJSON *system_msg = cJSON_CreateObject();
-    cJSON_AddItemToObject(system_msg, "role", cJSON_CreateString("system"));
-    cJSON_AddItemToObject(system_msg, "content", cJSON_CreateString("Voce e um jogador expert de dominó. Analise as pecas disponiveis e escolha a melhor jogada possivel. Responda APENAS no formato [numero1|numero2] LADO. Nao explique, nao justifique, apenas responda."));
-    cJSON_AddItemToArray(messages, system_msg);
+// Roda rotina() em n threads e espera todas terminarem. 'args' aponta para n
+// blocos de 'tamanho' bytes, um para cada thread. Se uma thread não puder ser
+// criada, o trabalho dela roda na thread atual.
+void executarEmThreads(int n, void *(*rotina)(void *), void *args, size_t tamanho)
+{
+    pthread_t *threads = malloc(n * sizeof(pthread_t));
+    char *criada = calloc(n, 1);
+    for (int i = 0; i < n; i++)
+    {
+        void *arg = (char *)args + i * tamanho;
+        if (threads && criada && i > 0 && pthread_create(&threads[i], NULL, rotina, arg) == 0)
+            criada[i] = 1;
+        else if (i > 0)
+            rotina(arg);
+    }
+    rotina(args); // a thread atual faz a parte 0
+    for (int i = 1; i < n; i++)
+        if (criada && criada[i])
+            pthread_join(threads[i], NULL);
+    free(threads);
+    free(criada);
+}
 
-    cJSON *user_msg = cJSON_CreateObject();
-    cJSON_AddItemToObject(user_msg, "role", cJSON_CreateString("user"));
-    cJSON_AddItemToObject(user_msg, "content", cJSON_CreateString(prompt));
-    cJSON_AddItemToArray(messages, user_msg);
+// ===== Motor de regras compacto =====
+// Representação do jogo com máscaras de bits (uma peça = um bit), usada pela
+// busca e pelo simulador sem janela. Copiar um estado inteiro custa poucos bytes.
+#define MAX_LANCES (2 * NUM_PECAS)
+#define LANCE_COMPRAR -1
+#define LANCE_PASSAR -2
+// A vitória precisa valer mais que qualquer margem de pontos
+#define VALOR_VITORIA (PONTOS_BARALHO < 1000 ? 1000 : 2000)
+#define VALOR_INFINITO 30000
+
+#if NUM_PECAS <= 32
+static inline int contarPecas(MascaraPecas m) { return __builtin_popcount(m); }
+static inline int primeiraPeca(MascaraPecas m) { return __builtin_ctz(m); }
+#elif NUM_PECAS <= 64
+static inline int contarPecas(MascaraPecas m) { return __builtin_popcountll(m); }
+static inline int primeiraPeca(MascaraPecas m) { return __builtin_ctzll(m); }
+#else
+static inline int contarPecas(MascaraPecas m)
+{
+    return __builtin_popcountll((uint64_t)m) + __builtin_popcountll((uint64_t)(m >> 64));
+}
+static inline int primeiraPeca(MascaraPecas m)
+{
+    return (uint64_t)m ? __builtin_ctzll((uint64_t)m) : 64 + __builtin_ctzll((uint64_t)(m >> 64));
+}
+#endif
 
-    cJSON_AddItemToObject(root, "model", cJSON_CreateString(GROQ_MODEL));
-    cJSON_AddItemToObject(root, "messages", messages);
-    cJSON_AddItemToObject(root, "temperature", cJSON_CreateNumber(0.0));
-    cJSON_AddItemToObject(root, "max_tokens", cJSON_CreateNumber(20));
-    cJSON_AddItemToObject(root, "top_p", cJSON_CreateNumber(1.0));
+typedef struct
+{
+    MascaraPecas mao[2]; // mão de cada jogador (0 = humano, 1 = IA)
+    MascaraPecas monte;  // peças ainda no monte
+    MascaraPecas mesa;   // peças já jogadas
+    int8_t pontas[2];    // 0 = esquerda, 1 = direita (-1 com a mesa vazia)
+    uint8_t vez, passadas;
+    uint64_t chave; // Zobrist, atualizada a cada lance
+} EstadoMotor;
+// A chave do motor usa as mesmas tabelas de chaveEstado() e acrescenta o
+// conteúdo do monte (conhecido em cada mundo sorteado pela busca):
+// chave do motor = chaveEstado() ^ XOR de zobMonte das peças no monte
+
+// Lance: peça (índice) + lado (0 = esquerda, 1 = direita), ou comprar/passar
+typedef struct
+{
+    int8_t peca, lado;
+} Lance;
 
-    char *json_str = cJSON_Print(root);
+// Finalizador do SplitMix64: também serve de hash de 64 bits
+static inline uint64_t misturar64(uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
 
-    struct curl_slist *headers = NULL;
-    char auth_header[512];
-    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", GROQ_API_KEY);
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-    headers = curl_slist_append(headers, auth_header);
+// Separa a sequência das políticas da sequência da distribuição e do monte
+#define SEMENTE_DECISOES 0xD1B54A32D192ED03ULL
 
-    curl_easy_setopt(curl, CURLOPT_URL, GROQ_API_URL);
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_str);
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 30L);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+// Gerador SplitMix64 - cada thread/simulação carrega sua própria semente
+static inline uint64_t proximoAleatorio(uint64_t *s)
+{
+    return misturar64(*s += 0x9E3779B97F4A7C15ULL);
+}
 
-    res = curl_easy_perform(curl);
+static inline int aleatorioAte(uint64_t *s, int n)
+{
+    return (int)((proximoAleatorio(s) >> 32) * (uint64_t)n >> 32);
+}
 
-    char *response = NULL;
-    if (res == CURLE_OK)
+// Sorteia uma peça da máscara (todas com a mesma chance)
+static inline int sortearPeca(MascaraPecas m, uint64_t *s)
+{
+    int k = aleatorioAte(s, contarPecas(m));
+    while (k--)
+        m &= m - 1;
+    return primeiraPeca(m);
+}
+
+static void montarTabelasMotor()
+{
+    int index = 0;
+    for (int i = 0; i <= MAX_PONTO; i++)
+        for (int j = i; j <= MAX_PONTO; j++)
+        {
+            pecaMotor[index] = (Peca){i, j};
+            indicePeca[i][j] = indicePeca[j][i] = index;
+            pontosPeca[index] = i + j;
+            pecasComPonto[i] |= BIT_PECA(index);
+            pecasComPonto[j] |= BIT_PECA(index);
+            index++;
+        }
+
+    for (int n = 0; n <= NUM_PECAS; n++)
     {
-        response = strdup(chunk.data);
+        binomial[n][0] = 1;
+        for (int k = 1; k <= n; k++)
+            binomial[n][k] = binomial[n - 1][k - 1] + (k < n ? binomial[n - 1][k] : 0);
     }
 
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-    cJSON_Delete(root);
-    free(json_str);
-    free(chunk.data);
+    uint64_t semente = 0x0D0111A0C1A5ULL; // fixa: as chaves são iguais em toda execução
+    for (int j = 0; j < 2; j++)
+        for (int i = 0; i < NUM_PECAS; i++)
+            zobMao[j][i] = proximoAleatorio(&semente);
+    for (int i = 0; i < NUM_PECAS; i++)
+        zobMonte[i] = proximoAleatorio(&semente);
+    for (int i = 0; i <= NUM_PECAS; i++)
+        zobQtdMonte[i] = proximoAleatorio(&semente);
+    for (int l = 0; l < 2; l++)
+        for (int p = 0; p <= NUM_PONTOS; p++)
+            zobPonta[l][p] = proximoAleatorio(&semente);
+    zobVez = proximoAleatorio(&semente);
+    for (int p = 0; p < 3; p++)
+        zobPassadas[p] = proximoAleatorio(&semente);
+}
 
-    return response;
+void inicializarMotor()
+{
+    static pthread_once_t pronto = PTHREAD_ONCE_INIT;
+    pthread_once(&pronto, montarTabelasMotor);
 }
 
-// Extrai a jogada da resposta JSON da API Groq
-int parseResposta(const char *json_response, Peca *peca, char *lado)
+// Chave Zobrist calculada do zero (o motor depois só a atualiza por XOR)
+uint64_t calcularChaveMotor(const EstadoMotor *e)
 {
-    if (!json_response)
-        return 0;
-    cJSON *root = cJSON_Parse(json_response);
-    if (!root)
-        return 0;
+    uint64_t chave = ZOB_PONTA(0, e->pontas[0]) ^ ZOB_PONTA(1, e->pontas[1]) ^ zobPassadas[e->passadas];
+    chave ^= zobQtdMonte[contarPecas(e->monte)];
+    if (e->vez)
+        chave ^= zobVez;
+    for (int j = 0; j < 2; j++)
+        for (MascaraPecas m = e->mao[j]; m; m &= m - 1)
+            chave ^= zobMao[j][primeiraPeca(m)];
+    for (MascaraPecas m = e->monte; m; m &= m - 1)
+        chave ^= zobMonte[primeiraPeca(m)];
+    return chave;
+}
 
-    // Navega na estrutura JSON para obter a mensagem da IA
-    cJSON *message = cJSON_GetObjectItem(cJSON_GetArrayItem(
-                                             cJSON_GetObjectItem(root, "choices"), 0),
-                                         "message");
+int pontosMao(MascaraPecas m)
+{
+    int total = 0;
+    for (; m; m &= m - 1)
+        total += pontosPeca[primeiraPeca(m)];
+    return total;
+}
 
-    if (!message)
+// Lances de uma mão nas pontas dadas (compartilhado com a mesa de N lugares)
+static inline int lancesDaMao(MascaraPecas mao, const int8_t pontas[2], int temMonte, Lance *lances)
+{
+    int n = 0;
+
+    if (pontas[0] < 0)
     {
-        cJSON_Delete(root);
-        return 0;
+        for (; mao; mao &= mao - 1)
+            lances[n++] = (Lance){primeiraPeca(mao), 0};
+        return n;
     }
 
-    cJSON *content = cJSON_GetObjectItem(message, "content");
-    const char *resposta = NULL;
+    for (MascaraPecas m = mao & pecasComPonto[pontas[0]]; m; m &= m - 1)
+        lances[n++] = (Lance){primeiraPeca(m), 0};
+    // Pontas iguais: jogar de um lado ou do outro dá a mesma posição
+    if (pontas[1] != pontas[0])
+        for (MascaraPecas m = mao & pecasComPonto[pontas[1]]; m; m &= m - 1)
+            lances[n++] = (Lance){primeiraPeca(m), 1};
 
-    if (content && cJSON_IsString(content) && strlen(content->valuestring) > 0)
+    if (n == 0)
+        lances[n++] = (Lance){temMonte ? LANCE_COMPRAR : LANCE_PASSAR, 0};
+    return n;
+}
+
+// Lances legais do jogador da vez; sem peça que encaixe, o único lance é
+// comprar (se houver monte) ou passar
+int gerarLances(const EstadoMotor *e, Lance *lances)
+{
+    return lancesDaMao(e->mao[e->vez], e->pontas, e->monte != 0, lances);
+}
+
+// Aplica uma jogada ou um passe. Compras usam comprarPecaMotor(), pois a
+// peça comprada é um evento de acaso escolhido por quem chama
+void aplicarLance(EstadoMotor *e, Lance l)
+{
+    int v = e->vez;
+    e->chave ^= zobPassadas[e->passadas] ^ zobVez;
+
+    if (l.peca == LANCE_PASSAR)
     {
-        resposta = content->valuestring;
+        if (e->passadas < 2)
+            e->passadas++;
     }
     else
     {
+        int a = pecaMotor[l.peca].lado1, b = pecaMotor[l.peca].lado2;
+        e->mao[v] &= ~BIT_PECA(l.peca);
+        e->mesa |= BIT_PECA(l.peca);
+        e->chave ^= zobMao[v][l.peca] ^ ZOB_PONTA(0, e->pontas[0]) ^ ZOB_PONTA(1, e->pontas[1]);
 
-        cJSON *reasoning = cJSON_GetObjectItem(message, "reasoning");
-        if (reasoning && cJSON_IsString(reasoning))
+        if (e->pontas[0] < 0)
         {
-            resposta = reasoning->valuestring;
+            e->pontas[0] = a;
+            e->pontas[1] = b;
+        }
+        else
+        {
+            // A ponta coberta passa a mostrar o outro lado da peça
+            int lado = l.lado;
+            e->pontas[lado] = (a == e->pontas[lado]) ? b : a;
         }
+        e->chave ^= ZOB_PONTA(0, e->pontas[0]) ^ ZOB_PONTA(1, e->pontas[1]);
+        e->passadas = 0;
     }
 
-    if (!resposta || strlen(resposta) == 0)
-    {
-        cJSON_Delete(root);
-        return 0;
-    }
+    e->vez = v ^ 1;
+    e->chave ^= zobPassadas[e->passadas];
+}
 
-    int lado1, lado2;
-    char lado_char, lado_str[20];
+// Compra uma peça específica do monte - a vez continua com o mesmo jogador
+void comprarPecaMotor(EstadoMotor *e, int peca)
+{
+    int quantidade = contarPecas(e->monte);
+    e->monte &= ~BIT_PECA(peca);
+    e->mao[e->vez] |= BIT_PECA(peca);
+    e->chave ^= zobMonte[peca] ^ zobMao[e->vez][peca] ^ zobQtdMonte[quantidade] ^ zobQtdMonte[quantidade - 1];
+}
 
-    // Tenta parsear diferentes formatos de resposta: [6|4] E, [6|4] esquerda, [6|4]
-    if (sscanf(resposta, "[%d|%d] %c", &lado1, &lado2, &lado_char) == 3)
+// Travado: nenhuma peça fora da mesa tem os números das pontas (as sete de
+// cada um já foram jogadas), então ninguém joga de novo, nem comprando
+static inline int travadoPontas(MascaraPecas mesa, const int8_t pontas[2])
+{
+    return pontas[0] >= 0 &&
+           (mesa & (pecasComPonto[pontas[0]] | pecasComPonto[pontas[1]])) ==
+               (pecasComPonto[pontas[0]] | pecasComPonto[pontas[1]]);
+}
+
+static inline int travadoMotor(const EstadoMotor *e)
+{
+    return travadoPontas(e->mesa, e->pontas);
+}
+
+// Pontos na mão de 'jogador' na contagem final: no jogo travado quem está na
+// vez compraria o monte inteiro antes dos dois passarem
+int pontosFinaisMotor(const EstadoMotor *e, int jogador)
+{
+    int pontos = pontosMao(e->mao[jogador]);
+    if (jogador == e->vez && e->monte && travadoMotor(e))
+        pontos += pontosMao(e->monte);
+    return pontos;
+}
+
+// Mesmas regras de verificarVitoria():
+// 1 = jogador 0 venceu, 2 = jogador 1 venceu, 3 = empate, 0 = jogo continua
+int fimMotor(const EstadoMotor *e)
+{
+    if (!e->mao[0])
+        return 1;
+    if (!e->mao[1])
+        return 2;
+    if (e->passadas >= 2 || travadoMotor(e))
     {
-        *peca = (Peca){lado1, lado2};
-        *lado = (lado_char == 'E' || lado_char == 'e') ? 'E' : 'D';
+        int pts0 = pontosFinaisMotor(e, 0), pts1 = pontosFinaisMotor(e, 1);
+        return pts0 < pts1 ? 1 : (pts1 < pts0 ? 2 : 3);
     }
-    else if (sscanf(resposta, "[%d|%d] %19s", &lado1, &lado2, lado_str) == 3)
+    return 0;
+}
+
+// Valor final do ponto de vista de 'jogador': vitória vale VALOR_VITORIA
+// mais a diferença de pontos nas mãos (quanto mais o adversário ficou devendo, melhor)
+int valorTerminal(const EstadoMotor *e, int jogador)
+{
+    int fim = fimMotor(e);
+    int margem = pontosFinaisMotor(e, jogador ^ 1) - pontosFinaisMotor(e, jogador);
+    if (fim == 3)
+        return 0;
+    return (fim == jogador + 1 ? VALOR_VITORIA : -VALOR_VITORIA) + margem;
+}
+
+// ===== Disputa até um placar alvo =====
+// As rodadas se repetem até alguém somar 'alvo' pontos. Quem vence a rodada
+// marca os pontos que ficaram na mão do adversário (empate não marca) e a
+// saída alterna a cada rodada. Jogando a disputa, o que importa não é a
+// margem da rodada, e sim a equidade: a chance de vencer a disputa a partir
+// do placar que a rodada deixa.
+#define ALVO_PADRAO 100
+#define MAX_ALVO_DISPUTA 500
+#define PONTOS_REFERENCIA_DISPUTA (PONTOS_BARALHO / 16) // pontos de uma rodada típica
+#define LIMITE_VALOR_DISPUTA (4 * VALOR_VITORIA)
+
+typedef struct
+{
+    int alvo;
+    float *equidade; // [(a * (alvo + 1) + b) * 2 + primeiro]: chance do jogador 0 faltando a e b pontos
+} TabelaDisputa;
+
+typedef struct
+{
+    const TabelaDisputa *tabela;
+    int falta[2]; // pontos que cada jogador ainda precisa fazer
+    int primeiro; // quem saiu nesta rodada; a próxima sai com o outro
+} ContextoDisputa;
+
+static inline double equidadeDisputa(const TabelaDisputa *t, int a, int b, int primeiro)
+{
+    if (a <= 0)
+        return 1.0;
+    if (b <= 0)
+        return 0.0;
+    return t->equidade[((size_t)a * (t->alvo + 1) + b) * 2 + primeiro];
+}
+
+// Equidade do jogador 0 depois de marcar os pontos da rodada terminada 'e'
+double equidadeFinalDisputa(const ContextoDisputa *d, const EstadoMotor *e)
+{
+    int fim = fimMotor(e);
+    int falta[2] = {d->falta[0], d->falta[1]};
+    if (fim == 1 || fim == 2)
+        falta[fim - 1] -= pontosFinaisMotor(e, 2 - fim);
+    return equidadeDisputa(d->tabela, falta[0], falta[1], d->primeiro ^ 1);
+}
+
+// Avaliação heurística das folhas da busca: menos peças, menos pontos na mão
+// e mais peças jogáveis nas pontas atuais
+int avaliarMotor(const EstadoMotor *e, int jogador)
+{
+    int adv = jogador ^ 1;
+    int valor = 15 * (contarPecas(e->mao[adv]) - contarPecas(e->mao[jogador]));
+    valor += pontosMao(e->mao[adv]) - pontosMao(e->mao[jogador]);
+    if (e->pontas[0] >= 0)
     {
-        *peca = (Peca){lado1, lado2};
-        *lado = (strstr(lado_str, "esq") || lado_str[0] == 'E' || lado_str[0] == 'e') ? 'E' : 'D';
+        MascaraPecas pontas = pecasComPonto[e->pontas[0]] | pecasComPonto[e->pontas[1]];
+        valor += 4 * (contarPecas(e->mao[jogador] & pontas) - contarPecas(e->mao[adv] & pontas));
     }
-    else if (sscanf(resposta, "[%d|%d]", &lado1, &lado2) == 2)
+    return valor;
+}
+
+// Reparte as peças como distribuir(): PECAS_POR_MAO para cada jogador, o resto no monte
+void distribuirMotor(EstadoMotor *e, uint64_t *semente)
+{
+    int baralho[NUM_PECAS];
+    for (int i = 0; i < NUM_PECAS; i++)
+        baralho[i] = i;
+    for (int i = NUM_PECAS - 1; i > 0; i--)
     {
-        *peca = (Peca){lado1, lado2};
-        *lado = 'D';
+        int j = aleatorioAte(semente, i + 1);
+        int temp = baralho[i];
+        baralho[i] = baralho[j];
+        baralho[j] = temp;
     }
-    else
+
+    memset(e, 0, sizeof(*e));
+    e->pontas[0] = e->pontas[1] = -1;
+    for (int i = 0; i < PECAS_POR_MAO; i++)
     {
-        cJSON_Delete(root);
-        return 0;
+        e->mao[0] |= BIT_PECA(baralho[i]);
+        e->mao[1] |= BIT_PECA(baralho[PECAS_POR_MAO + i]);
     }
-
-    cJSON_Delete(root);
-    return 1;
+    e->monte = TODAS_PECAS & ~e->mao[0] & ~e->mao[1];
+    e->chave = calcularChaveMotor(e);
 }
 
-void desenharPeca(int x, int y, Peca peca, Color cor)
+// ===== Crença sobre a mão do adversário =====
+// Quem compra ou passa mostra que não tem peça com nenhum dos números das
+// pontas. Cada vaga da mão do adversário guarda os números que ela não pode
+// ter: uma vaga recebe as restrições dos "vazios" que aconteceram depois que
+// a peça dela chegou. Por isso as restrições são aninhadas (a vaga mais
+// antiga proíbe um superconjunto da mais nova) e as vagas se agrupam em
+// poucos grupos, do mais restrito para o menos restrito.
+// Quando o adversário joga uma peça não se sabe de que vaga ela saiu: cada
+// grupo compatível é uma hipótese, com peso igual ao número de vagas dele que
+// podiam guardá-la. A crença é então uma mistura de poucas contagens de vagas
+// por grupo, todas sobre os mesmos grupos; em cada uma a contagem de mundos
+// é um produto simples, e a soma ponderada é exata, sem amostragem.
+#define MAX_GRUPOS_CRENCA (NUM_PONTOS + 2)
+#define MAX_HIPOTESES_CRENCA 64
+
+typedef uint16_t MascaraPontos; // bit p = número p
+
+typedef struct
 {
-    DrawRectangle(x, y, PECA_WIDTH, PECA_HEIGHT, cor);
-    DrawRectangleLines(x, y, PECA_WIDTH, PECA_HEIGHT, BLACK);
-    DrawLine(x, y + PECA_HEIGHT / 2, x + PECA_WIDTH, y + PECA_HEIGHT / 2, BLACK);
-    DrawText(TextFormat("%d", peca.lado1), x + PECA_WIDTH / 2 - 10, y + 20, 30, BLACK);
-    DrawText(TextFormat("%d", peca.lado2), x + PECA_WIDTH / 2 - 10, y + PECA_HEIGHT / 2 + 20, 30, BLACK);
+    double peso;
+    uint8_t vagas[MAX_GRUPOS_CRENCA];
+} HipoteseCrenca;
+
+typedef struct
+{
+    int numGrupos, numHipoteses;
+    MascaraPontos proibidos[MAX_GRUPOS_CRENCA]; // grupo 0 = mais restrito
+    HipoteseCrenca hipoteses[MAX_HIPOTESES_CRENCA];
+} Crenca;
+
+void iniciarCrenca(Crenca *c, int tamanhoMao)
+{
+    c->numGrupos = 1;
+    c->proibidos[0] = 0;
+    c->numHipoteses = 1;
+    memset(&c->hipoteses[0], 0, sizeof(HipoteseCrenca));
+    c->hipoteses[0].peso = 1.0;
+    c->hipoteses[0].vagas[0] = (uint8_t)tamanhoMao;
 }
 
-void desenharTabuleiro()
+// Soma o peso de h a uma hipótese igual já presente, ou a acrescenta.
+// Retorna o índice dela, ou -1 se não coube
+static int juntarHipoteseCrenca(Crenca *c, const HipoteseCrenca *h)
 {
-    DrawRectangle(0, 0, SCREEN_WIDTH, 200, DARKGREEN);
-    DrawText("MESA", 20, 20, 30, WHITE);
+    for (int k = 0; k < c->numHipoteses; k++)
+        if (memcmp(c->hipoteses[k].vagas, h->vagas, c->numGrupos) == 0)
+        {
+            c->hipoteses[k].peso += h->peso;
+            return k;
+        }
+    if (c->numHipoteses == MAX_HIPOTESES_CRENCA)
+        return -1;
+    c->hipoteses[c->numHipoteses] = *h;
+    return c->numHipoteses++;
+}
 
-    if (!tabuleiro.inicio)
+// O adversário não tem nenhuma peça com os números a ou b (comprou ou passou)
+void crencaVazio(Crenca *c, int a, int b)
+{
+    if (a < 0)
+        return;
+    MascaraPontos vazio = (MascaraPontos)((1u << a) | (1u << b));
+    int destino[MAX_GRUPOS_CRENCA], n = 0;
+    for (int g = 0; g < c->numGrupos; g++)
     {
-        DrawText("Mesa vazia - Primeira jogada", 350, 90, 25, YELLOW);
+        MascaraPontos m = c->proibidos[g] | vazio;
+        if (n == 0 || c->proibidos[n - 1] != m)
+            c->proibidos[n++] = m;
+        destino[g] = n - 1;
+    }
+    if (n == c->numGrupos)
         return;
+
+    HipoteseCrenca antigas[MAX_HIPOTESES_CRENCA];
+    int quantas = c->numHipoteses, grupos = c->numGrupos;
+    memcpy(antigas, c->hipoteses, quantas * sizeof(HipoteseCrenca));
+    c->numGrupos = n;
+    c->numHipoteses = 0;
+    for (int k = 0; k < quantas; k++)
+    {
+        HipoteseCrenca h = {antigas[k].peso, {0}};
+        for (int g = 0; g < grupos; g++)
+            h.vagas[destino[g]] += antigas[k].vagas[g];
+        juntarHipoteseCrenca(c, &h);
     }
+}
 
-    int totalPecas = 0, x = 50;
-    for (No *c = tabuleiro.inicio; c; c = c->prox)
-        totalPecas++;
+// O adversário comprou: uma vaga nova, ainda sem restrição
+void crencaCompra(Crenca *c)
+{
+    int ultimo = c->numGrupos - 1;
+    if (c->proibidos[ultimo] != 0 && c->numGrupos < MAX_GRUPOS_CRENCA)
+    {
+        ultimo = c->numGrupos++;
+        c->proibidos[ultimo] = 0;
+        for (int k = 0; k < c->numHipoteses; k++)
+            c->hipoteses[k].vagas[ultimo] = 0;
+    }
+    for (int k = 0; k < c->numHipoteses; k++)
+        c->hipoteses[k].vagas[ultimo]++;
+}
 
-    if (totalPecas <= 8)
+// O adversário jogou a peça: ela saiu de uma vaga de algum grupo compatível.
+// Cada hipótese se divide em uma por grupo compatível, pesada pelas vagas do
+// grupo; grupos que ficaram vazios em todas as hipóteses somem.
+// Se as hipóteses não couberem (só em partidas longas nos jogos maiores que o
+// duplo-6), a que tira a vaga do grupo mais restrito fica com o peso das
+// irmãs: ela contém os mundos de todas, então os mundos possíveis continuam
+// exatos e só os pesos passam a ser aproximados
+void crencaJogada(Crenca *c, int peca)
+{
+    MascaraPontos numeros = (MascaraPontos)((1u << pecaMotor[peca].lado1) | (1u << pecaMotor[peca].lado2));
+    HipoteseCrenca antigas[MAX_HIPOTESES_CRENCA];
+    int quantas = c->numHipoteses, restrita[MAX_HIPOTESES_CRENCA];
+    memcpy(antigas, c->hipoteses, quantas * sizeof(HipoteseCrenca));
+    c->numHipoteses = 0;
+
+    // Primeiro a filha mais restrita de cada hipótese (sempre cabem)...
+    for (int k = 0; k < quantas; k++)
     {
-        for (No *atual = tabuleiro.inicio; atual; atual = atual->prox, x += PECA_WIDTH + 10)
-            desenharPeca(x, 50, atual->peca, WHITE);
+        restrita[k] = -1;
+        for (int g = 0; g < c->numGrupos; g++)
+            if (antigas[k].vagas[g] && !(c->proibidos[g] & numeros))
+            {
+                HipoteseCrenca h = antigas[k];
+                h.peso *= h.vagas[g]--;
+                restrita[k] = juntarHipoteseCrenca(c, &h);
+                break;
+            }
     }
-    else
+    // ...depois as demais, ou o peso delas vai para a mais restrita
+    for (int k = 0; k < quantas; k++)
     {
-        No *atual = tabuleiro.inicio;
-        for (int i = 0; i < 3 && atual; i++, atual = atual->prox, x += PECA_WIDTH + 10)
-            desenharPeca(x, 50, atual->peca, WHITE);
-        DrawText("...", x + 10, 90, 40, WHITE);
-        x += 50;
-        No *temp[3] = {NULL, NULL, NULL};
-        No *p = tabuleiro.fim;
-        for (int i = 2; i >= 0 && p; i--, p = p->ant)
-            temp[i] = p;
-        for (int i = 0; i < 3; i++)
-            if (temp[i])
+        int primeira = 1;
+        for (int g = 0; g < c->numGrupos && restrita[k] >= 0; g++)
+            if (antigas[k].vagas[g] && !(c->proibidos[g] & numeros))
             {
-                desenharPeca(x, 50, temp[i]->peca, WHITE);
-                x += PECA_WIDTH + 10;
+                if (primeira)
+                {
+                    primeira = 0;
+                    continue;
+                }
+                HipoteseCrenca h = antigas[k];
+                h.peso *= h.vagas[g]--;
+                if (juntarHipoteseCrenca(c, &h) < 0)
+                    c->hipoteses[restrita[k]].peso += h.peso;
             }
     }
 
-    DrawText(TextFormat("Pontas: [%d] e [%d]", tabuleiro.pontoInicio, tabuleiro.pontoFim), 850, 20, 25, YELLOW);
-    DrawText(TextFormat("Total: %d pecas", totalPecas), 850, 55, 20, LIGHTGRAY);
+    // Crença inconsistente (não deveria): tira a vaga do grupo menos restrito
+    if (c->numHipoteses == 0)
+        for (int k = 0; k < quantas; k++)
+        {
+            HipoteseCrenca h = antigas[k];
+            int g = c->numGrupos - 1;
+            while (g > 0 && !h.vagas[g])
+                g--;
+            if (h.vagas[g])
+                h.vagas[g]--;
+            juntarHipoteseCrenca(c, &h);
+        }
+
+    // Normaliza os pesos (só as razões importam) e remove os grupos vazios
+    double maior = 0;
+    for (int k = 0; k < c->numHipoteses; k++)
+        if (c->hipoteses[k].peso > maior)
+            maior = c->hipoteses[k].peso;
+    int n = 0;
+    for (int g = 0; g < c->numGrupos; g++)
+    {
+        int ocupado = 0;
+        for (int k = 0; k < c->numHipoteses && !ocupado; k++)
+            ocupado = c->hipoteses[k].vagas[g] != 0;
+        if (!ocupado && (n > 0 || g < c->numGrupos - 1))
+            continue;
+        c->proibidos[n] = c->proibidos[g];
+        for (int k = 0; k < c->numHipoteses; k++)
+            c->hipoteses[k].vagas[n] = c->hipoteses[k].vagas[g];
+        n++;
+    }
+    c->numGrupos = n;
+    for (int k = 0; k < c->numHipoteses; k++)
+    {
+        c->hipoteses[k].peso /= maior;
+        for (int g = n; g < MAX_GRUPOS_CRENCA; g++)
+            c->hipoteses[k].vagas[g] = 0;
+    }
 }
 
-void desenharMaoHumano()
+// Peças ocultas que cabem nas vagas do grupo g
+static MascaraPecas compativeisGrupo(const Crenca *c, int g, MascaraPecas ocultas)
 {
-    DrawText("SUA MAO", 20, 220, 30, WHITE);
-    DrawText(TextFormat("Pecas: %d | Pontos: %d", maoHumano.quantidade, calcularPontos(&maoHumano)), 20, 260, 20, LIGHTGRAY);
+    MascaraPecas proibidas = 0;
+    for (int p = 0; p < NUM_PONTOS; p++)
+        if (c->proibidos[g] & (1u << p))
+            proibidas |= pecasComPonto[p];
+    return ocultas & ~proibidas;
+}
 
-    int x = 50, i = 0;
-    for (NoMao *atual = maoHumano.pecas; atual; atual = atual->proximo, i++, x += PECA_WIDTH + 15)
+// Atribuições consistentes de peças às vagas de uma hipótese: os grupos mais
+// restritos escolhem primeiro entre as suas peças compatíveis, e como os
+// conjuntos compatíveis são aninhados, cada grupo perde exatamente as peças
+// já usadas pelos anteriores: produto de fatoriais decrescentes
+static double mundosHipotese(const Crenca *c, const HipoteseCrenca *h, const int compativeis[])
+{
+    double total = 1.0;
+    int usadas = 0;
+    for (int g = 0; g < c->numGrupos; g++)
     {
-        desenharPeca(x, 300, atual->peca, i == pecaSelecionada ? YELLOW : LIGHTGRAY);
-        if (encaixa(&tabuleiro, atual->peca))
-            DrawCircle(x + PECA_WIDTH - 10, 310, 8, GREEN);
+        int livres = compativeis[g] - usadas;
+        for (int i = 0; i < h->vagas[g]; i++)
+            total *= (double)(livres - i);
+        if (total <= 0)
+            return 0;
+        usadas += h->vagas[g];
     }
+    return total;
 }
 
-void desenharMaoIA()
+// Número (ponderado pelas hipóteses) de mundos consistentes
+double contarMundosCrenca(const Crenca *c, MascaraPecas ocultas)
 {
-    DrawText("MAO DA IA", SCREEN_WIDTH - 200, 220, 25, WHITE);
-    DrawText(TextFormat("Pecas: %d", maoIA.quantidade), SCREEN_WIDTH - 200, 260, 20, LIGHTGRAY);
-    for (int i = 0; i < maoIA.quantidade && i < 6; i++)
+    int compativeis[MAX_GRUPOS_CRENCA];
+    for (int g = 0; g < c->numGrupos; g++)
+        compativeis[g] = contarPecas(compativeisGrupo(c, g, ocultas));
+    double total = 0;
+    for (int k = 0; k < c->numHipoteses; k++)
+        total += c->hipoteses[k].peso * mundosHipotese(c, &c->hipoteses[k], compativeis);
+    return total;
+}
+
+// Probabilidade exata de cada peça oculta estar na mão do adversário
+// (o complemento é a chance de estar no monte): 1 - mundos sem ela / mundos
+void probabilidadesCrenca(const Crenca *c, MascaraPecas ocultas, double prob[NUM_PECAS])
+{
+    double total = contarMundosCrenca(c, ocultas);
+    for (int i = 0; i < NUM_PECAS; i++)
+        prob[i] = 0;
+    for (MascaraPecas m = ocultas; m; m &= m - 1)
     {
-        DrawRectangle(SCREEN_WIDTH - 200, 300 + i * 25, 50, 20, GRAY);
-        DrawRectangleLines(SCREEN_WIDTH - 200, 300 + i * 25, 50, 20, BLACK);
+        int p = primeiraPeca(m);
+        prob[p] = total > 0 ? 1.0 - contarMundosCrenca(c, ocultas & ~BIT_PECA(p)) / total : 0;
     }
 }
 
-void desenharBotoes()
+// Números que o adversário com certeza não tem (proibidos em todas as vagas:
+// o grupo menos restrito que ainda tem vaga em alguma hipótese)
+MascaraPontos vaziosCertosCrenca(const Crenca *c)
 {
-    Color corE = (ladoEscolhido == 'E') ? GREEN : LIGHTGRAY;
-    DrawRectangle(50, 500, 150, 50, corE);
-    DrawText("ESQUERDA (E)", 60, 515, 20, BLACK);
-
-    Color corD = (ladoEscolhido == 'D') ? GREEN : LIGHTGRAY;
-    DrawRectangle(220, 500, 150, 50, corD);
-    DrawText("DIREITA (D)", 235, 515, 20, BLACK);
+    return c->proibidos[c->numGrupos - 1];
+}
 
-    DrawRectangle(50, 570, 150, 50, BLUE);
-    DrawText("JOGAR", 90, 585, 25, WHITE);
+// Probabilidade exata de o adversário ter ao menos uma peça com algum dos
+// números de 'pontos', ou seja, de poder seguir numa ponta com esse número.
+// É a conta hipergeométrica das peças ocultas (mão dele + monte) com os
+// vazios conhecidos: 1 - mundos em que a mão evita essas peças / todos os mundos
+double probabilidadeSeguirCrenca(const Crenca *c, MascaraPecas ocultas, MascaraPontos pontos)
+{
+    MascaraPecas comPonto = 0;
+    for (int p = 0; p < NUM_PONTOS; p++)
+        if (pontos & (1u << p))
+            comPonto |= pecasComPonto[p];
+    double total = contarMundosCrenca(c, ocultas);
+    if (total <= 0)
+        return 0;
+    return 1.0 - contarMundosCrenca(c, ocultas & ~comPonto) / total;
+}
 
-    DrawRectangle(220, 570, 150, 50, ORANGE);
-    DrawText("COMPRAR", 245, 585, 20, WHITE);
+// Sorteia a mão do adversário com a mesma chance para cada mundo consistente:
+// primeiro a hipótese, pelo peso vezes os mundos dela, depois as vagas
+// Se a crença ficou inconsistente (não deveria), completa sem restrição
+MascaraPecas sortearMaoCrenca(const Crenca *c, MascaraPecas ocultas, uint64_t *semente)
+{
+    const HipoteseCrenca *h = &c->hipoteses[0];
+    if (c->numHipoteses > 1)
+    {
+        int compativeis[MAX_GRUPOS_CRENCA];
+        double mundos[MAX_HIPOTESES_CRENCA], total = 0;
+        for (int g = 0; g < c->numGrupos; g++)
+            compativeis[g] = contarPecas(compativeisGrupo(c, g, ocultas));
+        for (int k = 0; k < c->numHipoteses; k++)
+            total += mundos[k] = c->hipoteses[k].peso * mundosHipotese(c, &c->hipoteses[k], compativeis);
+        double sorteio = (proximoAleatorio(semente) >> 11) * (1.0 / 9007199254740992.0) * total;
+        for (int k = 0; k < c->numHipoteses; k++)
+        {
+            if (mundos[k] <= 0)
+                continue;
+            h = &c->hipoteses[k];
+            if ((sorteio -= mundos[k]) < 0)
+                break;
+        }
+    }
 
-    DrawRectangle(SCREEN_WIDTH - 180, 500, 160, 50, RED);
-    DrawText("VOLTAR MENU", SCREEN_WIDTH - 165, 515, 20, WHITE);
+    MascaraPecas mao = 0;
+    for (int g = 0; g < c->numGrupos; g++)
+    {
+        MascaraPecas livres = compativeisGrupo(c, g, ocultas) & ~mao;
+        for (int i = 0; i < h->vagas[g]; i++)
+        {
+            MascaraPecas origem = livres ? livres : (ocultas & ~mao);
+            if (!origem)
+                return mao;
+            int p = sortearPeca(origem, semente);
+            mao |= BIT_PECA(p);
+            livres &= ~BIT_PECA(p);
+        }
+    }
+    return mao;
+}
 
-    DrawText(TextFormat("Monte: %d", monte.topo + 1), 50, 640, 20, WHITE);
+// Monta a crença do jogador 'observador' (1 ou 2) refazendo o histórico da
+// partida: só usa o que ele viu (jogadas, compras e passes do adversário - a
+// peça comprada pelo adversário não é olhada)
+void crencaDoHistorico(const Historico *hist, int observador, Crenca *c)
+{
+    int pontas[2] = {-1, -1};
+    iniciarCrenca(c, PECAS_POR_MAO);
+    for (int i = 0; i <= hist->topo; i++)
+    {
+        const Jogada *j = &hist->jogadas[i];
+        int doAdversario = j->jogador != observador;
+        if (j->tipo == 'J')
+        {
+            int peca = indicePeca[j->peca.lado1][j->peca.lado2];
+            if (doAdversario)
+                crencaJogada(c, peca);
+            if (pontas[0] < 0)
+            {
+                pontas[0] = j->peca.lado1;
+                pontas[1] = j->peca.lado2;
+            }
+            else
+            {
+                int lado = (j->lado == 'E' || j->lado == 'e') ? 0 : 1;
+                pontas[lado] = (j->peca.lado1 == pontas[lado]) ? j->peca.lado2 : j->peca.lado1;
+            }
+        }
+        else if (doAdversario)
+        {
+            crencaVazio(c, pontas[0], pontas[1]);
+            if (j->tipo == 'C')
+                crencaCompra(c);
+        }
+    }
 }
 
-void desenharMensagem()
+// Sorteia um "mundo" consistente com o que o jogador da vez sabe: a mão do
+// adversário é sorteada entre as peças que ele não vê (respeitando a crença,
+// se houver); o resto vai para o monte
+void amostrarMundo(const EstadoMotor *e, const Crenca *crenca, EstadoMotor *mundo, uint64_t *semente)
 {
-    if (tempoMensagem-- > 0)
+    int eu = e->vez, adv = eu ^ 1;
+    MascaraPecas ocultas = e->mao[adv] | e->monte;
+    int tamanho = contarPecas(e->mao[adv]);
+
+    *mundo = *e;
+    mundo->mao[adv] = 0;
+    if (crenca)
+        mundo->mao[adv] = sortearMaoCrenca(crenca, ocultas, semente);
+    ocultas &= ~mundo->mao[adv];
+    for (int i = contarPecas(mundo->mao[adv]); i < tamanho; i++)
     {
-        DrawRectangle(SCREEN_WIDTH / 2 - 250, SCREEN_HEIGHT - 100, 500, 60, Fade(BLACK, 0.8f));
-        DrawText(mensagem, SCREEN_WIDTH / 2 - 240, SCREEN_HEIGHT - 85, 20, WHITE);
+        int p = sortearPeca(ocultas, semente);
+        ocultas &= ~BIT_PECA(p);
+        mundo->mao[adv] |= BIT_PECA(p);
     }
+    mundo->monte = ocultas;
+    mundo->chave = calcularChaveMotor(mundo);
 }
 
-// Renderiza a tela do menu principal
-// Interface gráfica criada com funções de desenho da Raylib
-void desenharMenu()
+// ===== Busca expectiminimax com poda alfa-beta =====
+// Negamax com nós de acaso nas compras (média sobre as peças do monte),
+// tabela de transposição por chave Zobrist, ordenação por lance da tabela,
+// lances assassinos (killer moves) e heurística de histórico, e aprofundamento
+// iterativo com limite de tempo. A informação oculta é tratada por amostragem:
+// cada busca roda em vários mundos sorteados e os valores da raiz são somados.
+#define TT_BITS 18
+#define MAX_PLY 96
+#define TT_EXATO 0
+#define TT_INFERIOR 1
+#define TT_SUPERIOR 2
+
+typedef struct
 {
-    DrawText("DOMINÓ CLASH", SCREEN_WIDTH / 2 - 200, 80, 60, GOLD);
-    DrawText("Humano vs IA Estrategica", SCREEN_WIDTH / 2 - 150, 160, 25, WHITE);
+    uint64_t chave;
+    int16_t valor;
+    int8_t profundidade;
+    uint8_t tipo;
+    Lance melhor;
+} EntradaTT;
 
-    DrawRectangle(SCREEN_WIDTH / 2 - 150, 240, 300, 60, BLUE);
-    DrawText("JOGAR", SCREEN_WIDTH / 2 - 60, 258, 30, WHITE);
+typedef struct
+{
+    EntradaTT *tt;
+    Lance assassinos[MAX_PLY][2];
+    int historia[2][NUM_PECAS][2];
+    long long nos;
+    double prazo;
+    int abortou, heuristica;
+    int emDisputa;            // folhas finais valem a equidade da disputa
+    ContextoDisputa disputa;
+    double equidadeNeutra;    // equidade se a rodada não mudar o placar
+    double escalaDisputa;     // equidade -> escala de valorTerminal()
+} Buscador;
 
-    DrawRectangle(SCREEN_WIDTH / 2 - 150, 320, 300, 60, GREEN);
-    DrawText("REGRAS", SCREEN_WIDTH / 2 - 70, 338, 30, WHITE);
+typedef struct
+{
+    int profundidadeMax;
+    double tempoLimite; // segundos por jogada
+    int mundos;         // quantos mundos sorteados por jogada
+    int usarCrenca;     // sorteia só mundos consistentes com compras/passes
+} ConfigBusca;
 
-    DrawRectangle(SCREEN_WIDTH / 2 - 150, 400, 300, 60, PURPLE);
-    DrawText("SOBRE", SCREEN_WIDTH / 2 - 60, 418, 30, WHITE);
+typedef struct
+{
+    long long nos;
+    double segundos;
+    int profundidade, valor;
+} RelatorioBusca;
 
-    DrawRectangle(SCREEN_WIDTH / 2 - 150, 480, 300, 50, RED);
-    DrawText("SAIR", SCREEN_WIDTH / 2 - 35, 495, 25, WHITE);
+ConfigBusca configBuscaIA = {40, 0.5, 12, 1};
 
-    DrawText("Nova(Velha) InfancIA - 2025", SCREEN_WIDTH / 2 - 150, 660, 18, LIGHTGRAY);
+Buscador *criarBuscador()
+{
+    Buscador *b = calloc(1, sizeof(Buscador));
+    if (!b)
+        return NULL;
+    b->tt = calloc((size_t)1 << TT_BITS, sizeof(EntradaTT));
+    if (!b->tt)
+    {
+        free(b);
+        return NULL;
+    }
+    return b;
 }
 
-// Exibe as regras do jogo de forma visual e organizada
-void desenharRegras()
+void liberarBuscador(Buscador *b)
 {
-    DrawText("REGRAS DO DOMINÓ", SCREEN_WIDTH / 2 - 200, 50, 40, GOLD);
-
-    DrawText("OBJETIVO:", 50, 120, 25, WHITE);
-    DrawText("Ser o primeiro a ficar sem pecas", 50, 150, 20, LIGHTGRAY);
-
-    DrawText("COMO JOGAR:", 50, 200, 25, WHITE);
-    DrawText("- Cada jogador comeca com 6 pecas", 50, 230, 20, LIGHTGRAY);
-    DrawText("- Encaixe pecas pelos numeros iguais", 50, 260, 20, LIGHTGRAY);
-    DrawText("- Escolha ESQUERDA ou DIREITA para jogar", 50, 290, 20, LIGHTGRAY);
-    DrawText("- Sem jogadas validas? Compre do monte", 50, 320, 20, LIGHTGRAY);
+    if (!b)
+        return;
+    free(b->tt);
+    free(b);
+}
 
-    DrawText("VITORIA:", 50, 370, 25, WHITE);
-    DrawText("- Vence quem ficar sem pecas primeiro", 50, 400, 20, LIGHTGRAY);
-    DrawText("- Se o monte acabar, vence quem tiver", 50, 430, 20, LIGHTGRAY);
-    DrawText("  menos pontos nas pecas restantes", 50, 460, 20, LIGHTGRAY);
+// Troca o objetivo do buscador (NULL = rodada avulsa). Os valores guardados
+// na tabela de transposição dependem do placar, então ela é zerada quando ele muda
+void definirDisputaBuscador(Buscador *b, const ContextoDisputa *d)
+{
+    if (d ? (b->emDisputa && b->disputa.tabela == d->tabela && b->disputa.falta[0] == d->falta[0] &&
+             b->disputa.falta[1] == d->falta[1] && b->disputa.primeiro == d->primeiro)
+          : !b->emDisputa)
+        return;
+    b->emDisputa = d != NULL;
+    if (d)
+    {
+        // Uma rodada típica (PONTOS_REFERENCIA_DISPUTA) ganha vale VALOR_VITORIA, como na
+        // rodada avulsa: assim as folhas finais ficam na mesma escala das heurísticas
+        int f0 = d->falta[0], f1 = d->falta[1], p = d->primeiro ^ 1;
+        double ganho = equidadeDisputa(d->tabela, f0 - PONTOS_REFERENCIA_DISPUTA, f1, p) -
+                       equidadeDisputa(d->tabela, f0, f1 - PONTOS_REFERENCIA_DISPUTA, p);
+        b->disputa = *d;
+        b->equidadeNeutra = equidadeDisputa(d->tabela, f0, f1, p);
+        b->escalaDisputa = 2.0 * VALOR_VITORIA / (ganho > 1e-6 ? ganho : 1e-6);
+    }
+    memset(b->tt, 0, ((size_t)1 << TT_BITS) * sizeof(EntradaTT));
+}
 
-    DrawRectangle(SCREEN_WIDTH / 2 - 100, 550, 200, 50, BLUE);
-    DrawText("VOLTAR", SCREEN_WIDTH / 2 - 50, 565, 25, WHITE);
+// Valor final da rodada para 'jogador' medido na disputa: o ganho de
+// equidade sobre a rodada sem pontos, na escala do buscador
+static int valorTerminalDisputa(const Buscador *b, const EstadoMotor *e, int jogador)
+{
+    double valor = (equidadeFinalDisputa(&b->disputa, e) - b->equidadeNeutra) * b->escalaDisputa;
+    if (valor > LIMITE_VALOR_DISPUTA)
+        valor = LIMITE_VALOR_DISPUTA;
+    if (valor < -LIMITE_VALOR_DISPUTA)
+        valor = -LIMITE_VALOR_DISPUTA;
+    int v = (int)floor(valor + 0.5);
+    return jogador ? -v : v;
 }
 
-void desenharSobre()
+static inline int mesmoLance(Lance a, Lance b)
 {
-    DrawText("SOBRE O PROJETO", SCREEN_WIDTH / 2 - 220, 20, 40, GOLD);
+    return a.peca == b.peca && a.lado == b.lado;
+}
 
-    DrawText("AUTORES:", 50, 70, 23, WHITE);
-    DrawText("Davi Santiago e Jose Jorge", 50, 95, 18, LIGHTGRAY);
+static int negamax(Buscador *b, const EstadoMotor *e, int prof, int ply, int alfa, int beta)
+{
+    if ((++b->nos & 1023) == 0 && agoraSegundos() > b->prazo)
+        b->abortou = 1;
+    if (b->abortou)
+        return 0;
+
+    if (fimMotor(e))
+        return b->emDisputa ? valorTerminalDisputa(b, e, e->vez) : valorTerminal(e, e->vez);
+    if (prof <= 0 || ply >= MAX_PLY - 1)
+    {
+        b->heuristica = 1;
+        return avaliarMotor(e, e->vez);
+    }
+
+    EntradaTT *ent = &b->tt[e->chave & (((uint64_t)1 << TT_BITS) - 1)];
+    Lance lanceTT = {LANCE_PASSAR, -1};
+    if (ent->chave == e->chave)
+    {
+        lanceTT = ent->melhor;
+        if (ent->profundidade >= prof)
+        {
+            if (ent->tipo == TT_EXATO ||
+                (ent->tipo == TT_INFERIOR && ent->valor >= beta) ||
+                (ent->tipo == TT_SUPERIOR && ent->valor <= alfa))
+                return ent->valor;
+        }
+    }
+
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances);
+    int alfaOriginal = alfa, melhor = -VALOR_INFINITO;
+    Lance melhorLance = lances[0];
+
+    if (lances[0].peca == LANCE_COMPRAR)
+    {
+        // Nó de acaso: cada peça do monte tem a mesma chance de sair
+        int soma = 0, k = 0;
+        for (MascaraPecas m = e->monte; m; m &= m - 1, k++)
+        {
+            EstadoMotor filho = *e;
+            comprarPecaMotor(&filho, primeiraPeca(m));
+            soma += negamax(b, &filho, prof - 1, ply + 1, -VALOR_INFINITO, VALOR_INFINITO);
+        }
+        melhor = soma / k;
+        alfaOriginal = -VALOR_INFINITO;
+        beta = VALOR_INFINITO;
+    }
+    else if (lances[0].peca == LANCE_PASSAR)
+    {
+        EstadoMotor filho = *e;
+        aplicarLance(&filho, lances[0]);
+        melhor = -negamax(b, &filho, prof - 1, ply + 1, -beta, -alfa);
+    }
+    else
+    {
+        // Ordenação: lance da tabela, assassinos deste ply, depois histórico
+        int notas[MAX_LANCES];
+        for (int i = 0; i < n; i++)
+        {
+            if (mesmoLance(lances[i], lanceTT))
+                notas[i] = 1 << 30;
+            else if (mesmoLance(lances[i], b->assassinos[ply][0]))
+                notas[i] = 1 << 29;
+            else if (mesmoLance(lances[i], b->assassinos[ply][1]))
+                notas[i] = 1 << 28;
+            else
+                notas[i] = b->historia[e->vez][lances[i].peca][lances[i].lado] * 16 + pontosPeca[lances[i].peca];
+        }
+
+        for (int i = 0; i < n; i++)
+        {
+            int melhorIdx = i;
+            for (int j = i + 1; j < n; j++)
+                if (notas[j] > notas[melhorIdx])
+                    melhorIdx = j;
+            Lance l = lances[melhorIdx];
+            lances[melhorIdx] = lances[i];
+            notas[melhorIdx] = notas[i];
+            lances[i] = l;
+
+            EstadoMotor filho = *e;
+            aplicarLance(&filho, l);
+            int valor = -negamax(b, &filho, prof - 1, ply + 1, -beta, -alfa);
+            if (b->abortou)
+                return 0;
+            if (valor > melhor)
+            {
+                melhor = valor;
+                melhorLance = l;
+            }
+            if (valor > alfa)
+                alfa = valor;
+            if (alfa >= beta)
+            {
+                if (!mesmoLance(l, b->assassinos[ply][0]))
+                {
+                    b->assassinos[ply][1] = b->assassinos[ply][0];
+                    b->assassinos[ply][0] = l;
+                }
+                b->historia[e->vez][l.peca][l.lado] += prof * prof;
+                break;
+            }
+        }
+    }
+
+    if (b->abortou)
+        return 0;
+    ent->chave = e->chave;
+    ent->valor = (int16_t)melhor;
+    ent->profundidade = (int8_t)prof;
+    ent->melhor = melhorLance;
+    ent->tipo = melhor <= alfaOriginal ? TT_SUPERIOR : (melhor >= beta ? TT_INFERIOR : TT_EXATO);
+    return melhor;
+}
+
+// Escolhe o lance do jogador da vez usando só o que ele sabe (a própria mão,
+// a mesa e as quantidades). Aprofunda até o tempo acabar; uma profundidade
+// interrompida é descartada e vale a última completa.
+// Valor de cada lance legal para quem joga (média sobre os mundos sorteados,
+// na última profundidade completa); retorna quantos lances há
+int avaliarLancesBusca(Buscador *b, const EstadoMotor *e, const Crenca *crenca, const ConfigBusca *cfg,
+                       uint64_t *semente, Lance *lances, int *valores, RelatorioBusca *rel)
+{
+    int n = gerarLances(e, lances);
+    double inicio = agoraSegundos();
+    memset(valores, 0, n * sizeof(int));
+    if (rel)
+        *rel = (RelatorioBusca){0, 0, 0, 0};
+    if (n == 1)
+        return n;
+
+    int mundos = cfg->mundos > 0 ? cfg->mundos : 1;
+    EstadoMotor *amostras = malloc(mundos * sizeof(EstadoMotor));
+    if (!amostras)
+        return n;
+    for (int w = 0; w < mundos; w++)
+        amostrarMundo(e, cfg->usarCrenca ? crenca : NULL, &amostras[w], semente);
+
+    memset(b->assassinos, 0, sizeof(b->assassinos));
+    for (int j = 0; j < 2; j++)
+        for (int p = 0; p < NUM_PECAS; p++)
+            b->historia[j][p][0] /= 2, b->historia[j][p][1] /= 2;
+    b->nos = 0;
+    b->abortou = 0;
+    b->prazo = inicio + cfg->tempoLimite;
+
+    for (int prof = 1; prof <= cfg->profundidadeMax; prof++)
+    {
+        long long soma[MAX_LANCES] = {0};
+        b->heuristica = 0;
+        for (int w = 0; w < mundos && !b->abortou; w++)
+            for (int i = 0; i < n && !b->abortou; i++)
+            {
+                EstadoMotor filho = amostras[w];
+                aplicarLance(&filho, lances[i]);
+                soma[i] -= negamax(b, &filho, prof - 1, 1, -VALOR_INFINITO, VALOR_INFINITO);
+            }
+        if (b->abortou)
+            break;
+
+        for (int i = 0; i < n; i++)
+            valores[i] = (int)(soma[i] / mundos);
+        if (rel)
+            rel->profundidade = prof;
+        // Nenhuma folha heurística: a árvore inteira foi resolvida
+        if (!b->heuristica)
+            break;
+    }
+    free(amostras);
+
+    if (rel)
+    {
+        rel->nos = b->nos;
+        rel->segundos = agoraSegundos() - inicio;
+    }
+    return n;
+}
+
+Lance buscarLance(Buscador *b, const EstadoMotor *e, const Crenca *crenca, const ConfigBusca *cfg, uint64_t *semente, RelatorioBusca *rel)
+{
+    Lance lances[MAX_LANCES];
+    int valores[MAX_LANCES];
+    int n = avaliarLancesBusca(b, e, crenca, cfg, semente, lances, valores, rel), melhor = 0;
+    for (int i = 1; i < n; i++)
+        if (valores[i] > valores[melhor])
+            melhor = i;
+    if (rel)
+        rel->valor = valores[melhor];
+    return lances[melhor];
+}
+
+// ===== Busca em árvore Monte Carlo (MCTS) em paralelo =====
+// ISMCTS: cada iteração sorteia um mundo consistente com a crença, desce pela
+// árvore só pelos filhos legais nesse mundo (UCB1 com contagem de
+// disponibilidade), expande uma folha e termina com uma partida aleatória.
+// Os nós guardam lances públicos (peça jogada, compra, passe), então a mesma
+// árvore serve para todos os mundos sorteados. Dois modos de paralelismo:
+//   raiz:   cada thread cresce a sua árvore e no fim as visitas da raiz são somadas
+//   árvore: as threads dividem uma árvore só, sem travas (CAS + perda virtual)
+#define MCTS_VITORIA 2 // recompensas em meios pontos: vitória 2, empate 1, derrota 0
+#define NO_FOLHA 0
+#define NO_EXPANDINDO 1
+#define NO_EXPANDIDO 2
+#define NO_CHEIO 3 // sem espaço para os filhos: continua folha
+
+typedef enum
+{
+    MCTS_RAIZ,
+    MCTS_ARVORE
+} ModoMcts;
+
+typedef struct
+{
+    Lance lance;    // lance que leva a este nó
+    int8_t jogador; // quem fez o lance (as recompensas são do ponto de vista dele)
+    _Atomic int estado;
+    _Atomic int visitas, disponivel, perdaVirtual, soma;
+    int primeiroFilho, numFilhos; // filhos ficam contíguos no vetor de nós
+} NoMcts;
+
+typedef struct
+{
+    NoMcts *nos; // nós[0] = raiz
+    int capacidade;
+    _Atomic int usados;
+} ArvoreMcts;
+
+typedef struct
+{
+    int threads;        // 0 = todos os núcleos
+    ModoMcts modo;
+    double tempoLimite; // segundos por jogada
+    int maxIteracoes;   // por jogada, somando as threads (0 = só o tempo)
+    double exploracao;  // constante do UCB1
+    int perdaVirtual;   // visitas perdidas fictícias enquanto uma thread passa pelo nó
+    int usarCrenca;
+    int maxNos;         // total de nós, repartido entre as árvores no modo raiz
+} ConfigMcts;
+
+typedef struct
+{
+    long long iteracoes;
+    double segundos;
+    int threads, nos;
+    double valor; // chance estimada de vitória do lance escolhido (0 a 1)
+} RelatorioMcts;
+
+typedef struct
+{
+    ArvoreMcts *arvore;
+    const EstadoMotor *raiz;
+    const Crenca *crenca;
+    const ConfigMcts *cfg;
+    double prazo;
+    _Atomic int *iteracoes; // contador de todas as threads (para maxIteracoes)
+    uint64_t semente;
+    long long feitas;
+} TrabalhoMcts;
+
+ConfigMcts configMctsIA = {0, MCTS_ARVORE, 0.5, 0, 0.7, 3, 1, 1 << 20};
+
+// Lances que alguém poderia fazer vendo só a parte pública do estado:
+// qualquer peça fora da mesa que encaixe, mais comprar (ou passar)
+static int lancesPublicos(const EstadoMotor *e, Lance *lances)
+{
+    MascaraPecas fora = TODAS_PECAS & ~e->mesa;
+    int n = 0;
+
+    if (e->pontas[0] < 0)
+    {
+        for (; fora; fora &= fora - 1)
+            lances[n++] = (Lance){primeiraPeca(fora), 0};
+        return n;
+    }
+    for (MascaraPecas m = fora & pecasComPonto[e->pontas[0]]; m; m &= m - 1)
+        lances[n++] = (Lance){primeiraPeca(m), 0};
+    if (e->pontas[1] != e->pontas[0])
+        for (MascaraPecas m = fora & pecasComPonto[e->pontas[1]]; m; m &= m - 1)
+            lances[n++] = (Lance){primeiraPeca(m), 1};
+    lances[n++] = (Lance){e->monte ? LANCE_COMPRAR : LANCE_PASSAR, 0};
+    return n;
+}
+
+// Só a thread que ganha o CAS cria os filhos; as outras tratam o nó como folha
+static int expandirNoMcts(ArvoreMcts *a, NoMcts *no, const EstadoMotor *e)
+{
+    int esperado = NO_FOLHA;
+    if (!atomic_compare_exchange_strong(&no->estado, &esperado, NO_EXPANDINDO))
+        return 0;
+
+    Lance lances[NUM_PECAS + 1];
+    int n = lancesPublicos(e, lances);
+    int base = atomic_fetch_add_explicit(&a->usados, n, memory_order_relaxed);
+    if (base + n > a->capacidade)
+    {
+        atomic_store(&no->estado, NO_CHEIO);
+        return 0;
+    }
+    for (int i = 0; i < n; i++)
+    {
+        NoMcts *filho = &a->nos[base + i];
+        filho->lance = lances[i];
+        filho->jogador = (int8_t)e->vez;
+        atomic_init(&filho->estado, NO_FOLHA);
+        atomic_init(&filho->visitas, 0);
+        atomic_init(&filho->disponivel, 0);
+        atomic_init(&filho->perdaVirtual, 0);
+        atomic_init(&filho->soma, 0);
+    }
+    no->primeiroFilho = base;
+    no->numFilhos = n;
+    atomic_store_explicit(&no->estado, NO_EXPANDIDO, memory_order_release);
+    return 1;
+}
+
+// UCB1 entre os filhos legais no mundo atual. Cada filho legal ganha uma
+// "disponibilidade", que faz o papel das visitas do pai na fórmula.
+static NoMcts *selecionarFilhoMcts(ArvoreMcts *a, const NoMcts *no, const Lance *legais, int nLegais, double c)
+{
+    NoMcts *melhor = NULL;
+    double melhorValor = -1;
+
+    for (int i = 0; i < no->numFilhos; i++)
+    {
+        NoMcts *filho = &a->nos[no->primeiroFilho + i];
+        int legal = 0;
+        for (int k = 0; k < nLegais && !legal; k++)
+            legal = mesmoLance(filho->lance, legais[k]);
+        if (!legal)
+            continue;
+
+        int disponivel = atomic_fetch_add_explicit(&filho->disponivel, 1, memory_order_relaxed) + 1;
+        int visitas = atomic_load_explicit(&filho->visitas, memory_order_relaxed) +
+                      atomic_load_explicit(&filho->perdaVirtual, memory_order_relaxed);
+        double valor;
+        if (visitas == 0)
+            valor = 1e9; // nunca visitado: vai primeiro
+        else
+            valor = atomic_load_explicit(&filho->soma, memory_order_relaxed) / (double)(MCTS_VITORIA * visitas) +
+                    c * sqrt(log(disponivel) / visitas);
+        if (valor > melhorValor)
+        {
+            melhorValor = valor;
+            melhor = filho;
+        }
+    }
+    return melhor;
+}
+
+// Partida aleatória até o fim; retorna como fimMotor()
+static int rolloutMcts(EstadoMotor *e, uint64_t *semente)
+{
+    Lance lances[MAX_LANCES];
+    int fim;
+    while ((fim = fimMotor(e)) == 0)
+    {
+        int n = gerarLances(e, lances);
+        Lance l = lances[aleatorioAte(semente, n)];
+        if (l.peca == LANCE_COMPRAR)
+            comprarPecaMotor(e, sortearPeca(e->monte, semente));
+        else
+            aplicarLance(e, l);
+    }
+    return fim;
+}
+
+static void iteracaoMcts(ArvoreMcts *a, const EstadoMotor *raiz, const Crenca *crenca, const ConfigMcts *cfg, int perda, uint64_t *semente)
+{
+    EstadoMotor e;
+    amostrarMundo(raiz, crenca, &e, semente);
+
+    NoMcts *caminho[MAX_PLY];
+    Lance legais[MAX_LANCES];
+    NoMcts *no = &a->nos[0];
+    int prof = 0, expandiu = 0;
+
+    while (!expandiu && prof < MAX_PLY && !fimMotor(&e))
+    {
+        // Uma folha só é expandida na segunda visita (a raiz, logo de cara):
+        // metade dos nós nunca seria revisitada e só gastaria memória
+        int estado = atomic_load_explicit(&no->estado, memory_order_acquire);
+        if (estado == NO_FOLHA && (prof == 0 || atomic_load_explicit(&no->visitas, memory_order_relaxed) > 0))
+            expandiu = expandirNoMcts(a, no, &e);
+        if (!expandiu && estado != NO_EXPANDIDO)
+            break;
+
+        int n = gerarLances(&e, legais);
+        NoMcts *filho = selecionarFilhoMcts(a, no, legais, n, cfg->exploracao);
+        if (!filho)
+            break;
+        if (perda)
+            atomic_fetch_add_explicit(&filho->perdaVirtual, perda, memory_order_relaxed);
+        if (filho->lance.peca == LANCE_COMPRAR)
+            comprarPecaMotor(&e, sortearPeca(e.monte, semente));
+        else
+            aplicarLance(&e, filho->lance);
+        caminho[prof++] = filho;
+        no = filho;
+    }
+
+    int fim = rolloutMcts(&e, semente);
+    for (int i = 0; i < prof; i++)
+    {
+        NoMcts *n = caminho[i];
+        int recompensa = fim == 3 ? MCTS_VITORIA / 2 : (fim == n->jogador + 1 ? MCTS_VITORIA : 0);
+        atomic_fetch_add_explicit(&n->soma, recompensa, memory_order_relaxed);
+        atomic_fetch_add_explicit(&n->visitas, 1, memory_order_relaxed);
+        if (perda)
+            atomic_fetch_sub_explicit(&n->perdaVirtual, perda, memory_order_relaxed);
+    }
+}
+
+static void *trabalharMcts(void *arg)
+{
+    TrabalhoMcts *t = (TrabalhoMcts *)arg;
+    const ConfigMcts *cfg = t->cfg;
+    int perda = cfg->modo == MCTS_ARVORE ? cfg->perdaVirtual : 0;
+    const Crenca *crenca = cfg->usarCrenca ? t->crenca : NULL;
+
+    for (;;)
+    {
+        if (cfg->maxIteracoes > 0 &&
+            atomic_fetch_add_explicit(t->iteracoes, 1, memory_order_relaxed) >= cfg->maxIteracoes)
+            break;
+        if (cfg->tempoLimite > 0 && (t->feitas & 63) == 0 && agoraSegundos() > t->prazo)
+            break;
+        iteracaoMcts(t->arvore, t->raiz, crenca, cfg, perda, &t->semente);
+        t->feitas++;
+    }
+    return NULL;
+}
+
+// Vetor de nós das árvores, guardado de uma jogada para a outra pela thread
+// que chama buscarLanceMcts(): com 1 << 20 nós são dezenas de MB, que não
+// vale alocar e zerar a cada lance. Só a raiz precisa começar zerada (os
+// filhos são preenchidos na expansão). Liberado quando a thread termina.
+static __thread NoMcts *reservaNosMcts = NULL;
+static __thread size_t capacidadeReservaMcts = 0;
+static pthread_key_t chaveReservaMcts;
+static pthread_once_t chaveReservaMctsCriada = PTHREAD_ONCE_INIT;
+
+static void criarChaveReservaMcts(void)
+{
+    pthread_key_create(&chaveReservaMcts, free);
+}
+
+static NoMcts *reservarNosMcts(size_t total)
+{
+    if (total > capacidadeReservaMcts)
+    {
+        pthread_once(&chaveReservaMctsCriada, criarChaveReservaMcts);
+        free(reservaNosMcts);
+        reservaNosMcts = malloc(total * sizeof(NoMcts));
+        capacidadeReservaMcts = reservaNosMcts ? total : 0;
+        pthread_setspecific(chaveReservaMcts, reservaNosMcts);
+    }
+    return reservaNosMcts;
+}
+
+// Escolhe o lance do jogador da vez com MCTS em cfg->threads threads. O lance
+// escolhido é o filho da raiz com mais visitas (somadas entre as árvores).
+Lance buscarLanceMcts(const EstadoMotor *e, const Crenca *crenca, const ConfigMcts *cfg, uint64_t *semente, RelatorioMcts *rel)
+{
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances);
+    double inicio = agoraSegundos();
+    int threads = cfg->threads > 0 ? cfg->threads : numeroNucleos();
+    if (rel)
+        *rel = (RelatorioMcts){0, 0, threads, 0, 0};
+    if (n == 1)
+        return lances[0];
+
+    int numArvores = cfg->modo == MCTS_RAIZ ? threads : 1;
+    int capacidade = cfg->maxNos / numArvores;
+    if (capacidade < 2 * NUM_PECAS)
+        capacidade = 2 * NUM_PECAS;
+    NoMcts *nos = reservarNosMcts((size_t)numArvores * capacidade);
+    ArvoreMcts *arvores = calloc(numArvores, sizeof(ArvoreMcts));
+    TrabalhoMcts *trabalhos = calloc(threads, sizeof(TrabalhoMcts));
+    int ok = nos && arvores && trabalhos;
+    for (int i = 0; ok && i < numArvores; i++)
+    {
+        arvores[i].nos = nos + (size_t)i * capacidade;
+        arvores[i].capacidade = capacidade;
+        atomic_init(&arvores[i].usados, 1);
+        memset(&arvores[i].nos[0], 0, sizeof(NoMcts));
+    }
+
+    Lance escolhido = lances[0];
+    if (ok)
+    {
+        _Atomic int iteracoes;
+        atomic_init(&iteracoes, 0);
+        ConfigMcts config = *cfg;
+        if (config.tempoLimite <= 0 && config.maxIteracoes <= 0)
+            config.maxIteracoes = 1000;
+        for (int t = 0; t < threads; t++)
+        {
+            trabalhos[t].arvore = &arvores[cfg->modo == MCTS_RAIZ ? t : 0];
+            trabalhos[t].raiz = e;
+            trabalhos[t].crenca = crenca;
+            trabalhos[t].cfg = &config;
+            trabalhos[t].prazo = inicio + config.tempoLimite;
+            trabalhos[t].iteracoes = &iteracoes;
+            trabalhos[t].semente = proximoAleatorio(semente);
+        }
+        executarEmThreads(threads, trabalharMcts, trabalhos, sizeof(TrabalhoMcts));
+
+        // Junta as visitas de cada lance legal da raiz em todas as árvores
+        long long visitas[MAX_LANCES] = {0}, soma[MAX_LANCES] = {0};
+        for (int k = 0; k < numArvores; k++)
+        {
+            NoMcts *raiz = &arvores[k].nos[0];
+            if (atomic_load(&raiz->estado) != NO_EXPANDIDO)
+                continue;
+            for (int f = 0; f < raiz->numFilhos; f++)
+            {
+                NoMcts *filho = &arvores[k].nos[raiz->primeiroFilho + f];
+                for (int i = 0; i < n; i++)
+                    if (mesmoLance(filho->lance, lances[i]))
+                    {
+                        visitas[i] += atomic_load(&filho->visitas);
+                        soma[i] += atomic_load(&filho->soma);
+                    }
+            }
+        }
+        int melhor = 0;
+        for (int i = 1; i < n; i++)
+            if (visitas[i] > visitas[melhor])
+                melhor = i;
+        escolhido = lances[melhor];
+
+        if (rel)
+        {
+            for (int t = 0; t < threads; t++)
+                rel->iteracoes += trabalhos[t].feitas;
+            for (int k = 0; k < numArvores; k++)
+            {
+                int usados = atomic_load(&arvores[k].usados);
+                rel->nos += usados < capacidade ? usados : capacidade;
+            }
+            rel->valor = visitas[melhor] ? soma[melhor] / (double)(MCTS_VITORIA * visitas[melhor]) : 0.5;
+        }
+    }
+
+    free(arvores);
+    free(trabalhos);
+    if (rel)
+        rel->segundos = agoraSegundos() - inicio;
+    return escolhido;
+}
+
+// ===== Tablebase de finais =====
+// Com o monte vazio não há mais informação oculta: a mão do adversário é tudo
+// o que não está na mesa nem na própria mão. Os finais com até maxPecas peças
+// em cada mão são resolvidos de uma vez por análise retrógrada, camada por
+// camada (menos peças primeiro) e guardados com 2 bits por posição.
+// Índice (hash perfeito): camada (peças de quem joga, peças do outro, passadas)
+// + posto combinatório do par de mãos * POSICOES_PAR + índice das pontas (como uma peça)
+// Valor para quem joga: 1 = derrota, 2 = empate, 3 = vitória, 0 = fora da tabela
+#define MAX_PECAS_TABLEBASE 3
+// Posições por par de mãos arredondadas para múltiplo de 4 (um byte inteiro)
+#define POSICOES_PAR ((NUM_PECAS + 3) & ~3)
+#define MAGICA_TABLEBASE "DTB1"
+#define CABECALHO_TABLEBASE 16 // magica[4], maxPecas (uint32), posições (uint64)
+
+typedef struct
+{
+    const uint8_t *dados; // 4 posições por byte
+    int maxPecas;
+    uint64_t posicoes;
+    uint64_t inicio[MAX_PECAS_TABLEBASE + 1][MAX_PECAS_TABLEBASE + 1]; // camada com passadas = 0
+    ArquivoMapeado arquivo;
+} Tablebase;
+
+Tablebase tablebase;
+
+// Quantos pares de mãos (k1 peças para quem joga, k2 para o outro) existem
+static uint64_t paresTablebase(int k1, int k2)
+{
+    return binomial[NUM_PECAS][k1] * binomial[NUM_PECAS - k1][k2];
+}
+
+static void montarIndiceTablebase(Tablebase *tb, int maxPecas)
+{
+    tb->maxPecas = maxPecas;
+    tb->posicoes = 0;
+    for (int k1 = 1; k1 <= maxPecas; k1++)
+        for (int k2 = 1; k2 <= maxPecas; k2++)
+        {
+            tb->inicio[k1][k2] = tb->posicoes;
+            tb->posicoes += 2 * paresTablebase(k1, k2) * POSICOES_PAR;
+        }
+}
+
+// Posto colex de um subconjunto: soma de C(posição, ordem) das peças
+static uint64_t postoMascara(MascaraPecas m)
+{
+    uint64_t posto = 0;
+    for (int i = 1; m; m &= m - 1, i++)
+        posto += binomial[primeiraPeca(m)][i];
+    return posto;
+}
+
+static uint64_t indiceTablebase(const Tablebase *tb, MascaraPecas eu, MascaraPecas outro, int a, int b, int passadas)
+{
+    int k1 = contarPecas(eu), k2 = contarPecas(outro);
+    // A mão do outro é numerada entre as NUM_PECAS - k1 peças que sobram
+    MascaraPecas compacta = 0;
+    for (MascaraPecas m = outro; m; m &= m - 1)
+    {
+        int p = primeiraPeca(m);
+        compacta |= BIT_PECA(p - contarPecas(eu & (BIT_PECA(p) - 1)));
+    }
+    uint64_t par = postoMascara(eu) * binomial[NUM_PECAS - k1][k2] + postoMascara(compacta);
+    return tb->inicio[k1][k2] + passadas * paresTablebase(k1, k2) * POSICOES_PAR + par * POSICOES_PAR + indicePeca[a][b];
+}
+
+// Inverso de postoMascara() para k peças entre as 'n' primeiras posições
+static MascaraPecas mascaraDoPosto(uint64_t posto, int k, int n)
+{
+    MascaraPecas m = 0;
+    for (int i = k; i > 0; i--)
+    {
+        int c = n - 1;
+        while (binomial[c][i] > posto)
+            c--;
+        m |= BIT_PECA(c);
+        posto -= binomial[c][i];
+        n = c;
+    }
+    return m;
+}
+
+// Valor do estado para o jogador da vez (terminais não ficam na tabela)
+int valorEstadoTablebase(const Tablebase *tb, const EstadoMotor *e)
+{
+    int fim = fimMotor(e);
+    if (fim)
+        return fim == 3 ? 2 : (fim == e->vez + 1 ? 3 : 1);
+    MascaraPecas eu = e->mao[e->vez], outro = e->mao[e->vez ^ 1];
+    if (!tb->dados || e->monte || e->pontas[0] < 0 || contarPecas(eu) > tb->maxPecas || contarPecas(outro) > tb->maxPecas)
+        return 0;
+    uint64_t i = indiceTablebase(tb, eu, outro, e->pontas[0], e->pontas[1], e->passadas);
+    return (tb->dados[i >> 2] >> ((i & 3) * 2)) & 3;
+}
+
+// Valor do jogador da vez e o melhor lance (se 'melhor' não for NULL)
+// Retorna 0 se o estado não está coberto pela tabela
+int consultarTablebase(const Tablebase *tb, const EstadoMotor *e, Lance *melhor)
+{
+    if (!tb->dados || e->monte || e->pontas[0] < 0 || fimMotor(e))
+        return 0;
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances), valor = 0;
+    for (int i = 0; i < n; i++)
+    {
+        EstadoMotor filho = *e;
+        aplicarLance(&filho, lances[i]);
+        int v = valorEstadoTablebase(tb, &filho);
+        if (v == 0)
+            return 0;
+        if (4 - v > valor)
+        {
+            valor = 4 - v;
+            if (melhor)
+                *melhor = lances[i];
+        }
+    }
+    return valor;
+}
+
+typedef struct
+{
+    Tablebase *tb;
+    uint8_t *dados;
+    int k1, k2, passadas;
+    uint64_t primeiroPar, fimPar;
+    long long contagem[4];
+} TrabalhoTablebase;
+
+// Resolve uma faixa de pares de mãos de uma camada. Cada par ocupa
+// POSICOES_PAR posições (28 = 7 bytes no duplo-6), então as faixas das
+// threads nunca dividem um byte.
+static void *resolverFaixaTablebase(void *arg)
+{
+    TrabalhoTablebase *t = (TrabalhoTablebase *)arg;
+    uint64_t pares = binomial[NUM_PECAS - t->k1][t->k2];
+
+    for (uint64_t par = t->primeiroPar; par < t->fimPar; par++)
+    {
+        MascaraPecas eu = mascaraDoPosto(par / pares, t->k1, NUM_PECAS);
+        MascaraPecas compacta = mascaraDoPosto(par % pares, t->k2, NUM_PECAS - t->k1), outro = 0;
+        // Descompacta: a posição j do outro é a j-ésima peça fora da minha mão
+        for (int p = 0, j = 0; p < NUM_PECAS; p++)
+        {
+            if (eu & BIT_PECA(p))
+                continue;
+            if (compacta & BIT_PECA(j))
+                outro |= BIT_PECA(p);
+            j++;
+        }
+
+        EstadoMotor e;
+        memset(&e, 0, sizeof(e));
+        e.mao[0] = eu;
+        e.mao[1] = outro;
+        e.mesa = TODAS_PECAS & ~eu & ~outro;
+        e.passadas = (uint8_t)t->passadas;
+        for (int a = 0; a <= MAX_PONTO; a++)
+            for (int b = a; b <= MAX_PONTO; b++)
+            {
+                e.pontas[0] = (int8_t)a;
+                e.pontas[1] = (int8_t)b;
+                int v = consultarTablebase(t->tb, &e, NULL);
+                uint64_t i = indiceTablebase(t->tb, eu, outro, a, b, t->passadas);
+                t->dados[i >> 2] |= (uint8_t)(v << ((i & 3) * 2));
+                t->contagem[v]++;
+            }
+    }
+    return NULL;
+}
+
+// Gera a tablebase em 'threads' threads e grava no arquivo
+int gerarTablebase(const char *caminho, int maxPecas, int threads)
+{
+    Tablebase tb;
+    memset(&tb, 0, sizeof(tb));
+    montarIndiceTablebase(&tb, maxPecas);
+    size_t bytes = (size_t)((tb.posicoes + 3) / 4);
+    uint8_t *dados = calloc(bytes, 1);
+    TrabalhoTablebase *trabalhos = calloc(threads, sizeof(TrabalhoTablebase));
+    if (!dados || !trabalhos)
+    {
+        free(dados);
+        free(trabalhos);
+        return 0;
+    }
+    tb.dados = dados;
+
+    printf("Gerando tablebase: ate %d pecas por mao, %llu posicoes (%.1f MB), %d threads\n", maxPecas,
+           (unsigned long long)tb.posicoes, bytes / 1048576.0, threads);
+    long long contagem[4] = {0};
+    double inicio = agoraSegundos();
+    // Jogar leva a uma camada com uma peça a menos; passar, à mesma camada
+    // com passadas = 1. Por isso: total de peças crescente, passadas = 1 antes de 0.
+    for (int total = 2; total <= 2 * maxPecas; total++)
+        for (int passadas = 1; passadas >= 0; passadas--)
+            for (int k1 = 1; k1 <= maxPecas; k1++)
+            {
+                int k2 = total - k1;
+                if (k2 < 1 || k2 > maxPecas)
+                    continue;
+                uint64_t pares = paresTablebase(k1, k2);
+                for (int t = 0; t < threads; t++)
+                    trabalhos[t] = (TrabalhoTablebase){&tb, dados, k1, k2, passadas,
+                                                       pares * t / threads, pares * (t + 1) / threads, {0}};
+                executarEmThreads(threads, resolverFaixaTablebase, trabalhos, sizeof(TrabalhoTablebase));
+                for (int t = 0; t < threads; t++)
+                    for (int v = 0; v < 4; v++)
+                        contagem[v] += trabalhos[t].contagem[v];
+            }
+    double segundos = agoraSegundos() - inicio;
+    printf("Resolvido em %.2fs (%.0f posicoes/s)\n", segundos, segundos > 0 ? tb.posicoes / segundos : 0.0);
+    printf("Quem joga: %lld vitorias | %lld empates | %lld derrotas\n", contagem[3], contagem[2], contagem[1]);
+
+    int ok = 0;
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo)
+    {
+        uint32_t max = (uint32_t)maxPecas;
+        uint64_t posicoes = tb.posicoes;
+        ok = fwrite(MAGICA_TABLEBASE, 1, 4, arquivo) == 4 && fwrite(&max, sizeof(max), 1, arquivo) == 1 &&
+             fwrite(&posicoes, sizeof(posicoes), 1, arquivo) == 1 && fwrite(dados, 1, bytes, arquivo) == bytes;
+        ok = (fclose(arquivo) == 0) && ok;
+    }
+    free(dados);
+    free(trabalhos);
+    return ok;
+}
+
+// Mapeia o arquivo gerado por gerarTablebase(); não lê nada além do cabeçalho
+int abrirTablebase(const char *caminho, Tablebase *tb)
+{
+    memset(tb, 0, sizeof(*tb));
+    if (!mapearArquivo(caminho, &tb->arquivo))
+        return 0;
+
+    const uint8_t *d = tb->arquivo.dados;
+    uint32_t maxPecas = 0;
+    uint64_t posicoes = 0;
+    if (tb->arquivo.tamanho >= CABECALHO_TABLEBASE)
+    {
+        memcpy(&maxPecas, d + 4, sizeof(maxPecas));
+        memcpy(&posicoes, d + 8, sizeof(posicoes));
+    }
+    if (maxPecas >= 1 && maxPecas <= MAX_PECAS_TABLEBASE && memcmp(d, MAGICA_TABLEBASE, 4) == 0)
+        montarIndiceTablebase(tb, (int)maxPecas);
+    if (!tb->posicoes || tb->posicoes != posicoes ||
+        tb->arquivo.tamanho < CABECALHO_TABLEBASE + (posicoes + 3) / 4)
+    {
+        desmapearArquivo(&tb->arquivo);
+        memset(tb, 0, sizeof(*tb));
+        return 0;
+    }
+    tb->dados = d + CABECALHO_TABLEBASE;
+    return 1;
+}
+
+void fecharTablebase(Tablebase *tb)
+{
+    desmapearArquivo(&tb->arquivo);
+    memset(tb, 0, sizeof(*tb));
+}
+
+// ===== Livro de aberturas =====
+// Com a mesa vazia o primeiro lance só depende da mão de quem abre: são
+// C(NUM_PECAS, PECAS_POR_MAO) mãos possíveis (376.740 no duplo-6). O gerador
+// avalia cada uma com um MCTS profundo (uma mão por thread, todos os núcleos)
+// e grava o melhor lance e a chance de vitória estimada. A entrada de uma mão fica na posição do posto
+// combinatório dela, então a consulta é um acesso direto ao arquivo mapeado.
+#define MAGICA_LIVRO "DAB1"
+#define CABECALHO_LIVRO 16 // magica[4], iterações por mão (uint32), entradas (uint64)
+#define LIVRO_SEM_LANCE 0xFF
+
+typedef struct
+{
+    uint8_t peca;    // índice da peça a abrir (LIVRO_SEM_LANCE = mão não avaliada)
+    uint8_t vitoria; // chance de vitória estimada * 255
+} EntradaLivro;
+
+typedef struct
+{
+    const EntradaLivro *entradas;
+    uint64_t quantidade;
+    uint32_t iteracoes;
+    ArquivoMapeado arquivo;
+} LivroAbertura;
+
+LivroAbertura livroAbertura;
+
+// Lance do livro para quem abre a partida. Retorna 0 se o estado não é uma
+// abertura (mesa vazia, mão completa) ou se a mão não foi avaliada.
+int consultarLivroAbertura(const LivroAbertura *livro, const EstadoMotor *e, Lance *lance, double *vitoria)
+{
+    MascaraPecas mao = e->mao[e->vez];
+    if (!livro->entradas || e->mesa || e->pontas[0] >= 0 || contarPecas(mao) != PECAS_POR_MAO)
+        return 0;
+    uint64_t posto = postoMascara(mao);
+    if (posto >= livro->quantidade)
+        return 0;
+    EntradaLivro entrada = livro->entradas[posto];
+    if (entrada.peca == LIVRO_SEM_LANCE || !(mao & BIT_PECA(entrada.peca)))
+        return 0;
+    *lance = (Lance){(int8_t)entrada.peca, 0};
+    if (vitoria)
+        *vitoria = entrada.vitoria / 255.0;
+    return 1;
+}
+
+typedef struct
+{
+    EntradaLivro *entradas;
+    uint64_t maos;
+    _Atomic long long *proxima;
+    const ConfigMcts *cfg;
+} TrabalhoLivro;
+
+static void *avaliarAberturas(void *arg)
+{
+    TrabalhoLivro *t = (TrabalhoLivro *)arg;
+    long long passo = t->maos / 100 > 0 ? (long long)(t->maos / 100) : 1;
+    long long posto;
+
+    while ((posto = atomic_fetch_add(t->proxima, 1)) < (long long)t->maos)
+    {
+        // A mão do adversário é só um tamanho: o MCTS sorteia uma nova a cada iteração
+        EstadoMotor e;
+        memset(&e, 0, sizeof(e));
+        e.pontas[0] = e.pontas[1] = -1;
+        e.mao[0] = mascaraDoPosto((uint64_t)posto, PECAS_POR_MAO, NUM_PECAS);
+        MascaraPecas resto = TODAS_PECAS & ~e.mao[0];
+        for (int i = 0; i < PECAS_POR_MAO; i++, resto &= resto - 1)
+            e.mao[1] |= resto & -resto;
+        e.monte = resto;
+        e.chave = calcularChaveMotor(&e);
+
+        uint64_t semente = 0xAB3A7u ^ ((uint64_t)posto * 0x9E3779B97F4A7C15ULL);
+        RelatorioMcts rel;
+        Lance l = buscarLanceMcts(&e, NULL, t->cfg, &semente, &rel);
+        t->entradas[posto].peca = (uint8_t)l.peca;
+        t->entradas[posto].vitoria = (uint8_t)(rel.valor * 255.0 + 0.5);
+        if ((posto + 1) % passo == 0)
+            printf("  %lld/%llu maos\n", posto + 1, (unsigned long long)t->maos);
+    }
+    return NULL;
+}
+
+// Gera o livro: 'iteracoes' playouts de MCTS por mão. 'maos' < total deixa o
+// resto sem lance (útil para testar o formato com poucas mãos).
+int gerarLivroAbertura(const char *caminho, int iteracoes, uint64_t maos, int threads)
+{
+    uint64_t total = binomial[NUM_PECAS][PECAS_POR_MAO];
+    if (maos == 0 || maos > total)
+        maos = total;
+    EntradaLivro *entradas = malloc(total * sizeof(EntradaLivro));
+    TrabalhoLivro *trabalhos = calloc(threads, sizeof(TrabalhoLivro));
+    if (!entradas || !trabalhos)
+    {
+        free(entradas);
+        free(trabalhos);
+        return 0;
+    }
+    memset(entradas, LIVRO_SEM_LANCE, total * sizeof(EntradaLivro));
+
+    ConfigMcts cfg = {1, MCTS_RAIZ, 0, iteracoes, 0.7, 0, 0, 1 << 20};
+    _Atomic long long proxima;
+    atomic_init(&proxima, 0);
+    for (int t = 0; t < threads; t++)
+        trabalhos[t] = (TrabalhoLivro){entradas, maos, &proxima, &cfg};
+
+    printf("Gerando livro de aberturas: %llu de %llu maos, %d playouts por mao, %d threads\n",
+           (unsigned long long)maos, (unsigned long long)total, iteracoes, threads);
+    double inicio = agoraSegundos();
+    executarEmThreads(threads, avaliarAberturas, trabalhos, sizeof(TrabalhoLivro));
+    double segundos = agoraSegundos() - inicio;
+    printf("Avaliado em %.1fs (%.1f maos/s)\n", segundos, segundos > 0 ? maos / segundos : 0.0);
+
+    int ok = 0;
+    FILE *arquivo = fopen(caminho, "wb");
+    if (arquivo)
+    {
+        uint32_t iter = (uint32_t)iteracoes;
+        ok = fwrite(MAGICA_LIVRO, 1, 4, arquivo) == 4 && fwrite(&iter, sizeof(iter), 1, arquivo) == 1 &&
+             fwrite(&total, sizeof(total), 1, arquivo) == 1 &&
+             fwrite(entradas, sizeof(EntradaLivro), total, arquivo) == total;
+        ok = (fclose(arquivo) == 0) && ok;
+    }
+    free(entradas);
+    free(trabalhos);
+    return ok;
+}
+
+int abrirLivroAbertura(const char *caminho, LivroAbertura *livro)
+{
+    memset(livro, 0, sizeof(*livro));
+    if (!mapearArquivo(caminho, &livro->arquivo))
+        return 0;
+
+    const uint8_t *d = livro->arquivo.dados;
+    uint64_t quantidade = 0;
+    if (livro->arquivo.tamanho >= CABECALHO_LIVRO && memcmp(d, MAGICA_LIVRO, 4) == 0)
+    {
+        memcpy(&livro->iteracoes, d + 4, sizeof(livro->iteracoes));
+        memcpy(&quantidade, d + 8, sizeof(quantidade));
+    }
+    if (quantidade != binomial[NUM_PECAS][PECAS_POR_MAO] ||
+        livro->arquivo.tamanho < CABECALHO_LIVRO + quantidade * sizeof(EntradaLivro))
+    {
+        desmapearArquivo(&livro->arquivo);
+        memset(livro, 0, sizeof(*livro));
+        return 0;
+    }
+    livro->entradas = (const EntradaLivro *)(d + CABECALHO_LIVRO);
+    livro->quantidade = quantidade;
+    return 1;
+}
+
+void fecharLivroAbertura(LivroAbertura *livro)
+{
+    desmapearArquivo(&livro->arquivo);
+    memset(livro, 0, sizeof(*livro));
+}
+
+// ===== Políticas (jogadores automáticos) para o simulador sem janela =====
+// Uma política só pode olhar a própria mão (e->mao[e->vez]), a mesa, as pontas,
+// as quantidades de peças e a sua crença sobre o adversário; o resto do estado
+// é usado apenas pelo simulador
+typedef Lance (*FuncaoPolitica)(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente);
+
+typedef struct
+{
+    const char *nome;
+    FuncaoPolitica escolher;
+    void *config;
+} Politica;
+
+// Mesma regra do fallback local: primeira peça que encaixa, esquerda se der
+Lance politicaPrimeira(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    Lance lances[MAX_LANCES];
+    gerarLances(e, lances);
+    return lances[0];
+}
+
+// Gulosa: descarta a peça de maior valor possível
+Lance politicaGulosa(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances), melhor = 0;
+    for (int i = 1; i < n; i++)
+        if (pontosPeca[lances[i].peca] > pontosPeca[lances[melhor].peca])
+            melhor = i;
+    return lances[melhor];
+}
+
+// Cada thread tem seu próprio buscador (a tabela de transposição não é compartilhada)
+static __thread Buscador *buscadorThread = NULL;
+static __thread RelatorioBusca totalBuscaThread;
+// Placar da disputa que a thread está simulando (NULL = rodada avulsa)
+static __thread const ContextoDisputa *disputaThread = NULL;
+
+static Lance buscarComObjetivo(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente,
+                               const ContextoDisputa *disputa)
+{
+    if (!buscadorThread)
+        buscadorThread = criarBuscador();
+    if (!buscadorThread)
+        return politicaPrimeira(e, crenca, NULL, semente);
+
+    definirDisputaBuscador(buscadorThread, disputa);
+    RelatorioBusca rel;
+    Lance l = buscarLance(buscadorThread, e, crenca, (const ConfigBusca *)config, semente, &rel);
+    totalBuscaThread.nos += rel.nos;
+    totalBuscaThread.segundos += rel.segundos;
+    return l;
+}
+
+// A busca comum maximiza a rodada; a de disputa, a equidade no placar atual
+Lance politicaBusca(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    return buscarComObjetivo(e, crenca, config, semente, NULL);
+}
+
+Lance politicaBuscaDisputa(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    return buscarComObjetivo(e, crenca, config, semente, disputaThread);
+}
+
+ConfigBusca configBuscaSimulador = {40, 0.05, 8, 1};
+
+Lance politicaMcts(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    return buscarLanceMcts(e, crenca, (const ConfigMcts *)config, semente, NULL);
+}
+
+ConfigMcts configMctsSimulador = {1, MCTS_RAIZ, 0.05, 0, 0.7, 3, 1, 1 << 18};
+ConfigMcts configMctsRaizSimulador = {0, MCTS_RAIZ, 0.05, 0, 0.7, 3, 1, 1 << 20};
+ConfigMcts configMctsArvoreSimulador = {0, MCTS_ARVORE, 0.05, 0, 0.7, 3, 1, 1 << 20};
+// Orçamento fixo de playouts numa thread: a força não depende da carga da
+// máquina, então servem para comparar em torneios com todas as threads ocupadas
+ConfigMcts configMcts1k = {1, MCTS_RAIZ, 10.0, 1000, 0.7, 3, 1, 1 << 16};
+ConfigMcts configMcts10k = {1, MCTS_RAIZ, 10.0, 10000, 0.7, 3, 1, 1 << 18};
+
+// Heurística linear: cada lance recebe a soma ponderada de características
+// da posição que ele deixa. Os pesos são ajustados por --tunar e lidos de
+// pesos.cfg (ou do arquivo em DOMINO_PESOS) ao iniciar.
+#define NUM_CARACTERISTICAS 6
+
+typedef struct
+{
+    double peso[NUM_CARACTERISTICAS];
+} PesosHeuristica;
+
+const char *nomesCaracteristicas[NUM_CARACTERISTICAS] = {
+    "pontos_descartados", // pontos da peça jogada
+    "diversidade",        // números diferentes que sobram na mão
+    "duplas",             // duplas que sobram na mão
+    "controle_pontas",    // peças da mão que encaixam nas novas pontas
+    "pontas_bloqueadas",  // novas pontas com números que o adversário não tem
+    "chance_seguir",      // probabilidade exata de o adversário ter peça para as novas pontas
+};
+
+PesosHeuristica pesosHeuristica = {{1.0, 2.0, -3.0, 4.0, 3.0, -4.0}};
+
+static void caracteristicasLance(const EstadoMotor *e, const Crenca *crenca, Lance l, double *x)
+{
+    EstadoMotor filho = *e;
+    aplicarLance(&filho, l);
+    MascaraPecas mao = filho.mao[e->vez];
+    MascaraPontos numeros = 0;
+    int duplas = 0;
+    for (MascaraPecas m = mao; m; m &= m - 1)
+    {
+        Peca p = pecaMotor[primeiraPeca(m)];
+        numeros |= (MascaraPontos)((1 << p.lado1) | (1 << p.lado2));
+        duplas += p.lado1 == p.lado2;
+    }
+    MascaraPontos pontas = (MascaraPontos)((1 << filho.pontas[0]) | (1 << filho.pontas[1]));
+
+    x[0] = pontosPeca[l.peca];
+    x[1] = __builtin_popcount(numeros);
+    x[2] = duplas;
+    x[3] = contarPecas(mao & (pecasComPonto[filho.pontas[0]] | pecasComPonto[filho.pontas[1]]));
+    x[4] = crenca ? __builtin_popcount(pontas & vaziosCertosCrenca(crenca)) : 0;
+
+    // Sem crença (playouts), só o tamanho da mão do adversário é conhecido
+    Crenca semRestricao;
+    if (!crenca)
+    {
+        iniciarCrenca(&semRestricao, contarPecas(filho.mao[e->vez ^ 1]));
+        crenca = &semRestricao;
+    }
+    x[5] = probabilidadeSeguirCrenca(crenca, filho.mao[e->vez ^ 1] | filho.monte, pontas);
+}
+
+Lance politicaHeuristica(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    const PesosHeuristica *pesos = (const PesosHeuristica *)config;
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances), melhor = 0;
+    if (lances[0].peca < 0)
+        return lances[0];
+
+    double melhorValor = -1e300;
+    for (int i = 0; i < n; i++)
+    {
+        double x[NUM_CARACTERISTICAS], valor = 0;
+        caracteristicasLance(e, crenca, lances[i], x);
+        for (int k = 0; k < NUM_CARACTERISTICAS; k++)
+            valor += pesos->peso[k] * x[k];
+        if (valor > melhorValor)
+        {
+            melhorValor = valor;
+            melhor = i;
+        }
+    }
+    return lances[melhor];
+}
+
+// Arquivo de pesos: uma linha "nome valor" por característica; '#' comenta
+int carregarPesos(const char *caminho, PesosHeuristica *pesos)
+{
+    FILE *arquivo = fopen(caminho, "r");
+    if (!arquivo)
+        return 0;
+    char linha[128], nome[64];
+    double valor;
+    int lidos = 0;
+    while (fgets(linha, sizeof(linha), arquivo))
+    {
+        if (linha[0] == '#' || sscanf(linha, "%63s %lf", nome, &valor) != 2)
+            continue;
+        for (int k = 0; k < NUM_CARACTERISTICAS; k++)
+            if (strcmp(nome, nomesCaracteristicas[k]) == 0)
+            {
+                pesos->peso[k] = valor;
+                lidos++;
+            }
+    }
+    fclose(arquivo);
+    return lidos > 0;
+}
+
+int salvarPesos(const char *caminho, const PesosHeuristica *pesos, const char *comentario)
+{
+    FILE *arquivo = fopen(caminho, "w");
+    if (!arquivo)
+        return 0;
+    fprintf(arquivo, "# Pesos do jogador heuristico - %s\n", comentario);
+    for (int k = 0; k < NUM_CARACTERISTICAS; k++)
+        fprintf(arquivo, "%s %.6f\n", nomesCaracteristicas[k], pesos->peso[k]);
+    return fclose(arquivo) == 0;
+}
+
+// Política destilada: modelo linear sobre características com hashing
+// (feature hashing), treinado para imitar um motor forte (--destilar).
+// Cada lance vira uma coluna de DIM_DESTILADA números; os lances legais são
+// pontuados juntos com vetores SIMD (4 lances por instrução) e o de maior
+// pontuação é jogado. Decide em microssegundos, sem rede.
+#define DIM_DESTILADA 256
+#define MAX_LANCES_DESTILADA ((MAX_LANCES + 3) & ~3) // todos os lances legais, em blocos de 4
+#define MAX_CARAC_DESTILADA 16
+#define MAGICA_DESTILADA "DST1"
+
+typedef float Vetor4 __attribute__((vector_size(16)));
+
+typedef struct
+{
+    uint16_t indice;
+    float valor;
+} CaracteristicaHash;
+
+typedef struct
+{
+    float pesos[DIM_DESTILADA];
+    int carregado;
+} ModeloDestilado;
+
+ModeloDestilado modeloDestilado;
+
+// Cada característica (tipo, a, b) cai numa posição do vetor pelo hash, com
+// sinal também sorteado pelo hash para que colisões se cancelem em média
+static inline void caracteristicaHash(CaracteristicaHash *x, int *n, int tipo, int a, int b, float valor)
+{
+    uint64_t h = misturar64((uint64_t)tipo << 32 | (uint64_t)(a & 0xFFFF) << 16 | (uint64_t)(b & 0xFFFF));
+    x[*n].indice = (uint16_t)(h % DIM_DESTILADA);
+    x[*n].valor = (h >> 63) ? -valor : valor;
+    (*n)++;
+}
+
+// Características de um lance, só com o que o jogador da vez vê
+int caracteristicasDestiladas(const EstadoMotor *e, const Crenca *crenca, Lance l, CaracteristicaHash *x)
+{
+    int n = 0, eu = e->vez;
+    Peca p = pecaMotor[l.peca];
+    EstadoMotor filho = *e;
+    aplicarLance(&filho, l);
+    MascaraPecas mao = filho.mao[eu];
+    int novo = filho.pontas[l.lado], oposto = filho.pontas[l.lado ^ 1];
+    MascaraPecas vistas = mao | filho.mesa;
+    MascaraPontos vazios = crenca ? vaziosCertosCrenca(crenca) : 0;
+
+    caracteristicaHash(x, &n, 1, l.peca, 0, 1.0f);
+    caracteristicaHash(x, &n, 2, 0, 0, pontosPeca[l.peca] / 12.0f);
+    caracteristicaHash(x, &n, 3, p.lado1 == p.lado2, e->pontas[0] < 0, 1.0f);
+    caracteristicaHash(x, &n, 4, novo, contarPecas(mao & pecasComPonto[novo]), 1.0f);
+    caracteristicaHash(x, &n, 5, novo < oposto ? novo : oposto, novo < oposto ? oposto : novo, 1.0f);
+    caracteristicaHash(x, &n, 6, contarPecas(mao & (pecasComPonto[novo] | pecasComPonto[oposto])), 0, 1.0f);
+    caracteristicaHash(x, &n, 7, novo, contarPecas(pecasComPonto[novo] & ~vistas), 1.0f);
+    caracteristicaHash(x, &n, 8, (vazios >> novo) & 1, (vazios >> oposto) & 1, 1.0f);
+    caracteristicaHash(x, &n, 9, contarPecas(e->mao[eu ^ 1]) > 3 ? 4 : contarPecas(e->mao[eu ^ 1]),
+                       contarPecas(mao) > 3 ? 4 : contarPecas(mao), 1.0f);
+    caracteristicaHash(x, &n, 10, e->monte ? 1 : 0, novo == oposto, 1.0f);
+    int duplas = 0;
+    for (MascaraPecas m = mao; m; m &= m - 1)
+        duplas += pecaMotor[primeiraPeca(m)].lado1 == pecaMotor[primeiraPeca(m)].lado2;
+    caracteristicaHash(x, &n, 11, duplas, 0, 1.0f);
+    caracteristicaHash(x, &n, 12, 0, 0, pontosMao(mao) / 40.0f);
+    return n;
+}
+
+// Pontua até MAX_LANCES_DESTILADA lances de uma vez: coluna m de 'x' = lance m
+static void pontuarLancesDestilados(const float *pesos, const Vetor4 x[DIM_DESTILADA][MAX_LANCES_DESTILADA / 4],
+                                    int n, float *pontos)
+{
+    Vetor4 soma[MAX_LANCES_DESTILADA / 4] = {{0}};
+    int blocos = (n + 3) / 4;
+    for (int d = 0; d < DIM_DESTILADA; d++)
+    {
+        Vetor4 w = {pesos[d], pesos[d], pesos[d], pesos[d]};
+        for (int b = 0; b < blocos; b++)
+            soma[b] += w * x[d][b];
+    }
+    memcpy(pontos, soma, n * sizeof(float));
+}
+
+Lance politicaDestilada(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    const ModeloDestilado *modelo = (const ModeloDestilado *)config;
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances);
+    if (n == 1 || lances[0].peca < 0 || !modelo->carregado)
+        return lances[0];
+
+    // Só os blocos dos n lances são zerados e somados
+    Vetor4 x[DIM_DESTILADA][MAX_LANCES_DESTILADA / 4];
+    for (int d = 0; d < DIM_DESTILADA; d++)
+        memset(x[d], 0, (n + 3) / 4 * sizeof(Vetor4));
+    for (int m = 0; m < n; m++)
+    {
+        CaracteristicaHash c[MAX_CARAC_DESTILADA];
+        int k = caracteristicasDestiladas(e, crenca, lances[m], c);
+        for (int i = 0; i < k; i++)
+            x[c[i].indice][m / 4][m % 4] += c[i].valor;
+    }
+    float pontos[MAX_LANCES_DESTILADA];
+    pontuarLancesDestilados(modelo->pesos, x, n, pontos);
+    int melhor = 0;
+    for (int m = 1; m < n; m++)
+        if (pontos[m] > pontos[melhor])
+            melhor = m;
+    return lances[melhor];
+}
+
+int carregarModeloDestilado(const char *caminho, ModeloDestilado *modelo)
+{
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo)
+        return 0;
+    char magica[4];
+    uint32_t dimensao = 0;
+    int ok = fread(magica, 1, 4, arquivo) == 4 && memcmp(magica, MAGICA_DESTILADA, 4) == 0 &&
+             fread(&dimensao, sizeof(dimensao), 1, arquivo) == 1 && dimensao == DIM_DESTILADA &&
+             fread(modelo->pesos, sizeof(float), DIM_DESTILADA, arquivo) == DIM_DESTILADA;
+    fclose(arquivo);
+    modelo->carregado = ok;
+    return ok;
+}
+
+int salvarModeloDestilado(const char *caminho, const ModeloDestilado *modelo)
+{
+    FILE *arquivo = fopen(caminho, "wb");
+    if (!arquivo)
+        return 0;
+    uint32_t dimensao = DIM_DESTILADA;
+    int ok = fwrite(MAGICA_DESTILADA, 1, 4, arquivo) == 4 && fwrite(&dimensao, sizeof(dimensao), 1, arquivo) == 1 &&
+             fwrite(modelo->pesos, sizeof(float), DIM_DESTILADA, arquivo) == DIM_DESTILADA;
+    return (fclose(arquivo) == 0) && ok;
+}
+
+Politica politicas[] = {
+    {"primeira", politicaPrimeira, NULL},
+    {"gulosa", politicaGulosa, NULL},
+    {"busca", politicaBusca, &configBuscaSimulador},
+    {"busca-disputa", politicaBuscaDisputa, &configBuscaSimulador},
+    {"mcts", politicaMcts, &configMctsSimulador},
+    {"mcts-raiz", politicaMcts, &configMctsRaizSimulador},
+    {"mcts-arvore", politicaMcts, &configMctsArvoreSimulador},
+    {"mcts-1k", politicaMcts, &configMcts1k},
+    {"mcts-10k", politicaMcts, &configMcts10k},
+    {"heuristica", politicaHeuristica, &pesosHeuristica},
+    {"destilada", politicaDestilada, &modeloDestilado},
+};
+#define NUM_POLITICAS ((int)(sizeof(politicas) / sizeof(politicas[0])))
+
+// A destilada sem modelo carregado jogaria sempre o primeiro lance legal, e
+// torneios e confrontos mostrariam um adversário que não existe: fica de fora
+Politica *acharPolitica(const char *nome)
+{
+    for (int i = 0; i < NUM_POLITICAS; i++)
+        if (strcmp(politicas[i].nome, nome) == 0)
+        {
+            if (politicas[i].escolher == politicaDestilada && !modeloDestilado.carregado)
+            {
+                printf("Politica destilada sem modelo (DOMINO_MODELO ou destilada.mod; gere com --destilar)\n");
+                return NULL;
+            }
+            return &politicas[i];
+        }
+    return NULL;
+}
+
+// Joga uma partida inteira sem janela a partir da semente, com 'primeiro' na saída
+// Cada jogador mantém sua crença sobre o outro a partir das compras e passes
+// Retorna como verificarVitoria(): 1 = jogador 0, 2 = jogador 1, 3 = empate
+// As políticas sorteiam numa sequência própria: o monte só consome 'sorteio', então
+// a k-ésima compra tira a mesma peça nas duas partidas de um par, jogue quem jogar
+int simularRodadaMotor(Politica *jogadores[2], int primeiro, uint64_t semente, EstadoMotor *final)
+{
+    EstadoMotor e;
+    uint64_t sorteio = semente, decisoes = misturar64(semente ^ SEMENTE_DECISOES);
+    distribuirMotor(&e, &sorteio);
+    if (primeiro)
+    {
+        e.vez = 1;
+        e.chave = calcularChaveMotor(&e);
+    }
+    Crenca crencas[2]; // crencas[j] = o que j sabe da mão do outro
+    iniciarCrenca(&crencas[0], PECAS_POR_MAO);
+    iniciarCrenca(&crencas[1], PECAS_POR_MAO);
+
+    int fim;
+    while ((fim = fimMotor(&e)) == 0)
+    {
+        int v = e.vez;
+        Lance l = jogadores[v]->escolher(&e, &crencas[v], jogadores[v]->config, &decisoes);
+        if (l.peca < 0)
+        {
+            crencaVazio(&crencas[v ^ 1], e.pontas[0], e.pontas[1]);
+            if (l.peca == LANCE_COMPRAR && e.monte)
+            {
+                crencaCompra(&crencas[v ^ 1]);
+                comprarPecaMotor(&e, sortearPeca(e.monte, &sorteio));
+                continue;
+            }
+            l.peca = LANCE_PASSAR;
+        }
+        else
+            crencaJogada(&crencas[v ^ 1], l.peca);
+        aplicarLance(&e, l);
+    }
+    if (final)
+        *final = e;
+    return fim;
+}
+
+int simularPartidaMotor(Politica *jogadores[2], uint64_t semente, EstadoMotor *final)
+{
+    return simularRodadaMotor(jogadores, 0, semente, final);
+}
+
+typedef struct
+{
+    Politica *a, *b;
+    uint64_t semente;
+    int primeiro, fim;
+    long long pontos;  // meios pontos de 'a': vitória 2, empate 1
+    uint8_t *porPar;   // se não for NULL, meios pontos de 'a' em cada par (0 a 4)
+} TrabalhoConfronto;
+
+static void *jogarParesConfronto(void *arg)
+{
+    TrabalhoConfronto *t = (TrabalhoConfronto *)arg;
+    for (int k = t->primeiro; k < t->fim; k++)
+    {
+        int doPar = 0;
+        for (int troca = 0; troca < 2; troca++)
+        {
+            Politica *jogadores[2] = {troca ? t->b : t->a, troca ? t->a : t->b};
+            int fim = simularPartidaMotor(jogadores, t->semente + k, NULL);
+            doPar += fim == 3 ? 1 : (((fim == 1) != troca) ? 2 : 0);
+        }
+        t->pontos += doPar;
+        if (t->porPar)
+            t->porPar[k] = (uint8_t)doPar;
+    }
+    return NULL;
+}
+
+// Meios pontos de 'a' contra 'b' em 'pares' pares de partidas (mesma
+// distribuição, lugares trocados), repartidos entre as threads. Com a mesma
+// semente, dois confrontos jogam exatamente as mesmas distribuições.
+// 'porPar' (opcional) recebe os meios pontos de 'a' em cada par.
+long long jogarConfrontoParalelo(Politica *a, Politica *b, int pares, uint64_t semente, int threads, uint8_t *porPar)
+{
+    if (threads > pares)
+        threads = pares > 0 ? pares : 1;
+    TrabalhoConfronto *trabalhos = calloc(threads, sizeof(TrabalhoConfronto));
+    if (!trabalhos)
+        return 0;
+    for (int t = 0; t < threads; t++)
+        trabalhos[t] = (TrabalhoConfronto){a, b, semente, pares * t / threads, pares * (t + 1) / threads, 0, porPar};
+    executarEmThreads(threads, jogarParesConfronto, trabalhos, sizeof(TrabalhoConfronto));
+    long long pontos = 0;
+    for (int t = 0; t < threads; t++)
+        pontos += trabalhos[t].pontos;
+    free(trabalhos);
+    return pontos;
+}
+
+// Tabela de equidade da disputa até 'alvo'. A distribuição do resultado de
+// uma rodada (quem vence, quantos pontos) do ponto de vista de quem sai vem
+// de 'rodadas' partidas de 'base' contra ela mesma; a equidade sai por
+// programação dinâmica sobre os pontos que faltam. Rodadas que não mudam o
+// placar (empate, ou vitória valendo zero) só passam a saída para o outro,
+// então os dois valores do mesmo placar se resolvem juntos:
+// E0 = R0 + q E1 e E1 = R1 + q E0, com q a chance do placar não mudar.
+int construirTabelaDisputa(TabelaDisputa *t, int alvo, Politica *base, int rodadas, uint64_t semente)
+{
+    if (alvo < 1 || alvo > MAX_ALVO_DISPUTA || rodadas < 1)
+        return 0;
+    float *equidade = malloc((size_t)(alvo + 1) * (alvo + 1) * 2 * sizeof(float));
+    if (!equidade)
+        return 0;
+    double saida[PONTOS_BARALHO + 1] = {0}, resposta[PONTOS_BARALHO + 1] = {0}, parado = 0;
+    Politica *jogadores[2] = {base, base};
+    for (int k = 0; k < rodadas; k++)
+    {
+        EstadoMotor final;
+        int fim = simularPartidaMotor(jogadores, semente + k, &final);
+        int pontos = fim == 3 ? 0 : pontosFinaisMotor(&final, 2 - fim);
+        if (pontos == 0)
+            parado += 1.0 / rodadas;
+        else if (fim == 1)
+            saida[pontos] += 1.0 / rodadas;
+        else
+            resposta[pontos] += 1.0 / rodadas;
+    }
+
+    free(t->equidade);
+    t->alvo = alvo;
+    t->equidade = equidade;
+    for (int a = 1; a <= alvo; a++)
+        for (int b = 1; b <= alvo; b++)
+        {
+            double r[2] = {0, 0};
+            for (int p = 1; p <= PONTOS_BARALHO; p++)
+            {
+                if (saida[p] == 0 && resposta[p] == 0)
+                    continue;
+                // r[s]: parte da equidade do jogador 0 que vem de rodadas que mudam o placar, com s na saída
+                r[0] += saida[p] * equidadeDisputa(t, a - p, b, 1) + resposta[p] * equidadeDisputa(t, a, b - p, 1);
+                r[1] += saida[p] * equidadeDisputa(t, a, b - p, 0) + resposta[p] * equidadeDisputa(t, a - p, b, 0);
+            }
+            size_t i = ((size_t)a * (alvo + 1) + b) * 2;
+            double det = 1.0 - parado * parado;
+            equidade[i] = det > 1e-12 ? (float)((r[0] + parado * r[1]) / det) : 0.5f;
+            equidade[i + 1] = det > 1e-12 ? (float)((r[1] + parado * r[0]) / det) : 0.5f;
+        }
+    return 1;
+}
+
+void liberarTabelaDisputa(TabelaDisputa *t)
+{
+    free(t->equidade);
+    t->equidade = NULL;
+    t->alvo = 0;
+}
+
+#define MAX_RODADAS_DISPUTA 1000
+
+typedef struct
+{
+    int vencedor; // 1 = jogador 0, 2 = jogador 1, 3 = parou em MAX_RODADAS_DISPUTA
+    int rodadas, empates, pontos[2];
+} ResultadoDisputa;
+
+// Joga uma disputa inteira sem janela. As rodadas usam sementes derivadas de
+// 'semente' e a saída alterna começando pelo jogador 0; as políticas de
+// disputa leem o placar de cada rodada em disputaThread
+ResultadoDisputa simularDisputaMotor(Politica *jogadores[2], const TabelaDisputa *tabela, uint64_t semente)
+{
+    ResultadoDisputa r = {0};
+    int alvo = tabela->alvo;
+    while (r.pontos[0] < alvo && r.pontos[1] < alvo && r.rodadas < MAX_RODADAS_DISPUTA)
+    {
+        int primeiro = r.rodadas & 1;
+        ContextoDisputa contexto = {tabela, {alvo - r.pontos[0], alvo - r.pontos[1]}, primeiro};
+        disputaThread = &contexto;
+        EstadoMotor final;
+        int fim = simularRodadaMotor(jogadores, primeiro, semente ^ ((uint64_t)r.rodadas * 0x9E3779B97F4A7C15ULL), &final);
+        if (fim == 3)
+            r.empates++;
+        else
+            r.pontos[fim - 1] += pontosFinaisMotor(&final, 2 - fim);
+        r.rodadas++;
+    }
+    disputaThread = NULL;
+    r.vencedor = r.pontos[0] >= alvo ? 1 : (r.pontos[1] >= alvo ? 2 : 3);
+    return r;
+}
+
+typedef struct
+{
+    Politica *a, *b;
+    const TabelaDisputa *tabela;
+    uint64_t semente;
+    int primeiro, fim;
+    long long meiosA, rodadas, empates, pontosA, pontosB; // meiosA: disputas de 'a' em meios pontos
+} TrabalhoDisputa;
+
+// Pares de disputas com as mesmas distribuições rodada a rodada e os lugares trocados
+static void *jogarParesDisputa(void *arg)
+{
+    TrabalhoDisputa *t = (TrabalhoDisputa *)arg;
+    for (int k = t->primeiro; k < t->fim; k++)
+        for (int troca = 0; troca < 2; troca++)
+        {
+            Politica *jogadores[2] = {troca ? t->b : t->a, troca ? t->a : t->b};
+            ResultadoDisputa r = simularDisputaMotor(jogadores, t->tabela, t->semente + (uint64_t)k * 7919);
+            t->meiosA += r.vencedor == 3 ? 1 : (((r.vencedor == 1) != troca) ? 2 : 0);
+            t->rodadas += r.rodadas;
+            t->empates += r.empates;
+            t->pontosA += r.pontos[troca];
+            t->pontosB += r.pontos[troca ^ 1];
+        }
+    return NULL;
+}
+
+int simularDisputa(Politica *a, Politica *b, int alvo, int pares, uint64_t semente, int threads)
+{
+    TabelaDisputa tabela = {0};
+    double inicio = agoraSegundos();
+    if (!construirTabelaDisputa(&tabela, alvo, acharPolitica("gulosa"), 20000, semente ^ 0xD15B07A))
+    {
+        printf("Alvo invalido (1 a %d)\n", MAX_ALVO_DISPUTA);
+        return 1;
+    }
+    double tempoTabela = agoraSegundos() - inicio;
+    if (threads > pares)
+        threads = pares > 0 ? pares : 1;
+    TrabalhoDisputa *trabalhos = calloc(threads, sizeof(TrabalhoDisputa));
+    if (!trabalhos)
+    {
+        liberarTabelaDisputa(&tabela);
+        return 1;
+    }
+    for (int t = 0; t < threads; t++)
+        trabalhos[t] = (TrabalhoDisputa){a, b, &tabela, semente, pares * t / threads, pares * (t + 1) / threads};
+
+    inicio = agoraSegundos();
+    executarEmThreads(threads, jogarParesDisputa, trabalhos, sizeof(TrabalhoDisputa));
+    double total = agoraSegundos() - inicio;
+
+    TrabalhoDisputa soma = {0};
+    for (int t = 0; t < threads; t++)
+    {
+        soma.meiosA += trabalhos[t].meiosA;
+        soma.rodadas += trabalhos[t].rodadas;
+        soma.empates += trabalhos[t].empates;
+        soma.pontosA += trabalhos[t].pontosA;
+        soma.pontosB += trabalhos[t].pontosB;
+    }
+    free(trabalhos);
+
+    int disputas = 2 * pares;
+    double placar = disputas > 0 ? soma.meiosA / (2.0 * disputas) : 0.5;
+    double erro = disputas > 0 ? 1.96 * sqrt(placar * (1 - placar) / disputas) : 0;
+    printf("\n=== Disputa ate %d: %s x %s ===\n", alvo, a->nome, b->nome);
+    printf("Tabela de equidade: %.2fs | saindo em 0 x 0, o jogador 0 tem %.1f%%\n", tempoTabela,
+           equidadeDisputa(&tabela, alvo, alvo, 0) * 100.0);
+    printf("Disputas: %d (%d pares) em %.2fs (%.0f rodadas/s, %d threads)\n", disputas, pares, total,
+           total > 0 ? soma.rodadas / total : 0.0, threads);
+    printf("%s: %.1f%% das disputas (+-%.1f%%)\n", a->nome, placar * 100.0, erro * 100.0);
+    printf("Rodadas por disputa: %.2f (empates: %lld) | pontos por rodada: %s %.1f, %s %.1f\n",
+           disputas > 0 ? (double)soma.rodadas / disputas : 0.0, soma.empates, a->nome,
+           soma.rodadas > 0 ? (double)soma.pontosA / soma.rodadas : 0.0, b->nome,
+           soma.rodadas > 0 ? (double)soma.pontosB / soma.rodadas : 0.0);
+    liberarTabelaDisputa(&tabela);
+    return 0;
+}
+
+// Ajuste dos pesos por SPSA: a cada iteração todos os pesos são perturbados
+// juntos (+c ou -c, sorteado por peso) e os dois candidatos jogam entre si nas
+// mesmas distribuições (números aleatórios comuns). O saldo do confronto
+// estima o gradiente em todas as direções de uma vez. De tempos em tempos o
+// candidato atual enfrenta os pesos iniciais e o melhor vai para o arquivo.
+int tunarPesos(const char *saida, int iteracoes, int pares, int threads, uint64_t semente)
+{
+    PesosHeuristica inicial = pesosHeuristica, theta = inicial, melhor = inicial;
+    Politica base = {"inicial", politicaHeuristica, &inicial};
+    double melhorPlacar = 0.5;
+    int validacao = iteracoes / 10 > 0 ? iteracoes / 10 : 1;
+    // Ganhos usuais do SPSA (Spall): a_k = a / (k + 1 + A)^0.602, c_k = c / (k + 1)^0.101
+    double A = iteracoes / 10.0, a = 4.0 * pow(A + 1, 0.602), c = 0.5;
+    uint64_t sorteio = semente;
+    double inicio = agoraSegundos();
+
+    printf("SPSA: %d iteracoes x %d pares, %d threads\n", iteracoes, pares, threads);
+    for (int k = 0; k < iteracoes; k++)
+    {
+        double ak = a / pow(k + 1 + A, 0.602), ck = c / pow(k + 1, 0.101);
+        PesosHeuristica mais = theta, menos = theta;
+        double delta[NUM_CARACTERISTICAS];
+        for (int i = 0; i < NUM_CARACTERISTICAS; i++)
+        {
+            delta[i] = (proximoAleatorio(&sorteio) & 1) ? 1.0 : -1.0;
+            mais.peso[i] += ck * delta[i];
+            menos.peso[i] -= ck * delta[i];
+        }
+        Politica pMais = {"mais", politicaHeuristica, &mais}, pMenos = {"menos", politicaHeuristica, &menos};
+        long long pontos = jogarConfrontoParalelo(&pMais, &pMenos, pares, proximoAleatorio(&sorteio), threads, NULL);
+        double saldo = pontos / (2.0 * pares) - 1.0; // -1 a 1
+        for (int i = 0; i < NUM_CARACTERISTICAS; i++)
+            theta.peso[i] += ak * saldo / (2.0 * ck * delta[i]);
+
+        if ((k + 1) % validacao == 0 || k + 1 == iteracoes)
+        {
+            Politica atual = {"atual", politicaHeuristica, &theta};
+            double placar = jogarConfrontoParalelo(&atual, &base, 4 * pares, semente ^ 0x5EED, threads, NULL) / (16.0 * pares);
+            printf("  iteracao %d: placar contra os pesos iniciais %.1f%% |", k + 1, placar * 100.0);
+            for (int i = 0; i < NUM_CARACTERISTICAS; i++)
+                printf(" %.2f", theta.peso[i]);
+            printf("\n");
+            if (placar > melhorPlacar)
+            {
+                melhorPlacar = placar;
+                melhor = theta;
+            }
+        }
+    }
+
+    double segundos = agoraSegundos() - inicio;
+    long long partidas = (long long)iteracoes * 2 * pares + (long long)(iteracoes / validacao + 1) * 8 * pares;
+    printf("Tempo: %.1fs (~%.0f partidas/s) | melhor placar contra os iniciais: %.1f%%\n", segundos,
+           segundos > 0 ? partidas / segundos : 0.0, melhorPlacar * 100.0);
+    char comentario[96];
+    snprintf(comentario, sizeof(comentario), "SPSA, %d iteracoes x %d pares, placar %.1f%%", iteracoes, pares,
+             melhorPlacar * 100.0);
+    return salvarPesos(saida, &melhor, comentario);
+}
+
+// ===== Mesa com N lugares e duplas =====
+// Variante do motor para 2 ou 4 lugares. Com 4, os lugares 0 e 2 formam a
+// dupla 0 e os lugares 1 e 3 a dupla 1, e a vez gira 0, 1, 2, 3. As mãos de
+// todos os lugares ficam num vetor contíguo de máscaras dentro do estado, sem
+// ponteiros: copiar o estado para a busca é copiar 40 bytes no duplo-6 (64 no
+// duplo-9, 112 no duplo-12), uma ou duas linhas de cache.
+// Regras das duplas:
+//  - a dupla de quem bater (ficar sem peças) vence a rodada
+//  - sem peça que encaixe, compra do monte enquanto houver; sem monte, passa
+//  - a rodada fecha quando todos passam em seguida ou as pontas travam, e vence
+//    a dupla com menos pontos somando as mãos dos dois parceiros
+//  - a dupla vencedora marca os pontos que ficaram nas mãos da outra
+#define MAX_LUGARES 4
+#if MAX_PONTO <= 6
+#define PECAS_POR_MAO_DUPLAS (NUM_PECAS / 4) // duplo-6: 7 peças, sem monte
+#elif MAX_PONTO <= 9
+#define PECAS_POR_MAO_DUPLAS 10
+#else
+#define PECAS_POR_MAO_DUPLAS 12
+#endif
+
+typedef struct
+{
+    MascaraPecas mao[MAX_LUGARES]; // mãos de todos os lugares, contíguas
+    MascaraPecas monte, mesa;
+    MascaraPontos vazios[MAX_LUGARES]; // números em que cada lugar já passou (público)
+    int8_t pontas[2];
+    uint8_t lugares, vez, passadas; // passadas seguidas: todos passaram = fechou
+} EstadoMesa;
+
+_Static_assert(sizeof(EstadoMesa) <= 128, "EstadoMesa deve caber em duas linhas de cache");
+
+static inline int duplaDoLugar(int lugar)
+{
+    return lugar & 1;
+}
+
+// Reparte 'pecasPorMao' peças para cada lugar; o resto vai para o monte
+void distribuirMesa(EstadoMesa *e, int lugares, int pecasPorMao, int primeiro, uint64_t *semente)
+{
+    int baralho[NUM_PECAS];
+    for (int i = 0; i < NUM_PECAS; i++)
+        baralho[i] = i;
+    for (int i = NUM_PECAS - 1; i > 0; i--)
+    {
+        int j = aleatorioAte(semente, i + 1);
+        int temp = baralho[i];
+        baralho[i] = baralho[j];
+        baralho[j] = temp;
+    }
+
+    memset(e, 0, sizeof(*e));
+    e->pontas[0] = e->pontas[1] = -1;
+    e->lugares = (uint8_t)lugares;
+    e->vez = (uint8_t)primeiro;
+    e->monte = TODAS_PECAS;
+    for (int s = 0; s < lugares; s++)
+        for (int i = 0; i < pecasPorMao; i++)
+            e->mao[s] |= BIT_PECA(baralho[s * pecasPorMao + i]);
+    for (int s = 0; s < lugares; s++)
+        e->monte &= ~e->mao[s];
+}
+
+int gerarLancesMesa(const EstadoMesa *e, Lance *lances)
+{
+    return lancesDaMao(e->mao[e->vez], e->pontas, e->monte != 0, lances);
+}
+
+// Jogada ou passe; a vez segue para o próximo lugar. Quem passa mostra que
+// não tem os números das pontas, e como só se passa sem monte, isso não muda mais
+void aplicarLanceMesa(EstadoMesa *e, Lance l)
+{
+    int v = e->vez;
+    if (l.peca == LANCE_PASSAR)
+    {
+        if (e->pontas[0] >= 0)
+            e->vazios[v] |= (MascaraPontos)((1u << e->pontas[0]) | (1u << e->pontas[1]));
+        if (e->passadas < e->lugares)
+            e->passadas++;
+    }
+    else
+    {
+        int a = pecaMotor[l.peca].lado1, b = pecaMotor[l.peca].lado2;
+        e->mao[v] &= ~BIT_PECA(l.peca);
+        e->mesa |= BIT_PECA(l.peca);
+        if (e->pontas[0] < 0)
+        {
+            e->pontas[0] = a;
+            e->pontas[1] = b;
+        }
+        else
+            e->pontas[l.lado] = (a == e->pontas[l.lado]) ? b : a;
+        e->passadas = 0;
+    }
+    e->vez = (uint8_t)((v + 1) % e->lugares);
+}
+
+// Compra uma peça específica do monte - a vez continua com o mesmo lugar
+void comprarPecaMesa(EstadoMesa *e, int peca)
+{
+    e->monte &= ~BIT_PECA(peca);
+    e->mao[e->vez] |= BIT_PECA(peca);
+}
+
+// Pontos da dupla na contagem final (as duas mãos somadas); no jogo travado
+// quem está na vez ficaria com o monte, como no motor de dois lugares
+int pontosDuplaMesa(const EstadoMesa *e, int dupla)
+{
+    int pontos = 0;
+    for (int s = dupla; s < e->lugares; s += 2)
+        pontos += pontosMao(e->mao[s]);
+    if (duplaDoLugar(e->vez) == dupla && e->monte && travadoPontas(e->mesa, e->pontas))
+        pontos += pontosMao(e->monte);
+    return pontos;
+}
+
+// 1 = dupla 0 venceu, 2 = dupla 1 venceu, 3 = empate, 0 = rodada continua
+int fimMesa(const EstadoMesa *e)
+{
+    for (int s = 0; s < e->lugares; s++)
+        if (!e->mao[s])
+            return duplaDoLugar(s) + 1;
+    if (e->passadas >= e->lugares || travadoPontas(e->mesa, e->pontas))
+    {
+        int pts0 = pontosDuplaMesa(e, 0), pts1 = pontosDuplaMesa(e, 1);
+        return pts0 < pts1 ? 1 : (pts1 < pts0 ? 2 : 3);
+    }
+    return 0;
+}
+
+// Valor final para a dupla: vitória vale VALOR_VITORIA mais os pontos marcados
+int valorMesa(const EstadoMesa *e, int dupla)
+{
+    int fim = fimMesa(e);
+    if (fim == 3)
+        return 0;
+    int pontos = fim == 1 ? pontosDuplaMesa(e, 1) : pontosDuplaMesa(e, 0);
+    return fim == dupla + 1 ? VALOR_VITORIA + pontos : -VALOR_VITORIA - pontos;
+}
+
+// Políticas da mesa: como as de dois lugares, só olham a própria mão
+// (e->mao[e->vez]) e a parte pública do estado
+typedef Lance (*FuncaoPoliticaMesa)(const EstadoMesa *e, void *config, uint64_t *semente);
+
+typedef struct
+{
+    const char *nome;
+    FuncaoPoliticaMesa escolher;
+    void *config;
+} PoliticaMesa;
+
+Lance politicaMesaPrimeira(const EstadoMesa *e, void *config, uint64_t *semente)
+{
+    Lance lances[MAX_LANCES];
+    gerarLancesMesa(e, lances);
+    return lances[0];
+}
+
+Lance politicaMesaGulosa(const EstadoMesa *e, void *config, uint64_t *semente)
+{
+    Lance lances[MAX_LANCES];
+    int n = gerarLancesMesa(e, lances), melhor = 0;
+    for (int i = 1; i < n; i++)
+        if (pontosPeca[lances[i].peca] > pontosPeca[lances[melhor].peca])
+            melhor = i;
+    return lances[melhor];
+}
+
+// Jogo de dupla: descarrega pontos e duplas, deixa nas pontas números em que
+// o próximo adversário já passou, evita os números em que o parceiro passou e
+// guarda o controle (peças da própria mão que seguem nas novas pontas)
+Lance politicaMesaDupla(const EstadoMesa *e, void *config, uint64_t *semente)
+{
+    Lance lances[MAX_LANCES];
+    int n = gerarLancesMesa(e, lances);
+    if (n == 1 || lances[0].peca < 0)
+        return lances[0];
+
+    int v = e->vez, proximo = (v + 1) % e->lugares, parceiro = e->lugares == 4 ? (v + 2) % 4 : -1;
+    int melhor = 0, melhorNota = -VALOR_INFINITO;
+    for (int i = 0; i < n; i++)
+    {
+        int p = lances[i].peca, a = pecaMotor[p].lado1, b = pecaMotor[p].lado2;
+        int8_t pontas[2] = {e->pontas[0], e->pontas[1]};
+        if (pontas[0] < 0)
+            pontas[0] = a, pontas[1] = b;
+        else
+            pontas[lances[i].lado] = (a == pontas[lances[i].lado]) ? b : a;
+        MascaraPontos novas = (MascaraPontos)((1u << pontas[0]) | (1u << pontas[1]));
+        MascaraPecas resto = e->mao[v] & ~BIT_PECA(p);
+
+        int nota = pontosPeca[p] + (a == b ? 6 : 0);
+        nota += 2 * contarPecas(resto & (pecasComPonto[pontas[0]] | pecasComPonto[pontas[1]]));
+        if ((e->vazios[proximo] & novas) == novas)
+            nota += 12;
+        if (parceiro >= 0 && (e->vazios[parceiro] & novas) == novas)
+            nota -= 8;
+        if (nota > melhorNota)
+            melhorNota = nota, melhor = i;
+    }
+    return lances[melhor];
+}
+
+// Sorteia as mãos ocultas para os outros lugares (tamanhos conhecidos),
+// respeitando os números em que cada um já passou; o que sobra vai ao monte.
+// Os lugares mais restritos escolhem primeiro; se não couber, tenta de novo
+// e, no limite, ignora as restrições
+static void amostrarMundoMesa(const EstadoMesa *e, EstadoMesa *mundo, uint64_t *semente)
+{
+    int v = e->vez;
+    MascaraPecas ocultas = TODAS_PECAS & ~e->mesa & ~e->mao[v];
+    int ordem[MAX_LUGARES], k = 0;
+    for (int s = 0; s < e->lugares; s++)
+        if (s != v)
+            ordem[k++] = s;
+    for (int i = 1; i < k; i++)
+        for (int j = i; j > 0 && __builtin_popcount(e->vazios[ordem[j]]) > __builtin_popcount(e->vazios[ordem[j - 1]]); j--)
+        {
+            int t = ordem[j];
+            ordem[j] = ordem[j - 1];
+            ordem[j - 1] = t;
+        }
+
+    for (int tentativa = 0; tentativa < 16; tentativa++)
+    {
+        *mundo = *e;
+        MascaraPecas livres = ocultas;
+        int ok = 1;
+        for (int i = 0; i < k && ok; i++)
+        {
+            int s = ordem[i], quantos = contarPecas(e->mao[s]);
+            MascaraPecas proibidas = 0;
+            if (tentativa < 15)
+                for (int p = 0; p < NUM_PONTOS; p++)
+                    if (e->vazios[s] & (1u << p))
+                        proibidas |= pecasComPonto[p];
+            mundo->mao[s] = 0;
+            for (int j = 0; j < quantos; j++)
+            {
+                MascaraPecas opcoes = livres & ~proibidas;
+                if (!opcoes)
+                {
+                    ok = 0;
+                    break;
+                }
+                int p = sortearPeca(opcoes, semente);
+                mundo->mao[s] |= BIT_PECA(p);
+                livres &= ~BIT_PECA(p);
+            }
+        }
+        if (ok)
+        {
+            mundo->monte = livres;
+            return;
+        }
+    }
+}
+
+// Joga a rodada até o fim com a política dada em todos os lugares
+static void jogarAteOFimMesa(EstadoMesa *e, FuncaoPoliticaMesa escolher, uint64_t *semente)
+{
+    while (!fimMesa(e))
+    {
+        Lance l = escolher(e, NULL, semente);
+        if (l.peca == LANCE_COMPRAR)
+            comprarPecaMesa(e, sortearPeca(e->monte, semente));
+        else
+            aplicarLanceMesa(e, l);
+    }
+}
+
+// Monte Carlo plano: cada lance é avaliado nos mesmos mundos sorteados
+// (números aleatórios comuns), com o jogo de dupla em todos os lugares
+typedef struct
+{
+    int mundos;
+} ConfigAmostragemMesa;
+
+ConfigAmostragemMesa configAmostragemMesa = {24};
+
+Lance politicaMesaAmostragem(const EstadoMesa *e, void *config, uint64_t *semente)
+{
+    const ConfigAmostragemMesa *cfg = (const ConfigAmostragemMesa *)config;
+    Lance lances[MAX_LANCES];
+    int n = gerarLancesMesa(e, lances);
+    if (n == 1 || lances[0].peca < 0)
+        return lances[0];
+
+    long long soma[MAX_LANCES] = {0};
+    int dupla = duplaDoLugar(e->vez);
+    for (int w = 0; w < cfg->mundos; w++)
+    {
+        EstadoMesa mundo;
+        amostrarMundoMesa(e, &mundo, semente);
+        uint64_t sementeMundo = proximoAleatorio(semente);
+        for (int i = 0; i < n; i++)
+        {
+            EstadoMesa filho = mundo;
+            uint64_t s = sementeMundo;
+            aplicarLanceMesa(&filho, lances[i]);
+            jogarAteOFimMesa(&filho, politicaMesaDupla, &s);
+            soma[i] += valorMesa(&filho, dupla);
+        }
+    }
+    int melhor = 0;
+    for (int i = 1; i < n; i++)
+        if (soma[i] > soma[melhor])
+            melhor = i;
+    return lances[melhor];
+}
+
+PoliticaMesa politicasMesa[] = {
+    {"primeira", politicaMesaPrimeira, NULL},
+    {"gulosa", politicaMesaGulosa, NULL},
+    {"dupla", politicaMesaDupla, NULL},
+    {"amostragem", politicaMesaAmostragem, &configAmostragemMesa},
+};
+#define NUM_POLITICAS_MESA ((int)(sizeof(politicasMesa) / sizeof(politicasMesa[0])))
+
+PoliticaMesa *acharPoliticaMesa(const char *nome)
+{
+    for (int i = 0; i < NUM_POLITICAS_MESA; i++)
+        if (strcmp(politicasMesa[i].nome, nome) == 0)
+            return &politicasMesa[i];
+    return NULL;
+}
+
+// Joga uma rodada sem janela; jogadores[s] joga no lugar s.
+// Retorna como fimMesa() e, se 'pontos' não for NULL, os pontos marcados.
+// Como em simularRodadaMotor(), as compras não dependem do que as políticas sortearam
+int simularRodadaMesa(PoliticaMesa *jogadores[MAX_LUGARES], int lugares, int pecasPorMao, uint64_t semente,
+                      int *pontos)
+{
+    EstadoMesa e;
+    uint64_t sorteio = semente, decisoes = misturar64(semente ^ SEMENTE_DECISOES);
+    distribuirMesa(&e, lugares, pecasPorMao, 0, &sorteio);
+    int fim;
+    while ((fim = fimMesa(&e)) == 0)
+    {
+        int v = e.vez;
+        Lance l = jogadores[v]->escolher(&e, jogadores[v]->config, &decisoes);
+        if (l.peca == LANCE_COMPRAR && e.monte)
+        {
+            comprarPecaMesa(&e, sortearPeca(e.monte, &sorteio));
+            continue;
+        }
+        if (l.peca < 0)
+            l.peca = LANCE_PASSAR;
+        aplicarLanceMesa(&e, l);
+    }
+    if (pontos)
+        *pontos = fim == 3 ? 0 : pontosDuplaMesa(&e, fim == 1 ? 1 : 0);
+    return fim;
+}
+
+typedef struct
+{
+    PoliticaMesa *a, *b;
+    int lugares, pecasPorMao;
+    uint64_t semente;
+    int primeiro, fim;
+    long long vitoriasA, vitoriasB, empates, pontosA, pontosB;
+} TrabalhoDuplas;
+
+// Pares de rodadas com a mesma distribuição: na segunda, as duplas trocam de lugares
+static void *jogarParesDuplas(void *arg)
+{
+    TrabalhoDuplas *t = (TrabalhoDuplas *)arg;
+    for (int k = t->primeiro; k < t->fim; k++)
+        for (int troca = 0; troca < 2; troca++)
+        {
+            PoliticaMesa *jogadores[MAX_LUGARES];
+            for (int s = 0; s < t->lugares; s++)
+                jogadores[s] = (duplaDoLugar(s) == troca) ? t->a : t->b;
+            int pontos, fim = simularRodadaMesa(jogadores, t->lugares, t->pecasPorMao, t->semente + k, &pontos);
+            if (fim == 3)
+                t->empates++;
+            else if ((fim == 1) != troca)
+                t->vitoriasA++, t->pontosA += pontos;
+            else
+                t->vitoriasB++, t->pontosB += pontos;
+        }
+    return NULL;
+}
+
+int simularDuplas(PoliticaMesa *a, PoliticaMesa *b, int lugares, int pares, uint64_t semente, int threads)
+{
+    int pecasPorMao = lugares == 4 ? PECAS_POR_MAO_DUPLAS : PECAS_POR_MAO;
+    if (threads > pares)
+        threads = pares > 0 ? pares : 1;
+    TrabalhoDuplas *trabalhos = calloc(threads, sizeof(TrabalhoDuplas));
+    if (!trabalhos)
+        return 1;
+    for (int t = 0; t < threads; t++)
+        trabalhos[t] = (TrabalhoDuplas){a, b, lugares, pecasPorMao, semente, pares * t / threads, pares * (t + 1) / threads};
+
+    double inicio = agoraSegundos();
+    executarEmThreads(threads, jogarParesDuplas, trabalhos, sizeof(TrabalhoDuplas));
+    double total = agoraSegundos() - inicio;
+
+    TrabalhoDuplas soma = {0};
+    for (int t = 0; t < threads; t++)
+    {
+        soma.vitoriasA += trabalhos[t].vitoriasA;
+        soma.vitoriasB += trabalhos[t].vitoriasB;
+        soma.empates += trabalhos[t].empates;
+        soma.pontosA += trabalhos[t].pontosA;
+        soma.pontosB += trabalhos[t].pontosB;
+    }
+    free(trabalhos);
+
+    printf("\n=== %s x %s (%d lugares, %d pecas por mao, estado de %d bytes) ===\n", a->nome, b->nome, lugares,
+           pecasPorMao, (int)sizeof(EstadoMesa));
+    printf("Rodadas: %d (%d pares) em %.2fs (%.0f rodadas/s, %d threads)\n", 2 * pares, pares, total,
+           total > 0 ? 2 * pares / total : 0.0, threads);
+    printf("%s: %lld vitorias, %lld pontos | %s: %lld vitorias, %lld pontos | empates: %lld\n", a->nome,
+           soma.vitoriasA, soma.pontosA, b->nome, soma.vitoriasB, soma.pontosB, soma.empates);
+    return 0;
+}
+
+// ===== SPRT entre duas políticas =====
+// Teste sequencial da razão de verossimilhança (aproximação normal do GSPRT):
+// H0 = diferença de Elo elo0, H1 = elo1. Depois de cada par (mesma distribuição,
+// lugares trocados) o LLR é atualizado; o teste para quando cruza um dos limites.
+// Os pares são jogados em lotes pelas threads, mas entram no teste em ordem,
+// como se fossem jogados um a um.
+// A variância tem um piso: com políticas idênticas (ou todo par empatado) ela
+// é zero, e sem o piso o LLR nunca sairia do lugar até o --max.
+#define VARIANCIA_MINIMA_SPRT 1e-3
+
+typedef struct
+{
+    double elo0, elo1;  // hipóteses (Elo de A sobre B)
+    double alfa, beta;  // erros tipo I e II
+    int maxPares;       // teste inconclusivo depois disso
+} ConfigSprt;
+
+static double placarDoElo(double elo)
+{
+    return 1.0 / (1.0 + pow(10.0, -elo / 400.0));
+}
+
+static double eloDoPlacar(double placar)
+{
+    if (placar <= 0.0)
+        placar = 1e-6;
+    if (placar >= 1.0)
+        placar = 1.0 - 1e-6;
+    return placar == 0.5 ? 0.0 : -400.0 * log10(1.0 / placar - 1.0); // sem "-0.0"
+}
+
+int executarSprt(Politica *a, Politica *b, const ConfigSprt *cfg, int threads, uint64_t semente)
+{
+    double limiteInferior = log(cfg->beta / (1.0 - cfg->alfa));
+    double limiteSuperior = log((1.0 - cfg->beta) / cfg->alfa);
+    double s0 = placarDoElo(cfg->elo0), s1 = placarDoElo(cfg->elo1);
+    int lote = 8 * threads;
+    uint8_t *porPar = malloc(lote);
+    if (!porPar)
+        return 1;
+
+    // Pentanomial: quantos pares terminaram com 0, 1, 2, 3 ou 4 meios pontos para A
+    long long penta[5] = {0};
+    int pares = 0, decisao = 0;
+    double soma = 0, somaQuadrados = 0, llr = 0, inicio = agoraSegundos(), ultimoRelatorio = inicio;
+
+    printf("\n=== SPRT %s x %s ===\n", a->nome, b->nome);
+    printf("H0: elo %.1f | H1: elo %.1f | alfa %.3f beta %.3f | limites LLR [%.2f, %.2f]\n", cfg->elo0, cfg->elo1,
+           cfg->alfa, cfg->beta, limiteInferior, limiteSuperior);
+    while (!decisao && pares < cfg->maxPares)
+    {
+        int tamanho = cfg->maxPares - pares < lote ? cfg->maxPares - pares : lote;
+        jogarConfrontoParalelo(a, b, tamanho, semente + pares, threads, porPar);
+        for (int i = 0; i < tamanho && !decisao; i++)
+        {
+            double x = porPar[i] / 4.0; // placar do par, de 0 a 1
+            penta[porPar[i]]++;
+            pares++;
+            soma += x;
+            somaQuadrados += x * x;
+            double media = soma / pares, variancia = somaQuadrados / pares - media * media;
+            if (pares < 2)
+                continue;
+            if (variancia < VARIANCIA_MINIMA_SPRT)
+                variancia = VARIANCIA_MINIMA_SPRT;
+            llr = pares * (s1 - s0) * (2 * media - s0 - s1) / (2 * variancia);
+            if (llr >= limiteSuperior)
+                decisao = 1;
+            else if (llr <= limiteInferior)
+                decisao = -1;
+        }
+        if (!decisao && agoraSegundos() - ultimoRelatorio >= 1.0)
+        {
+            ultimoRelatorio = agoraSegundos();
+            printf("  %d pares | LLR %.2f\n", pares, llr);
+        }
+    }
+    free(porPar);
+
+    double media = pares ? soma / pares : 0.5;
+    double variancia = pares ? somaQuadrados / pares - media * media : 0;
+    double margem = pares ? 1.96 * sqrt(variancia / pares) : 0;
+    double segundos = agoraSegundos() - inicio;
+    if (pares >= 2 && variancia < VARIANCIA_MINIMA_SPRT)
+        printf("Variancia dos pares %.4f abaixo do piso %.4f: o LLR usou o piso\n", variancia, VARIANCIA_MINIMA_SPRT);
+    printf("Pares: %d (%d partidas) em %.2fs | pentanomial [%lld %lld %lld %lld %lld]\n", pares, 2 * pares,
+           segundos, penta[0], penta[1], penta[2], penta[3], penta[4]);
+    printf("Placar de %s: %.1f%% | Elo %+.1f (IC 95%%: %+.1f a %+.1f) | LLR %.2f\n", a->nome, media * 100.0,
+           eloDoPlacar(media), eloDoPlacar(media - margem), eloDoPlacar(media + margem), llr);
+    if (decisao > 0)
+        printf("Resultado: H1 aceita - %s e mais forte (elo >= %.1f)\n", a->nome, cfg->elo1);
+    else if (decisao < 0)
+        printf("Resultado: H0 aceita - %s nao chega a elo %.1f\n", a->nome, cfg->elo1);
+    else
+        printf("Resultado: inconclusivo depois de %d pares\n", pares);
+    return 0;
+}
+
+// ===== CFR para variantes pequenas =====
+// Resolve variantes com menos peças (duplo-3: 10 peças, duplo-4: 15) por MCCFR
+// com amostragem externa e regret matching+ (regrets negativos zerados, como
+// no CFR+) com média ponderada pela iteração. A variante usa o próprio motor:
+// o jogo é o mesmo, só o conjunto de peças e o tamanho da mão mudam.
+// Conjuntos de informação:
+//   exata: a própria mão + toda a história pública (recordação perfeita)
+//   mesa:  a própria mão + mesa, pontas, passadas e quantidades (abstração
+//          sem a ordem dos lances; bem menor, mas com recordação imperfeita)
+// As threads dividem uma tabela sem travas (CAS na chave, somas atômicas).
+// A explorabilidade é calculada exatamente, percorrendo a árvore inteira.
+#define MAX_ACOES_CFR 12
+#define HIST_COMPRA 0xC0
+#define HIST_PASSE 0xC1
+#define MAGICA_CFR "CFR1"
+
+typedef enum
+{
+    ABSTRACAO_EXATA,
+    ABSTRACAO_MESA
+} AbstracaoCfr;
+
+typedef struct
+{
+    _Atomic uint64_t chave; // 0 = vaga livre
+    _Atomic float regret[MAX_ACOES_CFR];
+    _Atomic float soma[MAX_ACOES_CFR]; // soma ponderada das estratégias (dá a estratégia média)
+} InfoCfr;
+
+typedef struct
+{
+    int maxPonto, tamanhoMao;
+    AbstracaoCfr abstracao;
+    MascaraPecas pecas; // peças da variante
+    InfoCfr *tabela;
+    uint64_t capacidade; // potência de 2
+    _Atomic long long iteracoes;
+    _Atomic long long semEspaco;
+} SolverCfr;
+
+static inline void somarFloatAtomico(_Atomic float *x, float v, int piso)
+{
+    float atual = atomic_load_explicit(x, memory_order_relaxed), novo;
+    do
+    {
+        novo = atual + v;
+        if (piso && novo < 0)
+            novo = 0;
+    } while (!atomic_compare_exchange_weak_explicit(x, &atual, novo, memory_order_relaxed, memory_order_relaxed));
+}
+
+// A história pública vai sendo resumida num hash: jogadas (peça e lado),
+// compras (a peça comprada só aparece na mão de quem comprou) e passes
+static inline uint64_t historiaCfr(uint64_t hist, int codigo)
+{
+    return misturar64(hist ^ (uint64_t)(codigo + 1) * 0x9E3779B97F4A7C15ULL);
+}
+
+// Máscara resumida em 64 bits (exata enquanto o conjunto cabe em 64 peças)
+static inline uint64_t mascara64(MascaraPecas m)
+{
+#if NUM_PECAS <= 64
+    return (uint64_t)m;
+#else
+    return (uint64_t)m ^ misturar64((uint64_t)(m >> 64));
+#endif
+}
+
+static uint64_t chaveInfoCfr(AbstracaoCfr abstracao, const EstadoMotor *e, uint64_t hist)
+{
+    uint64_t chave = mascara64(e->mao[e->vez]) << 1 | e->vez;
+    if (abstracao == ABSTRACAO_EXATA)
+        chave = misturar64(chave) ^ hist;
+    else
+    {
+#if NUM_PECAS <= 32
+        uint64_t publico = (uint64_t)e->mesa | (uint64_t)(e->pontas[0] + 1) << 32 | (uint64_t)(e->pontas[1] + 1) << 36 |
+                           (uint64_t)e->passadas << 40 | (uint64_t)contarPecas(e->mao[e->vez ^ 1]) << 42 |
+                           (uint64_t)contarPecas(e->monte) << 48;
+#else
+        // A mesa não deixa bits livres: os campos entram misturados ao lado dela
+        uint64_t publico = misturar64(mascara64(e->mesa)) ^ ((uint64_t)(e->pontas[0] + 1) | (uint64_t)(e->pontas[1] + 1) << 8 |
+                           (uint64_t)e->passadas << 16 | (uint64_t)contarPecas(e->mao[e->vez ^ 1]) << 24 |
+                           (uint64_t)contarPecas(e->monte) << 32);
+#endif
+        chave = misturar64(chave) ^ misturar64(publico + 0x51ED);
+    }
+    return chave ? chave : 1;
+}
+
+static InfoCfr *acharInfoCfr(SolverCfr *s, uint64_t chave, int criar)
+{
+    uint64_t mascara = s->capacidade - 1;
+    for (uint64_t i = chave & mascara, tentativas = 0; tentativas < 64; i = (i + 1) & mascara, tentativas++)
+    {
+        uint64_t atual = atomic_load_explicit(&s->tabela[i].chave, memory_order_relaxed);
+        if (atual == chave)
+            return &s->tabela[i];
+        if (atual == 0)
+        {
+            if (!criar)
+                return NULL;
+            uint64_t vazio = 0;
+            if (atomic_compare_exchange_strong(&s->tabela[i].chave, &vazio, chave) || vazio == chave)
+                return &s->tabela[i];
+        }
+    }
+    if (criar)
+        atomic_fetch_add_explicit(&s->semEspaco, 1, memory_order_relaxed);
+    return NULL;
+}
+
+// Regret matching+: proporcional aos regrets positivos, uniforme se não houver
+static void estrategiaAtualCfr(const InfoCfr *info, int n, double *estrategia)
+{
+    double total = 0;
+    for (int a = 0; a < n; a++)
+        total += estrategia[a] = info ? atomic_load_explicit(&info->regret[a], memory_order_relaxed) : 0;
+    for (int a = 0; a < n; a++)
+        estrategia[a] = total > 0 ? estrategia[a] / total : 1.0 / n;
+}
+
+static void estrategiaMediaCfr(const InfoCfr *info, int n, double *estrategia)
+{
+    double total = 0;
+    for (int a = 0; a < n; a++)
+        total += estrategia[a] = info ? atomic_load_explicit(&info->soma[a], memory_order_relaxed) : 0;
+    for (int a = 0; a < n; a++)
+        estrategia[a] = total > 0 ? estrategia[a] / total : 1.0 / n;
+}
+
+static double utilidadeCfr(int fim, int jogador)
+{
+    return fim == 3 ? 0.0 : (fim == jogador + 1 ? 1.0 : -1.0);
+}
+
+static int codigoLanceCfr(Lance l)
+{
+    return l.peca == LANCE_PASSAR ? HIST_PASSE : l.peca * 2 + l.lado;
+}
+
+// Uma passada de MCCFR com amostragem externa para o jogador 'eu':
+// todos os lances dele são explorados; acaso e adversário são sorteados
+static double percorrerCfr(SolverCfr *s, const EstadoMotor *e, uint64_t hist, int eu, float peso, uint64_t *semente)
+{
+    int fim = fimMotor(e);
+    if (fim)
+        return utilidadeCfr(fim, eu);
+
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances);
+    EstadoMotor filho = *e;
+    if (lances[0].peca == LANCE_COMPRAR)
+    {
+        comprarPecaMotor(&filho, sortearPeca(filho.monte, semente));
+        return percorrerCfr(s, &filho, historiaCfr(hist, HIST_COMPRA), eu, peso, semente);
+    }
+    if (n == 1)
+    {
+        aplicarLance(&filho, lances[0]);
+        return percorrerCfr(s, &filho, historiaCfr(hist, codigoLanceCfr(lances[0])), eu, peso, semente);
+    }
+
+    InfoCfr *info = n <= MAX_ACOES_CFR ? acharInfoCfr(s, chaveInfoCfr(s->abstracao, e, hist), 1) : NULL;
+    double estrategia[MAX_LANCES];
+    estrategiaAtualCfr(info, n, estrategia);
+
+    if (e->vez == eu)
+    {
+        double valores[MAX_LANCES], valorNo = 0;
+        for (int a = 0; a < n; a++)
+        {
+            filho = *e;
+            aplicarLance(&filho, lances[a]);
+            valores[a] = percorrerCfr(s, &filho, historiaCfr(hist, codigoLanceCfr(lances[a])), eu, peso, semente);
+            valorNo += estrategia[a] * valores[a];
+        }
+        if (info)
+            for (int a = 0; a < n; a++)
+                somarFloatAtomico(&info->regret[a], (float)(valores[a] - valorNo), 1);
+        return valorNo;
+    }
+
+    if (info)
+        for (int a = 0; a < n; a++)
+            somarFloatAtomico(&info->soma[a], (float)(peso * estrategia[a]), 0);
+    double sorteio = (proximoAleatorio(semente) >> 11) * (1.0 / 9007199254740992.0);
+    int escolhido = n - 1;
+    for (int a = 0; a < n - 1; a++)
+        if ((sorteio -= estrategia[a]) < 0)
+        {
+            escolhido = a;
+            break;
+        }
+    aplicarLance(&filho, lances[escolhido]);
+    return percorrerCfr(s, &filho, historiaCfr(hist, codigoLanceCfr(lances[escolhido])), eu, peso, semente);
+}
+
+// Reparte as peças da variante: tamanhoMao para cada um, o resto no monte
+static void distribuirCfr(const SolverCfr *s, EstadoMotor *e, uint64_t *semente)
+{
+    memset(e, 0, sizeof(*e));
+    e->pontas[0] = e->pontas[1] = -1;
+    MascaraPecas resto = s->pecas;
+    for (int j = 0; j < 2; j++)
+        for (int i = 0; i < s->tamanhoMao; i++)
+        {
+            int p = sortearPeca(resto, semente);
+            resto &= ~BIT_PECA(p);
+            e->mao[j] |= BIT_PECA(p);
+        }
+    e->monte = resto;
+}
+
+typedef struct
+{
+    SolverCfr *solver;
+    long long iteracoes;
+    uint64_t semente;
+} TrabalhoCfr;
+
+static void *trabalharCfr(void *arg)
+{
+    TrabalhoCfr *t = (TrabalhoCfr *)arg;
+    for (long long k = 0; k < t->iteracoes; k++)
+    {
+        // Média linear: a iteração t pesa t na estratégia média
+        float peso = (float)(atomic_fetch_add_explicit(&t->solver->iteracoes, 1, memory_order_relaxed) + 1);
+        for (int eu = 0; eu < 2; eu++)
+        {
+            EstadoMotor e;
+            distribuirCfr(t->solver, &e, &t->semente);
+            percorrerCfr(t->solver, &e, 0, eu, peso, &t->semente);
+        }
+    }
+    return NULL;
+}
+
+// ===== Explorabilidade (melhor resposta exata) =====
+// A melhor resposta de um jogador escolhe um lance por conjunto de informação
+// (chave exata), maximizando a soma sobre as histórias do conjunto do valor
+// ponderado pela chance de chegar nelas. As escolhas são refeitas de baixo para
+// cima: cada passada pela árvore usa as escolhas da anterior nos nós mais
+// fundos, até nenhuma mudar.
+typedef struct
+{
+    uint64_t chave;
+    int8_t acao, numAcoes;
+    double valores[MAX_ACOES_CFR];
+} NoRespostaCfr;
+
+typedef struct
+{
+    SolverCfr *solver;
+    NoRespostaCfr *tabela;
+    uint64_t capacidade, usados;
+    int eu, semMemoria;
+} RespostaCfr;
+
+static NoRespostaCfr *vagaRespostaCfr(NoRespostaCfr *tabela, uint64_t capacidade, uint64_t chave)
+{
+    uint64_t mascara = capacidade - 1, i = chave & mascara;
+    while (tabela[i].chave != chave && tabela[i].chave != 0)
+        i = (i + 1) & mascara;
+    return &tabela[i];
+}
+
+// A tabela dobra de tamanho quando passa da metade (o ponteiro devolvido só
+// vale até a próxima inserção)
+static NoRespostaCfr *acharRespostaCfr(RespostaCfr *r, uint64_t chave)
+{
+    NoRespostaCfr *no = vagaRespostaCfr(r->tabela, r->capacidade, chave);
+    if (no->chave)
+        return no;
+    if (2 * (r->usados + 1) > r->capacidade)
+    {
+        NoRespostaCfr *nova = calloc(2 * r->capacidade, sizeof(NoRespostaCfr));
+        if (!nova)
+        {
+            r->semMemoria = 1;
+            return no->chave || r->usados + 1 < r->capacidade ? (no->chave = chave, r->usados++, no) : &r->tabela[0];
+        }
+        for (uint64_t i = 0; i < r->capacidade; i++)
+            if (r->tabela[i].chave)
+                *vagaRespostaCfr(nova, 2 * r->capacidade, r->tabela[i].chave) = r->tabela[i];
+        free(r->tabela);
+        r->tabela = nova;
+        r->capacidade *= 2;
+        no = vagaRespostaCfr(r->tabela, r->capacidade, chave);
+    }
+    no->chave = chave;
+    r->usados++;
+    return no;
+}
+
+static double valorRespostaCfr(RespostaCfr *r, const EstadoMotor *e, uint64_t hist, double alcance)
+{
+    int fim = fimMotor(e);
+    if (fim)
+        return utilidadeCfr(fim, r->eu);
+
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances);
+    EstadoMotor filho;
+    if (lances[0].peca == LANCE_COMPRAR)
+    {
+        int quantidade = contarPecas(e->monte);
+        double valor = 0;
+        for (MascaraPecas m = e->monte; m; m &= m - 1)
+        {
+            filho = *e;
+            comprarPecaMotor(&filho, primeiraPeca(m));
+            valor += valorRespostaCfr(r, &filho, historiaCfr(hist, HIST_COMPRA), alcance / quantidade);
+        }
+        return valor / quantidade;
+    }
+
+    if (e->vez == r->eu)
+    {
+        double valores[MAX_LANCES];
+        for (int a = 0; a < n; a++)
+        {
+            filho = *e;
+            aplicarLance(&filho, lances[a]);
+            valores[a] = valorRespostaCfr(r, &filho, historiaCfr(hist, codigoLanceCfr(lances[a])), alcance);
+        }
+        if (n == 1)
+            return valores[0];
+        NoRespostaCfr *no = acharRespostaCfr(r, chaveInfoCfr(ABSTRACAO_EXATA, e, hist));
+        no->numAcoes = (int8_t)(n < MAX_ACOES_CFR ? n : MAX_ACOES_CFR);
+        for (int a = 0; a < no->numAcoes; a++)
+            no->valores[a] += alcance * valores[a];
+        return valores[no->acao];
+    }
+
+    double estrategia[MAX_LANCES], valor = 0;
+    if (n == 1)
+        estrategia[0] = 1;
+    else
+        estrategiaMediaCfr(n <= MAX_ACOES_CFR ? acharInfoCfr(r->solver, chaveInfoCfr(r->solver->abstracao, e, hist), 0) : NULL,
+                           n, estrategia);
+    for (int a = 0; a < n; a++)
+    {
+        if (estrategia[a] <= 0)
+            continue;
+        filho = *e;
+        aplicarLance(&filho, lances[a]);
+        valor += estrategia[a] *
+                 valorRespostaCfr(r, &filho, historiaCfr(hist, codigoLanceCfr(lances[a])), alcance * estrategia[a]);
+    }
+    return valor;
+}
+
+// Soma sobre todas as distribuições (cada uma com a mesma chance)
+static double valorRaizRespostaCfr(RespostaCfr *r)
+{
+    SolverCfr *s = r->solver;
+    double total = 0;
+    long long distribuicoes = 0;
+    for (MascaraPecas m0 = s->pecas;; m0 = (m0 - 1) & s->pecas)
+    {
+        if (contarPecas(m0) == s->tamanhoMao)
+        {
+            MascaraPecas resto = s->pecas & ~m0;
+            for (MascaraPecas m1 = resto;; m1 = (m1 - 1) & resto)
+            {
+                if (contarPecas(m1) == s->tamanhoMao)
+                {
+                    EstadoMotor e;
+                    memset(&e, 0, sizeof(e));
+                    e.pontas[0] = e.pontas[1] = -1;
+                    e.mao[0] = m0;
+                    e.mao[1] = m1;
+                    e.monte = resto & ~m1;
+                    total += valorRespostaCfr(r, &e, 0, 1.0);
+                    distribuicoes++;
+                }
+                if (!m1)
+                    break;
+            }
+        }
+        if (!m0)
+            break;
+    }
+    return distribuicoes ? total / distribuicoes : 0;
+}
+
+// Quanto uma melhor resposta ganha, em média, contra a estratégia média
+// (utilidade: vitória 1, derrota -1). Zero = equilíbrio de Nash.
+double explorabilidadeCfr(SolverCfr *s)
+{
+    double soma = 0;
+    for (int eu = 0; eu < 2; eu++)
+    {
+        RespostaCfr r = {s, calloc(1 << 16, sizeof(NoRespostaCfr)), 1 << 16, 0, eu, 0};
+        if (!r.tabela)
+            return -1;
+        double valor = 0;
+        for (int passada = 0; passada < 64 && !r.semMemoria; passada++)
+        {
+            for (uint64_t i = 0; i < r.capacidade; i++)
+                memset(r.tabela[i].valores, 0, sizeof(r.tabela[i].valores));
+            valor = valorRaizRespostaCfr(&r);
+            int mudou = 0;
+            for (uint64_t i = 0; i < r.capacidade; i++)
+            {
+                NoRespostaCfr *no = &r.tabela[i];
+                if (!no->chave)
+                    continue;
+                int melhor = no->acao;
+                for (int a = 0; a < no->numAcoes; a++)
+                    if (no->valores[a] > no->valores[melhor] + 1e-12)
+                        melhor = a;
+                mudou += melhor != no->acao;
+                no->acao = (int8_t)melhor;
+            }
+            if (!mudou)
+                break;
+        }
+        free(r.tabela);
+        if (r.semMemoria)
+            return -1;
+        soma += valor;
+    }
+    return soma / 2;
+}
+
+// Checkpoint: cabeçalho e as entradas ocupadas da tabela
+int salvarCfr(const SolverCfr *s, const char *caminho)
+{
+    FILE *arquivo = fopen(caminho, "wb");
+    if (!arquivo)
+        return 0;
+    int32_t cabecalho[3] = {s->maxPonto, s->tamanhoMao, s->abstracao};
+    long long iteracoes = atomic_load(&s->iteracoes);
+    int ok = fwrite(MAGICA_CFR, 1, 4, arquivo) == 4 && fwrite(cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+             fwrite(&iteracoes, sizeof(iteracoes), 1, arquivo) == 1;
+    for (uint64_t i = 0; ok && i < s->capacidade; i++)
+    {
+        uint64_t chave = atomic_load(&s->tabela[i].chave);
+        if (!chave)
+            continue;
+        float valores[2 * MAX_ACOES_CFR];
+        for (int a = 0; a < MAX_ACOES_CFR; a++)
+        {
+            valores[a] = atomic_load(&s->tabela[i].regret[a]);
+            valores[MAX_ACOES_CFR + a] = atomic_load(&s->tabela[i].soma[a]);
+        }
+        ok = fwrite(&chave, sizeof(chave), 1, arquivo) == 1 && fwrite(valores, sizeof(valores), 1, arquivo) == 1;
+    }
+    return (fclose(arquivo) == 0) && ok;
+}
+
+int carregarCfr(SolverCfr *s, const char *caminho)
+{
+    FILE *arquivo = fopen(caminho, "rb");
+    if (!arquivo)
+        return 0;
+    char magica[4];
+    int32_t cabecalho[3];
+    long long iteracoes;
+    int ok = fread(magica, 1, 4, arquivo) == 4 && memcmp(magica, MAGICA_CFR, 4) == 0 &&
+             fread(cabecalho, sizeof(cabecalho), 1, arquivo) == 1 && fread(&iteracoes, sizeof(iteracoes), 1, arquivo) == 1 &&
+             cabecalho[0] == s->maxPonto && cabecalho[1] == s->tamanhoMao && cabecalho[2] == (int32_t)s->abstracao;
+    uint64_t chave;
+    float valores[2 * MAX_ACOES_CFR];
+    while (ok && fread(&chave, sizeof(chave), 1, arquivo) == 1 && fread(valores, sizeof(valores), 1, arquivo) == 1)
+    {
+        InfoCfr *info = acharInfoCfr(s, chave, 1);
+        if (!info)
+            continue;
+        for (int a = 0; a < MAX_ACOES_CFR; a++)
+        {
+            atomic_store(&info->regret[a], valores[a]);
+            atomic_store(&info->soma[a], valores[MAX_ACOES_CFR + a]);
+        }
+    }
+    if (ok)
+        atomic_store(&s->iteracoes, iteracoes);
+    fclose(arquivo);
+    return ok;
+}
+
+typedef struct
+{
+    int maxPonto, tamanhoMao;
+    AbstracaoCfr abstracao;
+    long long iteracoes, aCada; // checkpoint (e explorabilidade) a cada 'aCada' iterações
+    int threads, calcularExplorabilidade;
+    int bitsTabela;
+    const char *checkpoint, *retomar;
+    uint64_t semente;
+} ConfigCfr;
+
+int resolverCfr(const ConfigCfr *cfg)
+{
+    SolverCfr s;
+    memset(&s, 0, sizeof(s));
+    s.maxPonto = cfg->maxPonto;
+    s.tamanhoMao = cfg->tamanhoMao;
+    s.abstracao = cfg->abstracao;
+    for (int i = 0; i < NUM_PECAS; i++)
+        if (pecaMotor[i].lado2 <= cfg->maxPonto)
+            s.pecas |= BIT_PECA(i);
+    s.capacidade = (uint64_t)1 << cfg->bitsTabela;
+    s.tabela = calloc(s.capacidade, sizeof(InfoCfr));
+    TrabalhoCfr *trabalhos = calloc(cfg->threads, sizeof(TrabalhoCfr));
+    if (!s.tabela || !trabalhos || 2 * cfg->tamanhoMao > contarPecas(s.pecas))
+    {
+        free(s.tabela);
+        free(trabalhos);
+        return 1;
+    }
+    if (cfg->retomar && carregarCfr(&s, cfg->retomar))
+        printf("Retomado de %s: %lld iteracoes\n", cfg->retomar, atomic_load(&s.iteracoes));
+
+    printf("\n=== CFR duplo-%d (%d pecas), %d por mao, abstracao %s, %d threads ===\n", cfg->maxPonto,
+           contarPecas(s.pecas), cfg->tamanhoMao, cfg->abstracao == ABSTRACAO_EXATA ? "exata" : "mesa", cfg->threads);
+    uint64_t semente = cfg->semente;
+    double segundos = 0;
+    long long feitas = 0;
+    while (feitas < cfg->iteracoes)
+    {
+        long long lote = cfg->iteracoes - feitas < cfg->aCada ? cfg->iteracoes - feitas : cfg->aCada;
+        for (int t = 0; t < cfg->threads; t++)
+            trabalhos[t] = (TrabalhoCfr){&s, lote * (t + 1) / cfg->threads - lote * t / cfg->threads,
+                                         proximoAleatorio(&semente)};
+        double inicio = agoraSegundos();
+        executarEmThreads(cfg->threads, trabalharCfr, trabalhos, sizeof(TrabalhoCfr));
+        segundos += agoraSegundos() - inicio;
+        feitas += lote;
+
+        long long ocupadas = 0;
+        for (uint64_t i = 0; i < s.capacidade; i++)
+            ocupadas += atomic_load_explicit(&s.tabela[i].chave, memory_order_relaxed) != 0;
+        printf("  %lld iteracoes | %.1fs (%.0f it/s) | %lld conjuntos de informacao", atomic_load(&s.iteracoes),
+               segundos, segundos > 0 ? feitas / segundos : 0.0, ocupadas);
+        if (atomic_load(&s.semEspaco))
+            printf(" | tabela cheia (%lld)", atomic_load(&s.semEspaco));
+        if (cfg->calcularExplorabilidade)
+            printf(" | explorabilidade %.4f", explorabilidadeCfr(&s));
+        printf("\n");
+        if (cfg->checkpoint && !salvarCfr(&s, cfg->checkpoint))
+            printf("Nao foi possivel gravar %s\n", cfg->checkpoint);
+    }
+    free(s.tabela);
+    free(trabalhos);
+    return 0;
+}
+
+// ===== Destilação: autojogo do professor -> modelo linear =====
+// O professor (uma política forte do registro) joga contra si mesmo em todas
+// as threads; cada decisão com mais de um lance é gravada (o estado visto por
+// quem joga, a crença e o lance escolhido). Depois um modelo softmax linear é
+// treinado por SGD para dar a maior pontuação ao lance do professor.
+typedef struct
+{
+    EstadoMotor estado;
+    Crenca crenca;
+    Lance escolhido;
+} AmostraDestilacao;
+
+typedef struct
+{
+    Politica *professor;
+    AmostraDestilacao *amostras;
+    int quantidade, capacidade;
+    int primeira, fim; // partidas desta thread
+    uint64_t semente;
+} GravadorDestilacao;
+
+static Lance politicaGravadora(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    GravadorDestilacao *g = (GravadorDestilacao *)config;
+    Lance l = g->professor->escolher(e, crenca, g->professor->config, semente);
+    Lance lances[MAX_LANCES];
+    if (gerarLances(e, lances) < 2 || l.peca < 0)
+        return l;
+    if (g->quantidade == g->capacidade)
+    {
+        int capacidade = g->capacidade ? 2 * g->capacidade : 1024;
+        AmostraDestilacao *novas = realloc(g->amostras, capacidade * sizeof(AmostraDestilacao));
+        if (!novas)
+            return l;
+        g->amostras = novas;
+        g->capacidade = capacidade;
+    }
+    g->amostras[g->quantidade++] = (AmostraDestilacao){*e, *crenca, l};
+    return l;
+}
+
+static void *gravarPartidasDestilacao(void *arg)
+{
+    GravadorDestilacao *g = (GravadorDestilacao *)arg;
+    Politica gravadora = {"gravadora", politicaGravadora, g};
+    Politica *jogadores[2] = {&gravadora, &gravadora};
+    for (int k = g->primeira; k < g->fim; k++)
+        simularPartidaMotor(jogadores, g->semente + k, NULL);
+    return NULL;
+}
+
+// Passo de SGD na entropia cruzada do softmax sobre os lances legais.
+// Retorna 1 se o modelo já dá a maior pontuação ao lance do professor.
+static int treinarAmostraDestilada(ModeloDestilado *m, const AmostraDestilacao *a, float taxa)
+{
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(&a->estado, lances);
+    CaracteristicaHash x[MAX_LANCES_DESTILADA][MAX_CARAC_DESTILADA];
+    int k[MAX_LANCES_DESTILADA], alvo = -1;
+    double pontos[MAX_LANCES_DESTILADA], maximo = -1e300, total = 0;
+
+    for (int i = 0; i < n; i++)
+    {
+        k[i] = caracteristicasDestiladas(&a->estado, &a->crenca, lances[i], x[i]);
+        pontos[i] = 0;
+        for (int j = 0; j < k[i]; j++)
+            pontos[i] += m->pesos[x[i][j].indice] * x[i][j].valor;
+        if (pontos[i] > maximo)
+            maximo = pontos[i];
+        if (mesmoLance(lances[i], a->escolhido))
+            alvo = i;
+    }
+    if (alvo < 0)
+        return 0;
+    int acertou = pontos[alvo] >= maximo;
+    for (int i = 0; i < n; i++)
+        total += pontos[i] = exp(pontos[i] - maximo);
+    for (int i = 0; i < n; i++)
+    {
+        float gradiente = (float)(pontos[i] / total - (i == alvo));
+        for (int j = 0; j < k[i]; j++)
+            m->pesos[x[i][j].indice] -= taxa * gradiente * x[i][j].valor;
+    }
+    return acertou;
+}
+
+int destilarPolitica(const char *saida, Politica *professor, int partidas, int epocas, int threads, uint64_t semente)
+{
+    GravadorDestilacao *gravadores = calloc(threads, sizeof(GravadorDestilacao));
+    if (!gravadores)
+        return 0;
+    for (int t = 0; t < threads; t++)
+        gravadores[t] = (GravadorDestilacao){professor, NULL, 0, 0, partidas * t / threads,
+                                             partidas * (t + 1) / threads, semente};
+    printf("Destilando %s: %d partidas de autojogo em %d threads\n", professor->nome, partidas, threads);
+    double inicio = agoraSegundos();
+    executarEmThreads(threads, gravarPartidasDestilacao, gravadores, sizeof(GravadorDestilacao));
+
+    // Junta as amostras das threads numa ordem embaralhada
+    int total = 0;
+    for (int t = 0; t < threads; t++)
+        total += gravadores[t].quantidade;
+    AmostraDestilacao *amostras = malloc((total ? total : 1) * sizeof(AmostraDestilacao));
+    for (int t = 0, k = 0; t < threads; t++)
+    {
+        if (amostras)
+            memcpy(amostras + k, gravadores[t].amostras, gravadores[t].quantidade * sizeof(AmostraDestilacao));
+        k += gravadores[t].quantidade;
+        free(gravadores[t].amostras);
+    }
+    free(gravadores);
+    if (!amostras)
+        return 0;
+    printf("%d decisoes gravadas em %.1fs\n", total, agoraSegundos() - inicio);
+    uint64_t sorteio = semente ^ 0xD157;
+    for (int i = total - 1; i > 0; i--)
+    {
+        int j = aleatorioAte(&sorteio, i + 1);
+        AmostraDestilacao temp = amostras[i];
+        amostras[i] = amostras[j];
+        amostras[j] = temp;
+    }
+
+    // 90% para treino, 10% para medir a concordância com o professor
+    int treino = total - total / 10;
+    ModeloDestilado modelo;
+    memset(&modelo, 0, sizeof(modelo));
+    modelo.carregado = 1;
+    for (int epoca = 0; epoca < epocas; epoca++)
+    {
+        float taxa = 0.1f / (1 + epoca);
+        int acertos = 0, acertosValidacao = 0;
+        for (int i = 0; i < treino; i++)
+            acertos += treinarAmostraDestilada(&modelo, &amostras[i], taxa);
+        for (int i = treino; i < total; i++)
+            acertosValidacao += treinarAmostraDestilada(&modelo, &amostras[i], 0.0f);
+        printf("  epoca %d: concordancia com o professor %.1f%% (treino) | %.1f%% (validacao)\n", epoca + 1,
+               treino ? 100.0 * acertos / treino : 0.0, total > treino ? 100.0 * acertosValidacao / (total - treino) : 0.0);
+    }
+    free(amostras);
+    return salvarModeloDestilado(saida, &modelo);
+}
+
+// ===== Desafios de finais (quebra-cabeças) =====
+// Com o monte vazio e as duas mãos à vista o final é um jogo de informação
+// perfeita, resolvido exatamente por negamax vitória/empate/derrota com
+// tabela de transposição (e a tablebase, quando carregada, nos finais que
+// ela cobre). O gerador joga partidas sem janela em todas as threads e
+// guarda as posições em que o solucionador prova que exatamente um lance
+// vence, junto com a linha da solução.
+#define TT_FINAIS_BITS 20
+#define MAX_SOLUCAO_DESAFIO (2 * NUM_PECAS + 2)
+#define MAX_DESAFIOS 4096
+// Uma linha do arquivo: as peças das duas mãos ("12-12 "), separadores e
+// pontas, e a solução (" 12-12D" por lance)
+#define TAMANHO_LINHA_DESAFIO (NUM_PECAS * 6 + MAX_SOLUCAO_DESAFIO * 7 + 32)
+
+typedef struct
+{
+    uint64_t *chaves;
+    uint8_t *valores;
+    long long nos;
+} SolucionadorFinais;
+
+typedef struct
+{
+    MascaraPecas mao[2]; // [0] = quem joga (o humano na tela de desafios)
+    int8_t pontas[2];
+    int numLances;
+    Lance solucao[MAX_SOLUCAO_DESAFIO]; // lances dos dois lados, a começar por quem joga
+    uint64_t chave;
+} Desafio;
+
+int criarSolucionadorFinais(SolucionadorFinais *s)
+{
+    s->chaves = calloc((size_t)1 << TT_FINAIS_BITS, sizeof(uint64_t));
+    s->valores = calloc((size_t)1 << TT_FINAIS_BITS, 1);
+    s->nos = 0;
+    return s->chaves && s->valores;
+}
+
+void liberarSolucionadorFinais(SolucionadorFinais *s)
+{
+    free(s->chaves);
+    free(s->valores);
+}
+
+// Valor exato para o jogador da vez, na convenção da tablebase:
+// 1 = derrota, 2 = empate, 3 = vitória. O monte deve estar vazio.
+int resolverFinal(SolucionadorFinais *s, const EstadoMotor *e)
+{
+    s->nos++;
+    int fim = fimMotor(e);
+    if (fim)
+        return fim == 3 ? 2 : (fim == e->vez + 1 ? 3 : 1);
+    int valor = valorEstadoTablebase(&tablebase, e);
+    if (valor)
+        return valor;
+    size_t i = e->chave & (((size_t)1 << TT_FINAIS_BITS) - 1);
+    if (s->valores[i] && s->chaves[i] == e->chave)
+        return s->valores[i];
+
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances), melhor = 1;
+    for (int k = 0; k < n && melhor < 3; k++)
+    {
+        EstadoMotor filho = *e;
+        aplicarLance(&filho, lances[k]);
+        int v = 4 - resolverFinal(s, &filho);
+        if (v > melhor)
+            melhor = v;
+    }
+    s->chaves[i] = e->chave;
+    s->valores[i] = (uint8_t)melhor;
+    return melhor;
+}
+
+// Estado do motor de um desafio: quem joga é o jogador 0, o resto está na mesa
+EstadoMotor estadoDoDesafio(const Desafio *d)
+{
+    EstadoMotor e;
+    memset(&e, 0, sizeof(e));
+    e.mao[0] = d->mao[0];
+    e.mao[1] = d->mao[1];
+    e.mesa = TODAS_PECAS & ~(d->mao[0] | d->mao[1]);
+    e.pontas[0] = d->pontas[0];
+    e.pontas[1] = d->pontas[1];
+    e.chave = calcularChaveMotor(&e);
+    return e;
+}
+
+// Se só um lance vence, monta o desafio com a linha da solução: quem joga
+// segue vencendo e o adversário (que já perdeu) responde com o primeiro lance
+static int montarDesafio(SolucionadorFinais *s, const EstadoMotor *e, Desafio *d)
+{
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances), vencedores = 0, unico = -1;
+    if (n < 2 || lances[0].peca < 0)
+        return 0;
+    for (int k = 0; k < n && vencedores < 2; k++)
+    {
+        EstadoMotor filho = *e;
+        aplicarLance(&filho, lances[k]);
+        if (resolverFinal(s, &filho) == 1)
+        {
+            vencedores++;
+            unico = k;
+        }
+    }
+    if (vencedores != 1)
+        return 0;
+
+    int eu = e->vez;
+    d->mao[0] = e->mao[eu];
+    d->mao[1] = e->mao[eu ^ 1];
+    d->pontas[0] = (int8_t)e->pontas[0];
+    d->pontas[1] = (int8_t)e->pontas[1];
+    EstadoMotor normalizado = estadoDoDesafio(d);
+    d->chave = normalizado.chave;
+    d->numLances = 0;
+    EstadoMotor atual = *e;
+    Lance l = lances[unico];
+    while (d->numLances < MAX_SOLUCAO_DESAFIO)
+    {
+        d->solucao[d->numLances++] = l;
+        aplicarLance(&atual, l);
+        if (fimMotor(&atual))
+            break;
+        n = gerarLances(&atual, lances);
+        l = lances[0];
+        for (int k = 0; atual.vez == eu && k < n; k++)
+        {
+            EstadoMotor filho = atual;
+            aplicarLance(&filho, lances[k]);
+            if (resolverFinal(s, &filho) == 1)
+            {
+                l = lances[k];
+                break;
+            }
+        }
+    }
+    return 1;
+}
+
+// Partidas jogadas por desafio pedido antes de desistir: com --min-pecas alto
+// os finais aceitos ficam raros (ou impossíveis) e a geração não termina
+#define MAX_PARTIDAS_POR_DESAFIO 5000
+
+typedef struct
+{
+    atomic_int *proximaPartida, *encontrados;
+    int alvo, minPecas, limitePartidas;
+    uint64_t semente;
+    Desafio *desafios;
+    int quantidade, capacidade;
+    long long nos, partidas;
+} TrabalhoDesafios;
+
+static void *gerarDesafiosThread(void *arg)
+{
+    TrabalhoDesafios *t = (TrabalhoDesafios *)arg;
+    SolucionadorFinais s;
+    if (!criarSolucionadorFinais(&s))
+    {
+        liberarSolucionadorFinais(&s);
+        return NULL;
+    }
+    int k;
+    while (atomic_load(t->encontrados) < t->alvo && (k = atomic_fetch_add(t->proximaPartida, 1)) >= 0 &&
+           k < t->limitePartidas)
+    {
+        // Uma partida da heurística contra si mesma; o primeiro final com
+        // monte vazio que tiver um único lance vencedor vira desafio
+        EstadoMotor e;
+        uint64_t sorteio = misturar64(t->semente + k);
+        distribuirMotor(&e, &sorteio);
+        t->partidas++;
+        while (!fimMotor(&e))
+        {
+            if (!e.monte && contarPecas(e.mao[0] | e.mao[1]) >= t->minPecas && t->quantidade < t->capacidade &&
+                montarDesafio(&s, &e, &t->desafios[t->quantidade]))
+            {
+                t->quantidade++;
+                atomic_fetch_add(t->encontrados, 1);
+                break;
+            }
+            Lance l = politicaHeuristica(&e, NULL, &pesosHeuristica, &sorteio);
+            if (l.peca == LANCE_COMPRAR)
+                comprarPecaMotor(&e, sortearPeca(e.monte, &sorteio));
+            else
+                aplicarLance(&e, l);
+        }
+    }
+    t->nos = s.nos;
+    liberarSolucionadorFinais(&s);
+    return NULL;
+}
+
+static int compararDesafios(const void *x, const void *y)
+{
+    uint64_t a = ((const Desafio *)x)->chave, b = ((const Desafio *)y)->chave;
+    return (a > b) - (a < b);
+}
+
+static void escreverPecasDesafio(FILE *f, MascaraPecas m)
+{
+    for (int primeira = 1; m; m &= m - 1, primeira = 0)
+        fprintf(f, "%s%d-%d", primeira ? "" : " ", pecaMotor[primeiraPeca(m)].lado1, pecaMotor[primeiraPeca(m)].lado2);
+}
+
+// Arquivo texto, um desafio por linha:
+//   mao de quem joga | mao do adversario | pontas | solucao (peca + lado E/D, ou "passa")
+int salvarDesafios(const char *caminho, const Desafio *d, int n)
+{
+    FILE *f = fopen(caminho, "w");
+    if (!f)
+        return 0;
+    fprintf(f, "# Desafios de finais do Domino Clash: monte vazio, as duas maos a vista e um unico lance vencedor\n");
+    fprintf(f, "# sua mao | mao do adversario | pontas (esquerda direita) | solucao\n");
+    for (int i = 0; i < n; i++)
+    {
+        escreverPecasDesafio(f, d[i].mao[0]);
+        fprintf(f, " | ");
+        escreverPecasDesafio(f, d[i].mao[1]);
+        fprintf(f, " | %d %d |", d[i].pontas[0], d[i].pontas[1]);
+        for (int k = 0; k < d[i].numLances; k++)
+        {
+            Lance l = d[i].solucao[k];
+            if (l.peca < 0)
+                fprintf(f, " passa");
+            else
+                fprintf(f, " %d-%d%c", pecaMotor[l.peca].lado1, pecaMotor[l.peca].lado2, l.lado ? 'D' : 'E');
+        }
+        fprintf(f, "\n");
+    }
+    return fclose(f) == 0;
+}
+
+static int lerPecasDesafio(char *texto, MascaraPecas *m)
+{
+    int a, b, n = 0;
+    *m = 0;
+    for (char *tok = strtok(texto, " \t"); tok; tok = strtok(NULL, " \t"))
+    {
+        if (sscanf(tok, "%d-%d", &a, &b) != 2 || a < 0 || b < 0 || a > MAX_PONTO || b > MAX_PONTO)
+            return 0;
+        *m |= BIT_PECA(indicePeca[a][b]);
+        n++;
+    }
+    return n > 0;
+}
+
+// Lê até 'max' desafios; linhas malformadas são ignoradas
+int carregarDesafios(const char *caminho, Desafio *d, int max)
+{
+    FILE *f = fopen(caminho, "r");
+    if (!f)
+        return 0;
+    char linha[TAMANHO_LINHA_DESAFIO];
+    int n = 0;
+    while (n < max && fgets(linha, sizeof(linha), f))
+    {
+        // Linha maior que qualquer desafio válido: descarta o resto dela
+        if (!strchr(linha, '\n') && !feof(f))
+        {
+            int c;
+            while ((c = fgetc(f)) != '\n' && c != EOF)
+                ;
+            continue;
+        }
+        if (linha[0] == '#')
+            continue;
+        char *campos[4] = {linha};
+        int k = 1;
+        for (char *barra; k < 4 && (barra = strchr(campos[k - 1], '|')); k++)
+        {
+            *barra = '\0';
+            campos[k] = barra + 1;
+        }
+        int p0, p1, a, b;
+        char lado;
+        if (k < 4 || !lerPecasDesafio(campos[0], &d[n].mao[0]) || !lerPecasDesafio(campos[1], &d[n].mao[1]) ||
+            sscanf(campos[2], "%d %d", &p0, &p1) != 2)
+            continue;
+        d[n].pontas[0] = (int8_t)p0;
+        d[n].pontas[1] = (int8_t)p1;
+        d[n].numLances = 0;
+        for (char *tok = strtok(campos[3], " \t\r\n"); tok && d[n].numLances < MAX_SOLUCAO_DESAFIO; tok = strtok(NULL, " \t\r\n"))
+        {
+            if (strcmp(tok, "passa") == 0)
+                d[n].solucao[d[n].numLances++] = (Lance){LANCE_PASSAR, 0};
+            else if (sscanf(tok, "%d-%d%c", &a, &b, &lado) == 3 && a >= 0 && b >= 0 && a <= MAX_PONTO && b <= MAX_PONTO)
+                d[n].solucao[d[n].numLances++] = (Lance){(int8_t)indicePeca[a][b], (int8_t)(lado == 'D')};
+        }
+        if (d[n].numLances > 0)
+            n++;
+    }
+    fclose(f);
+    return n;
+}
+
+int gerarDesafios(const char *saida, int alvo, int minPecas, int threads, uint64_t semente)
+{
+    // Com o monte vazio ao menos uma peça está na mesa
+    if (minPecas > NUM_PECAS - 1)
+    {
+        printf("--min-pecas %d impossivel: as maos somam no maximo %d pecas\n", minPecas, NUM_PECAS - 1);
+        return 0;
+    }
+    int limitePartidas = alvo > INT_MAX / MAX_PARTIDAS_POR_DESAFIO ? INT_MAX : alvo * MAX_PARTIDAS_POR_DESAFIO;
+    atomic_int proximaPartida = 0, encontrados = 0;
+    TrabalhoDesafios *trabalhos = calloc(threads, sizeof(TrabalhoDesafios));
+    if (!trabalhos)
+        return 0;
+    for (int t = 0; t < threads; t++)
+    {
+        trabalhos[t] = (TrabalhoDesafios){&proximaPartida, &encontrados, alvo, minPecas, limitePartidas, semente};
+        trabalhos[t].capacidade = alvo;
+        trabalhos[t].desafios = malloc(alvo * sizeof(Desafio));
+    }
+    printf("Gerando %d desafios (pelo menos %d pecas nas maos) em %d threads\n", alvo, minPecas, threads);
+    double inicio = agoraSegundos();
+    executarEmThreads(threads, gerarDesafiosThread, trabalhos, sizeof(TrabalhoDesafios));
+    double segundos = agoraSegundos() - inicio;
+
+    // Junta as threads e tira as posições repetidas
+    Desafio *todos = malloc((alvo * threads + 1) * sizeof(Desafio));
+    int n = 0;
+    long long nos = 0, partidas = 0;
+    for (int t = 0; t < threads; t++)
+    {
+        for (int i = 0; todos && i < trabalhos[t].quantidade; i++)
+            todos[n++] = trabalhos[t].desafios[i];
+        nos += trabalhos[t].nos;
+        partidas += trabalhos[t].partidas;
+        free(trabalhos[t].desafios);
+    }
+    free(trabalhos);
+    if (!todos)
+        return 0;
+    qsort(todos, n, sizeof(Desafio), compararDesafios);
+    int unicos = 0;
+    for (int i = 0; i < n; i++)
+        if (unicos == 0 || todos[i].chave != todos[unicos - 1].chave)
+            todos[unicos++] = todos[i];
+    if (unicos > alvo)
+        unicos = alvo;
+
+    printf("%d desafios de %lld partidas em %.2fs | solucionador: %lld nos (%.0f nos/s)\n", unicos, partidas,
+           segundos, nos, segundos > 0 ? nos / segundos : 0.0);
+    if (unicos < alvo)
+        printf("Faltaram %d desafios: limite de %d partidas por desafio pedido (tente um --min-pecas menor)\n",
+               alvo - unicos, MAX_PARTIDAS_POR_DESAFIO);
+    int ok = unicos > 0 && salvarDesafios(saida, todos, unicos);
+    free(todos);
+    return ok;
+}
+
+// Função callback para receber dados da requisição HTTP
+// Chamada automaticamente pela libcurl conforme a resposta chega
+static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp)
+{
+    size_t realsize = size * nmemb;
+    HttpResponse *mem = (HttpResponse *)userp;
+
+    char *ptr = realloc(mem->data, mem->size + realsize + 1);
+    if (!ptr)
+    {
+        return 0;
+    }
+
+    mem->data = ptr;
+    memcpy(&(mem->data[mem->size]), contents, realsize);
+    mem->size += realsize;
+    mem->data[mem->size] = 0;
+
+    return realsize;
+}
+
+// Estimativa de tokens de uma chamada: ~4 caracteres por token no prompt
+// mais o prompt de sistema e o máximo de tokens da resposta
+int estimarTokens(const char *prompt)
+{
+    return (int)(strlen(prompt) / 4) + 64 + GROQ_MAX_TOKENS;
+}
+
+// Converte durações no formato da Groq ("2s", "1m30.5s", "250ms") para segundos
+double lerDuracao(const char *texto)
+{
+    double total = 0, valor;
+    int lidos;
+    while (sscanf(texto, "%lf%n", &valor, &lidos) == 1)
+    {
+        texto += lidos;
+        if (texto[0] == 'm' && texto[1] == 's')
+            total += valor / 1000.0, texto += 2;
+        else if (texto[0] == 'h')
+            total += valor * 3600.0, texto++;
+        else if (texto[0] == 'm')
+            total += valor * 60.0, texto++;
+        else
+        {
+            total += valor;
+            if (texto[0] == 's')
+                texto++;
+        }
+    }
+    return total;
+}
+
+// Callback de cabeçalhos da libcurl - guarda os limites informados pela API
+static size_t header_callback(char *buffer, size_t size, size_t nitems, void *userp)
+{
+    size_t total = size * nitems;
+    LimitesResposta *lim = (LimitesResposta *)userp;
+    char linha[256];
+    size_t n = total < sizeof(linha) - 1 ? total : sizeof(linha) - 1;
+    memcpy(linha, buffer, n);
+    linha[n] = '\0';
+
+    char *valor = strchr(linha, ':');
+    if (!valor)
+        return total;
+    *valor++ = '\0';
+    while (*valor == ' ')
+        valor++;
+
+    for (char *c = linha; *c; c++)
+        if (*c >= 'A' && *c <= 'Z')
+            *c += 'a' - 'A';
+
+    if (strcmp(linha, "x-ratelimit-remaining-requests") == 0)
+        lim->restantesReq = atof(valor);
+    else if (strcmp(linha, "x-ratelimit-remaining-tokens") == 0)
+        lim->restantesTok = atof(valor);
+    else if (strcmp(linha, "x-ratelimit-reset-requests") == 0)
+        lim->resetReq = lerDuracao(valor);
+    else if (strcmp(linha, "x-ratelimit-reset-tokens") == 0)
+        lim->resetTok = lerDuracao(valor);
+    else if (strcmp(linha, "retry-after") == 0)
+        lim->retryAfter = atof(valor);
+    return total;
+}
+
+// Recarrega os baldes proporcionalmente ao tempo passado (chamar com a trava)
+static void recarregarBaldes(Agendador *ag, double agora)
+{
+    if (!ag->configurado)
+    {
+        const char *rpm = getenv("GROQ_RPM"), *tpm = getenv("GROQ_TPM");
+        ag->limiteReq = rpm && atof(rpm) > 0 ? atof(rpm) : GROQ_LIMITE_RPM;
+        ag->limiteTok = tpm && atof(tpm) > 0 ? atof(tpm) : GROQ_LIMITE_TPM;
+        ag->requisicoes = ag->limiteReq;
+        ag->tokens = ag->limiteTok;
+        ag->ultimaRecarga = agora;
+        ag->configurado = 1;
+    }
+    double dt = agora - ag->ultimaRecarga;
+    ag->ultimaRecarga = agora;
+    ag->requisicoes += dt * ag->limiteReq / 60.0;
+    ag->tokens += dt * ag->limiteTok / 60.0;
+    if (ag->requisicoes > ag->limiteReq)
+        ag->requisicoes = ag->limiteReq;
+    if (ag->tokens > ag->limiteTok)
+        ag->tokens = ag->limiteTok;
+}
+
+// Bloqueia até existir orçamento para a chamada
+// Chamadas de fundo só saem quando nenhuma mesa ao vivo está esperando
+// Retorna o tempo esperado em segundos, ou -1 se o prazo (0 = sem prazo) acabou antes
+double aguardarAgendador(Agendador *ag, int custoTokens, PrioridadeAPI prioridade, double prazo)
+{
+    double inicio = agoraSegundos();
+    int desistiu = 0;
+    pthread_mutex_lock(&ag->trava);
+    if (prioridade == PRIORIDADE_MESA)
+        ag->mesasEsperando++;
+
+    for (;;)
+    {
+        double agora = agoraSegundos();
+        recarregarBaldes(ag, agora);
+
+        // Um prompt maior que o balde inteiro nunca caberia - limita ao máximo
+        double custo = custoTokens < ag->limiteTok ? custoTokens : ag->limiteTok;
+        int podeSair = prioridade == PRIORIDADE_MESA || ag->mesasEsperando == 0;
+
+        if (podeSair && agora >= ag->bloqueadoAte && ag->requisicoes >= 1.0 && ag->tokens >= custo)
+        {
+            ag->requisicoes -= 1.0;
+            ag->tokens -= custo;
+            break;
+        }
+        if (prazo > 0 && agora >= prazo)
+        {
+            desistiu = 1;
+            break;
+        }
+
+        // Calcula quanto falta para o balde mais vazio ter fichas suficientes
+        double espera = 0.05;
+        if (podeSair)
+        {
+            if (ag->bloqueadoAte - agora > espera)
+                espera = ag->bloqueadoAte - agora;
+            if ((1.0 - ag->requisicoes) * 60.0 / ag->limiteReq > espera)
+                espera = (1.0 - ag->requisicoes) * 60.0 / ag->limiteReq;
+            if ((custo - ag->tokens) * 60.0 / ag->limiteTok > espera)
+                espera = (custo - ag->tokens) * 60.0 / ag->limiteTok;
+        }
+        if (prazo > 0 && prazo - agora < espera)
+            espera = prazo - agora;
+
+        struct timespec limite;
+        clock_gettime(CLOCK_REALTIME, &limite);
+        long ns = limite.tv_nsec + (long)((espera - (long)espera) * 1e9);
+        limite.tv_sec += (time_t)espera + ns / 1000000000L;
+        limite.tv_nsec = ns % 1000000000L;
+        pthread_cond_timedwait(&ag->liberado, &ag->trava, &limite);
+    }
+
+    if (prioridade == PRIORIDADE_MESA)
+        ag->mesasEsperando--;
+    pthread_cond_broadcast(&ag->liberado);
+    pthread_mutex_unlock(&ag->trava);
+    return desistiu ? -1.0 : agoraSegundos() - inicio;
+}
+
+// Ajusta os baldes com o que a API informou nos cabeçalhos da resposta
+// O servidor é a fonte da verdade: se ele diz que restam menos fichas, acredita nele
+void atualizarAgendador(Agendador *ag, const LimitesResposta *lim, long status)
+{
+    pthread_mutex_lock(&ag->trava);
+    double agora = agoraSegundos();
+    recarregarBaldes(ag, agora);
+
+    if (lim->restantesReq >= 0 && lim->restantesReq < ag->requisicoes)
+        ag->requisicoes = lim->restantesReq;
+    if (lim->restantesTok >= 0 && lim->restantesTok < ag->tokens)
+        ag->tokens = lim->restantesTok;
+    if (lim->restantesReq == 0 && lim->resetReq > 0 && agora + lim->resetReq > ag->bloqueadoAte)
+        ag->bloqueadoAte = agora + lim->resetReq;
+    if (lim->restantesTok == 0 && lim->resetTok > 0 && agora + lim->resetTok > ag->bloqueadoAte)
+        ag->bloqueadoAte = agora + lim->resetTok;
+
+    // 429: ninguém sai até o tempo pedido pelo servidor (evita rajadas de 429)
+    if (status == 429)
+    {
+        double pausa = lim->retryAfter > 0 ? lim->retryAfter : (lim->resetReq > 0 ? lim->resetReq : 2.0);
+        if (agora + pausa > ag->bloqueadoAte)
+            ag->bloqueadoAte = agora + pausa;
+        ag->requisicoes = 0;
+    }
+    pthread_cond_broadcast(&ag->liberado);
+    pthread_mutex_unlock(&ag->trava);
+}
+
+// Lê um bloco "<tamanho>\n<bytes>\n" da fita; tamanho -1 = NULL
+static char *lerBlocoFita(FILE *f, long tamanho)
+{
+    if (tamanho < 0)
+        return NULL;
+    char *texto = malloc(tamanho + 1);
+    if (!texto || fread(texto, 1, tamanho, f) != (size_t)tamanho)
+    {
+        free(texto);
+        return NULL;
+    }
+    texto[tamanho] = '\0';
+    fgetc(f); // quebra de linha após o bloco
+    return texto;
+}
+
+// Configura a fita; no modo REPRODUZIR carrega todas as entradas do arquivo,
+// no modo GRAVAR esvazia o arquivo (regravar não pode deixar respostas antigas
+// na frente das novas, que a reprodução devolveria primeiro)
+// Formato de cada entrada:
+//   PROMPT <bytes>\n<prompt>\n
+//   RESPOSTA <latencia_ms> <bytes ou -1>\n<resposta>\n
+int configurarFita(Fita *ft, ModoFita modo, const char *arquivo, int respeitarLatencia)
+{
+    ft->modo = modo;
+    ft->respeitarLatencia = respeitarLatencia;
+    strncpy(ft->arquivo, arquivo, sizeof(ft->arquivo) - 1);
+    ft->arquivo[sizeof(ft->arquivo) - 1] = '\0';
+    if (modo == FITA_GRAVAR)
+    {
+        FILE *f = fopen(arquivo, "wb");
+        if (!f)
+            return 0;
+        fclose(f);
+        return 1;
+    }
+    if (modo != FITA_REPRODUZIR)
+        return 1;
+
+    FILE *f = fopen(arquivo, "rb");
+    if (!f)
+        return 0;
+
+    long tamPrompt, tamResposta;
+    double latenciaMs;
+    while (fscanf(f, "PROMPT %ld\n", &tamPrompt) == 1)
+    {
+        char *prompt = lerBlocoFita(f, tamPrompt);
+        if (!prompt || fscanf(f, "RESPOSTA %lf %ld\n", &latenciaMs, &tamResposta) != 2)
+        {
+            free(prompt);
+            break;
+        }
+        if (ft->quantidade == ft->capacidade)
+        {
+            ft->capacidade = ft->capacidade ? ft->capacidade * 2 : 64;
+            ft->entradas = realloc(ft->entradas, ft->capacidade * sizeof(EntradaFita));
+        }
+        ft->entradas[ft->quantidade++] = (EntradaFita){prompt, lerBlocoFita(f, tamResposta), latenciaMs / 1000.0, 0};
+    }
+    fclose(f);
+    printf("[FITA] %d chamadas carregadas de %s\n", ft->quantidade, arquivo);
+    return 1;
+}
+
+// Procura a resposta gravada para o prompt (na ordem em que foi gravada)
+// Quando todas as cópias já foram usadas, volta a reutilizar a primeira
+char *reproduzirFita(Fita *ft, const char *prompt)
+{
+    pthread_mutex_lock(&ft->trava);
+    EntradaFita *achada = NULL;
+    for (int i = 0; i < ft->quantidade && !achada; i++)
+        if (!ft->entradas[i].usada && strcmp(ft->entradas[i].prompt, prompt) == 0)
+            achada = &ft->entradas[i];
+    for (int i = 0; i < ft->quantidade && !achada; i++)
+        if (strcmp(ft->entradas[i].prompt, prompt) == 0)
+            achada = &ft->entradas[i];
+
+    char *resposta = NULL;
+    double latencia = 0;
+    if (achada)
+    {
+        achada->usada = 1;
+        resposta = achada->resposta ? strdup(achada->resposta) : NULL;
+        latencia = achada->latencia;
+        ft->acertos++;
+    }
+    else
+        ft->faltas++;
+    pthread_mutex_unlock(&ft->trava);
+
+    if (ft->respeitarLatencia)
+        dormirSegundos(latencia);
+    return resposta;
+}
+
+// Acrescenta uma chamada real ao arquivo da fita (gravada na hora)
+void gravarFita(Fita *ft, const char *prompt, const char *resposta, double latencia)
+{
+    pthread_mutex_lock(&ft->trava);
+    FILE *f = fopen(ft->arquivo, "ab");
+    if (f)
+    {
+        fprintf(f, "PROMPT %ld\n%s\n", (long)strlen(prompt), prompt);
+        fprintf(f, "RESPOSTA %.3f %ld\n%s\n", latencia * 1000.0,
+                resposta ? (long)strlen(resposta) : -1L, resposta ? resposta : "");
+        fclose(f);
+    }
+    pthread_mutex_unlock(&ft->trava);
+}
+
+// Tamanho de cada trecho do prompt pelo conjunto de peças: cada peça ocupa até
+// 9 caracteres ("[12|12], ") e cada número aparece no máximo uma vez nas
+// listas de vazios (", 12") e de chances (" 12=100%")
+#define TAMANHO_PECAS_PROMPT (NUM_PECAS * 9 + 3)
+#define TAMANHO_VAZIOS_PROMPT (48 + NUM_PONTOS * 4)
+#define TAMANHO_CHANCES_PROMPT (48 + NUM_PONTOS * 9)
+#define TAMANHO_PROMPT_IA (1024 + TAMANHO_PECAS_PROMPT + TAMANHO_VAZIOS_PROMPT + TAMANHO_CHANCES_PROMPT)
+
+// Constrói o prompt contextualizado para enviar à IA
+// Inclui as peças disponíveis e o estado atual do tabuleiro
+// Monta o prompt a partir da mão já escrita ("[a|b], [c|d]"), das pontas
+// (esquerda < 0 = mesa vazia), da crença sobre o adversário e das peças que a
+// IA não vê. Serve à mesa da janela e à política do modelo no simulador.
+static void escreverPromptIA(char *prompt, size_t tamanho, const char *pecas, int esquerda, int direita,
+                             const Crenca *crenca, MascaraPecas ocultas)
+{
+    char temp[64];
+
+    // O que a IA já sabe do adversário pelas compras e passes dele
+    char vazios[TAMANHO_VAZIOS_PROMPT] = "";
+    MascaraPontos certos = vaziosCertosCrenca(crenca);
+    for (int p = 0; p < NUM_PONTOS; p++)
+        if (certos & (1u << p))
+        {
+            snprintf(temp, 64, "%s%d", vazios[0] ? ", " : "\nAdversario NAO tem pecas com: ", p);
+            strcat(vazios, temp);
+        }
+
+    // Chance exata de o adversário ter peça com cada número (para seguir nessa ponta)
+    char chances[TAMANHO_CHANCES_PROMPT] = "";
+    for (int p = 0; esquerda >= 0 && p < NUM_PONTOS; p++)
+    {
+        snprintf(temp, 64, "%s%d=%.0f%%", chances[0] ? " " : "\nChance do adversario ter o numero: ", p,
+                 100.0 * probabilidadeSeguirCrenca(crenca, ocultas, (MascaraPontos)(1u << p)));
+        strcat(chances, temp);
+    }
+
+    if (esquerda < 0)
+        snprintf(prompt, tamanho, "DOMINÓ - Mesa vazia\nSuas pecas: %s\n\nEscolha qualquer peca.\nResposta: [numero1|numero2]\nExemplo: [6|4]", pecas);
+    else
+        snprintf(prompt, tamanho, "DOMINÓ\nSuas pecas: %s\nMesa: esquerda=%d direita=%d%s%s\n\nVOCE PRECISA:\n1. Escolher UMA peca sua que tenha o numero %d OU %d\n2. Decidir o lado: E (esquerda) ou D (direita)\n\nCOMO JOGAR:\n- Para jogar na ESQUERDA: sua peca PRECISA ter o numero %d\n- Para jogar na DIREITA: sua peca PRECISA ter o numero %d\n\nEXEMPLO PRATICO:\nSe voce tem [%d|2] e quer jogar na esquerda: [%d|2] E\nSe voce tem [1|%d] e quer jogar na direita: [1|%d] D\n\nResposta (formato obrigatorio): [numero1|numero2] LADO", pecas, esquerda, direita, vazios, chances, esquerda, direita, esquerda, direita, esquerda, esquerda, direita, direita);
+}
+
+char *construirPromptIA(Mao *maoIA, Tabuleiro *tab)
+{
+    static char prompt[TAMANHO_PROMPT_IA];
+    char pecas[TAMANHO_PECAS_PROMPT], temp[64];
+
+    strcpy(pecas, "[");
+
+    for (NoMao *atual = maoIA->pecas; atual; atual = atual->proximo)
+    {
+        snprintf(temp, 64, "%s[%d|%d]", pecas[1] ? ", " : "", atual->peca.lado1, atual->peca.lado2);
+        strcat(pecas, temp);
+    }
+    strcat(pecas, "]");
+
+    Crenca crenca;
+    crencaDoHistorico(&historico, 2, &crenca);
+    MascaraPecas ocultas = TODAS_PECAS;
+    for (NoMao *atual = maoIA->pecas; atual; atual = atual->proximo)
+        ocultas &= ~BIT_PECA(indicePeca[atual->peca.lado1][atual->peca.lado2]);
+    for (No *atual = tab->inicio; atual; atual = atual->prox)
+        ocultas &= ~BIT_PECA(indicePeca[atual->peca.lado1][atual->peca.lado2]);
+
+    escreverPromptIA(prompt, sizeof(prompt), pecas, tab->inicio ? tab->pontoInicio : -1, tab->pontoFim, &crenca, ocultas);
+    return prompt;
+}
+
+// O mesmo prompt a partir do estado compacto, do ponto de vista de quem tem a vez.
+// Sem crença (NULL), o adversário é tratado como uma mão qualquer do tamanho dela.
+void construirPromptMotor(const EstadoMotor *e, const Crenca *crenca, char *prompt, size_t tamanho)
+{
+    char pecas[TAMANHO_PECAS_PROMPT] = "[", temp[64];
+    MascaraPecas mao = e->mao[e->vez];
+    for (int i = 0; i < NUM_PECAS; i++)
+        if (mao & BIT_PECA(i))
+        {
+            snprintf(temp, 64, "%s[%d|%d]", pecas[1] ? ", " : "", pecaMotor[i].lado1, pecaMotor[i].lado2);
+            strcat(pecas, temp);
+        }
+    strcat(pecas, "]");
+
+    Crenca semCrenca;
+    if (!crenca)
+    {
+        iniciarCrenca(&semCrenca, contarPecas(e->mao[e->vez ^ 1]));
+        crenca = &semCrenca;
+    }
+    escreverPromptIA(prompt, tamanho, pecas, e->pontas[0], e->pontas[1], crenca, TODAS_PECAS & ~mao & ~e->mesa);
+}
+
+// Mede os bytes da última transferência: cabeçalhos + corpo enviados e recebidos
+// O corpo recebido é contado comprimido (como veio na rede) e descomprimido
+void registrarBytesRede(CURL *curl, size_t descomprimido)
+{
+    long cabecalhoEnviado = 0, cabecalhoRecebido = 0;
+    curl_off_t corpoEnviado = 0, corpoRecebido = 0;
+    curl_easy_getinfo(curl, CURLINFO_REQUEST_SIZE, &cabecalhoEnviado);
+    curl_easy_getinfo(curl, CURLINFO_HEADER_SIZE, &cabecalhoRecebido);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_UPLOAD_T, &corpoEnviado);
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &corpoRecebido);
+
+    long long enviados = cabecalhoEnviado + (long long)corpoEnviado;
+    long long recebidos = cabecalhoRecebido + (long long)corpoRecebido;
+    printf("[IA] Rede: %lld bytes enviados, %lld recebidos (corpo %lld -> %zu descomprimido)\n",
+           enviados, recebidos, (long long)corpoRecebido, descomprimido);
+
+    pthread_mutex_lock(&estatisticasRede.trava);
+    estatisticasRede.chamadas++;
+    estatisticasRede.enviados += enviados;
+    estatisticasRede.recebidos += recebidos;
+    estatisticasRede.descomprimidos += descomprimido;
+    pthread_mutex_unlock(&estatisticasRede.trava);
+}
+
+// Requisição HTTP para API Groq (libcurl + cJSON)
+// Passa pelo agendador antes de cada tentativa; em 429 espera e tenta de novo
+char *chamarGroqAPI(const char *prompt, PrioridadeAPI prioridade)
+{
+    if (fita.modo == FITA_REPRODUZIR)
+        return reproduzirFita(&fita, prompt);
+
+    CURL *curl;
+    CURLcode res;
+    HttpResponse chunk = {0};
+    chunk.data = malloc(1);
+    chunk.size = 0;
+
+    curl = curl_easy_init();
+    if (!curl)
+    {
+        free(chunk.data);
+        return NULL;
+    }
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON *messages = cJSON_CreateArray();
+
+    cJSON *system_msg = cJSON_CreateObject();
+    cJSON_AddItemToObject(system_msg, "role", cJSON_CreateString("system"));
+    cJSON_AddItemToObject(system_msg, "content", cJSON_CreateString("Voce e um jogador expert de dominó. Analise as pecas disponiveis e escolha a melhor jogada possivel. Responda APENAS no formato [numero1|numero2] LADO. Nao explique, nao justifique, apenas responda."));
+    cJSON_AddItemToArray(messages, system_msg);
+
+    cJSON *user_msg = cJSON_CreateObject();
+    cJSON_AddItemToObject(user_msg, "role", cJSON_CreateString("user"));
+    cJSON_AddItemToObject(user_msg, "content", cJSON_CreateString(prompt));
+    cJSON_AddItemToArray(messages, user_msg);
+
+    cJSON_AddItemToObject(root, "model", cJSON_CreateString(modeloGroq));
+    cJSON_AddItemToObject(root, "messages", messages);
+    cJSON_AddItemToObject(root, "temperature", cJSON_CreateNumber(0.0));
+    cJSON_AddItemToObject(root, "max_tokens", cJSON_CreateNumber(GROQ_MAX_TOKENS));
+    cJSON_AddItemToObject(root, "top_p", cJSON_CreateNumber(1.0));
+
+    // JSON compacto (sem indentação) - o corpo vai inteiro pela rede a cada jogada
+    char *json_str = cJSON_PrintUnformatted(root);
+
+    // Cabeçalhos enxutos: sem "Accept: */*" e sem "Expect: 100-continue",
+    // que custaria uma ida e volta extra antes de enviar o corpo
+    struct curl_slist *headers = NULL;
+    char auth_header[512];
+    snprintf(auth_header, sizeof(auth_header), "Authorization: Bearer %s", GROQ_API_KEY);
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = curl_slist_append(headers, auth_header);
+    headers = curl_slist_append(headers, "Accept:");
+    headers = curl_slist_append(headers, "Expect:");
+
+    LimitesResposta limites;
+    curl_easy_setopt(curl, CURLOPT_URL, urlGroq);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, json_str);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, (void *)&chunk);
+    curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, header_callback);
+    curl_easy_setopt(curl, CURLOPT_HEADERDATA, (void *)&limites);
+    // "" = anuncia todas as codificações que a libcurl suporta (gzip, br, zstd)
+    // e descomprime a resposta automaticamente
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+
+    // O teto vale para a jogada inteira: espera do agendador, tentativas e rede
+    int custo = estimarTokens(prompt);
+    long status = 0;
+    double latencia = 0, prazo = agoraSegundos() + tetoGroq;
+    res = CURLE_OPERATION_TIMEDOUT;
+    for (int tentativa = 0; tentativa < GROQ_TENTATIVAS; tentativa++)
+    {
+        double espera = aguardarAgendador(&agendador, custo, prioridade, prazo);
+        if (espera < 0)
+        {
+            printf("[IA] Teto de %.1fs esgotado esperando o limite da API\n", tetoGroq);
+            break;
+        }
+        if (espera > 0.1)
+            printf("[IA] Aguardou %.2fs pelo limite da API\n", espera);
+        long restante = (long)((prazo - agoraSegundos()) * 1000.0);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, restante > 1 ? restante : 1L);
+
+        limites = (LimitesResposta){-1, -1, -1, -1, -1};
+        chunk.size = 0;
+        chunk.data[0] = '\0';
+        double inicio = agoraSegundos();
+        res = curl_easy_perform(curl);
+        latencia += agoraSegundos() - inicio;
+        if (res != CURLE_OK)
+            break;
+
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &status);
+        atualizarAgendador(&agendador, &limites, status);
+        if (status != 429)
+            break;
+        printf("[IA] API respondeu 429 - tentativa %d de %d\n", tentativa + 1, GROQ_TENTATIVAS);
+    }
+
+    char *response = NULL;
+    if (res == CURLE_OK && status != 429)
+    {
+        response = strdup(chunk.data);
+    }
+    if (res == CURLE_OK)
+        registrarBytesRede(curl, chunk.size);
+    if (fita.modo == FITA_GRAVAR)
+        gravarFita(&fita, prompt, response, latencia);
+
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+    cJSON_Delete(root);
+    free(json_str);
+    free(chunk.data);
+
+    return response;
+}
+
+// Extrai a jogada da resposta JSON da API Groq
+int parseResposta(const char *json_response, Peca *peca, char *lado)
+{
+    if (!json_response)
+        return 0;
+    cJSON *root = cJSON_Parse(json_response);
+    if (!root)
+        return 0;
+
+    // Navega na estrutura JSON para obter a mensagem da IA
+    cJSON *message = cJSON_GetObjectItem(cJSON_GetArrayItem(
+                                             cJSON_GetObjectItem(root, "choices"), 0),
+                                         "message");
+
+    if (!message)
+    {
+        cJSON_Delete(root);
+        return 0;
+    }
+
+    cJSON *content = cJSON_GetObjectItem(message, "content");
+    const char *resposta = NULL;
+
+    if (content && cJSON_IsString(content) && strlen(content->valuestring) > 0)
+    {
+        resposta = content->valuestring;
+    }
+    else
+    {
+
+        cJSON *reasoning = cJSON_GetObjectItem(message, "reasoning");
+        if (reasoning && cJSON_IsString(reasoning))
+        {
+            resposta = reasoning->valuestring;
+        }
+    }
+
+    if (!resposta || strlen(resposta) == 0)
+    {
+        cJSON_Delete(root);
+        return 0;
+    }
+
+    int lado1, lado2;
+    char lado_char, lado_str[20];
+
+    // Tenta parsear diferentes formatos de resposta: [6|4] E, [6|4] esquerda, [6|4]
+    if (sscanf(resposta, "[%d|%d] %c", &lado1, &lado2, &lado_char) == 3)
+    {
+        *peca = (Peca){lado1, lado2};
+        *lado = (lado_char == 'E' || lado_char == 'e') ? 'E' : 'D';
+    }
+    else if (sscanf(resposta, "[%d|%d] %19s", &lado1, &lado2, lado_str) == 3)
+    {
+        *peca = (Peca){lado1, lado2};
+        *lado = (strstr(lado_str, "esq") || lado_str[0] == 'E' || lado_str[0] == 'e') ? 'E' : 'D';
+    }
+    else if (sscanf(resposta, "[%d|%d]", &lado1, &lado2) == 2)
+    {
+        *peca = (Peca){lado1, lado2};
+        *lado = 'D';
+    }
+    else
+    {
+        cJSON_Delete(root);
+        return 0;
+    }
+
+    cJSON_Delete(root);
+    return 1;
+}
+
+// ===== Torneio entre políticas =====
+// Todos contra todos: cada confronto joga 'pares' pares de partidas (mesma
+// distribuição, lugares trocados) e o par k usa a mesma semente em todos os
+// confrontos. Cada tarefa da fila é um par; as threads pegam a próxima por um
+// contador atômico, então as políticas lentas (modelo, MCTS) não deixam
+// threads paradas no fim. Cada partida vai para o arquivo assim que termina.
+
+// Política do modelo de linguagem: o mesmo prompt e o mesmo parse da mesa,
+// a partir do estado compacto. Sem resposta ou com jogada inválida, cai na
+// primeira jogada legal, como o fallback da janela.
+typedef struct
+{
+    _Atomic long long chamadas, invalidas;
+} ConfigModelo;
+
+ConfigModelo configModelo;
+
+Lance politicaModelo(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    ConfigModelo *cfg = (ConfigModelo *)config;
+    Lance lances[MAX_LANCES];
+    int n = gerarLances(e, lances);
+    if (n == 1 || lances[0].peca < 0)
+        return lances[0]; // sem escolha: nem pergunta
+
+    char prompt[TAMANHO_PROMPT_IA];
+    construirPromptMotor(e, crenca, prompt, sizeof(prompt));
+    char *resposta = chamarGroqAPI(prompt, PRIORIDADE_FUNDO);
+    Peca peca;
+    char lado = 'D';
+    int ok = parseResposta(resposta, &peca, &lado);
+    free(resposta);
+    atomic_fetch_add(&cfg->chamadas, 1);
+
+    if (ok && peca.lado1 >= 0 && peca.lado1 <= MAX_PONTO && peca.lado2 >= 0 && peca.lado2 <= MAX_PONTO)
+    {
+        // O lado pedido, se for legal; senão o outro lado da mesma peça
+        int p = indicePeca[peca.lado1][peca.lado2], achado = -1;
+        for (int i = 0; i < n; i++)
+            if (lances[i].peca == p && (achado < 0 || lances[i].lado == (lado == 'E' ? 0 : 1)))
+                achado = i;
+        if (achado >= 0)
+            return lances[achado];
+    }
+    atomic_fetch_add(&cfg->invalidas, 1);
+    return politicaPrimeira(e, crenca, NULL, semente);
+}
+
+// Competidores: as políticas do simulador e o modelo, que depende da API
+Politica politicaModeloTorneio = {"modelo", politicaModelo, &configModelo};
+
+Politica *acharCompetidor(const char *nome)
+{
+    return strcmp(nome, politicaModeloTorneio.nome) == 0 ? &politicaModeloTorneio : acharPolitica(nome);
+}
+
+#define MAX_TORNEIO 16
+#define AMOSTRAS_BOOTSTRAP 1000
+
+// Cronômetro em volta de uma política: mede o tempo por lance de cada competidor
+typedef struct
+{
+    Politica *base;
+    _Atomic long long nanossegundos, lances;
+} Cronometro;
+
+Lance politicaCronometrada(const EstadoMotor *e, const Crenca *crenca, void *config, uint64_t *semente)
+{
+    Cronometro *c = (Cronometro *)config;
+    double inicio = agoraSegundos();
+    Lance l = c->base->escolher(e, crenca, c->base->config, semente);
+    atomic_fetch_add(&c->nanossegundos, (long long)((agoraSegundos() - inicio) * 1e9));
+    atomic_fetch_add(&c->lances, 1);
+    return l;
+}
+
+typedef struct
+{
+    int n, pares, numConfrontos;
+    Politica competidores[MAX_TORNEIO]; // cronometrados
+    Cronometro cronometros[MAX_TORNEIO];
+    int confronto[MAX_TORNEIO * (MAX_TORNEIO - 1) / 2][2];
+    uint8_t *porPar;   // [c * pares + k]: meios pontos do primeiro do confronto c no par k (0 a 4)
+    uint64_t semente;
+    _Atomic long long proxima, feitas;
+    FILE *saida;
+    pthread_mutex_t trava; // protege o arquivo
+} Torneio;
+
+static void *trabalharTorneio(void *arg)
+{
+    Torneio *t = *(Torneio **)arg;
+    long long tarefas = (long long)t->numConfrontos * t->pares, tarefa;
+    long long passo = tarefas / 10 > 0 ? tarefas / 10 : 1;
+
+    // Tarefa = par k do confronto c, intercaladas para que o arquivo cubra
+    // todos os confrontos desde o começo
+    while ((tarefa = atomic_fetch_add(&t->proxima, 1)) < tarefas)
+    {
+        int c = (int)(tarefa % t->numConfrontos), k = (int)(tarefa / t->numConfrontos);
+        int a = t->confronto[c][0], b = t->confronto[c][1], doPar = 0;
+        for (int troca = 0; troca < 2; troca++)
+        {
+            int lugar[2] = {troca ? b : a, troca ? a : b};
+            Politica *jogadores[2] = {&t->competidores[lugar[0]], &t->competidores[lugar[1]]};
+            EstadoMotor final;
+            double inicio = agoraSegundos();
+            int fim = simularPartidaMotor(jogadores, t->semente + k, &final);
+            double segundos = agoraSegundos() - inicio;
+            doPar += fim == 3 ? 1 : (((fim == 1) != troca) ? 2 : 0);
+
+            pthread_mutex_lock(&t->trava);
+            fprintf(t->saida, "%d,%d,%d,%s,%s,%s,%d,%d,%.4f\n", c, k, troca, jogadores[0]->nome, jogadores[1]->nome,
+                    fim == 3 ? "empate" : jogadores[fim - 1]->nome, pontosFinaisMotor(&final, 0),
+                    pontosFinaisMotor(&final, 1), segundos);
+            fflush(t->saida);
+            pthread_mutex_unlock(&t->trava);
+        }
+        t->porPar[(size_t)c * t->pares + k] = (uint8_t)doPar;
+        long long feitas = atomic_fetch_add(&t->feitas, 1) + 1;
+        if (feitas % passo == 0)
+            printf("  %lld/%lld pares\n", feitas, tarefas);
+    }
+    return NULL;
+}
+
+// Bradley-Terry pelo algoritmo MM (Hunter, 2004): força g_i com
+// P(i vence j) = g_i / (g_i + g_j), empate = meia vitória. Cada confronto
+// recebe um empate fictício para que ninguém fique com força zero ou
+// infinita. 'pontos' são os meios pontos do primeiro de cada confronto;
+// 'elo' sai na escala Elo, com o competidor 0 em zero.
+static void ajustarBradleyTerry(const Torneio *t, const long long *pontos, double *elo)
+{
+    double vitorias[MAX_TORNEIO] = {0}, jogos[MAX_TORNEIO][MAX_TORNEIO] = {{0}}, g[MAX_TORNEIO];
+    for (int c = 0; c < t->numConfrontos; c++)
+    {
+        int a = t->confronto[c][0], b = t->confronto[c][1];
+        double partidas = 2.0 * t->pares + 1, deA = pontos[c] / 2.0 + 0.5;
+        vitorias[a] += deA;
+        vitorias[b] += partidas - deA;
+        jogos[a][b] = jogos[b][a] = partidas;
+    }
+    for (int i = 0; i < t->n; i++)
+        g[i] = 1.0;
+    for (int iteracao = 0; iteracao < 10000; iteracao++)
+    {
+        double maior = 0, logSoma = 0;
+        for (int i = 0; i < t->n; i++)
+        {
+            double denominador = 0;
+            for (int j = 0; j < t->n; j++)
+                if (j != i)
+                    denominador += jogos[i][j] / (g[i] + g[j]);
+            double novo = vitorias[i] / denominador;
+            maior = fmax(maior, fabs(log(novo / g[i])));
+            g[i] = novo;
+        }
+        for (int i = 0; i < t->n; i++)
+            logSoma += log(g[i]);
+        for (int i = 0; i < t->n; i++)
+            g[i] /= exp(logSoma / t->n);
+        if (maior < 1e-10)
+            break;
+    }
+    for (int i = 0; i < t->n; i++)
+        elo[i] = 400.0 * log10(g[i] / g[0]);
+}
+
+static int compararDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Tabela de ratings: Bradley-Terry nos resultados e intervalo de confiança de
+// 95% por bootstrap dos pares (cada confronto reamostra os seus pares, o que
+// respeita a correlação entre as duas partidas da mesma distribuição)
+static void imprimirRatings(const Torneio *t)
+{
+    long long pontos[MAX_TORNEIO * (MAX_TORNEIO - 1) / 2];
+    double elo[MAX_TORNEIO], amostra[MAX_TORNEIO];
+    double *amostras = malloc((size_t)AMOSTRAS_BOOTSTRAP * t->n * sizeof(double));
+    if (!amostras)
+        return;
+    for (int c = 0; c < t->numConfrontos; c++)
+    {
+        pontos[c] = 0;
+        for (int k = 0; k < t->pares; k++)
+            pontos[c] += t->porPar[(size_t)c * t->pares + k];
+    }
+    ajustarBradleyTerry(t, pontos, elo);
+
+    uint64_t sorteio = t->semente ^ 0xB0075;
+    for (int s = 0; s < AMOSTRAS_BOOTSTRAP; s++)
+    {
+        long long reamostra[MAX_TORNEIO * (MAX_TORNEIO - 1) / 2];
+        for (int c = 0; c < t->numConfrontos; c++)
+        {
+            reamostra[c] = 0;
+            for (int k = 0; k < t->pares; k++)
+                reamostra[c] += t->porPar[(size_t)c * t->pares + aleatorioAte(&sorteio, t->pares)];
+        }
+        ajustarBradleyTerry(t, reamostra, amostra);
+        for (int i = 0; i < t->n; i++)
+            amostras[(size_t)i * AMOSTRAS_BOOTSTRAP + s] = amostra[i];
+    }
+
+    // Placar total e ordem pela força
+    double placar[MAX_TORNEIO] = {0};
+    int ordem[MAX_TORNEIO];
+    for (int c = 0; c < t->numConfrontos; c++)
+    {
+        placar[t->confronto[c][0]] += pontos[c];
+        placar[t->confronto[c][1]] += 4.0 * t->pares - pontos[c];
+    }
+    for (int i = 0; i < t->n; i++)
+    {
+        ordem[i] = i;
+        qsort(&amostras[(size_t)i * AMOSTRAS_BOOTSTRAP], AMOSTRAS_BOOTSTRAP, sizeof(double), compararDouble);
+    }
+    for (int i = 1; i < t->n; i++)
+        for (int j = i; j > 0 && elo[ordem[j]] > elo[ordem[j - 1]]; j--)
+        {
+            int aux = ordem[j];
+            ordem[j] = ordem[j - 1];
+            ordem[j - 1] = aux;
+        }
+
+    printf("\nRatings (Bradley-Terry na escala Elo, %s = 0; IC 95%% por bootstrap de %d amostras):\n",
+           t->competidores[0].nome, AMOSTRAS_BOOTSTRAP);
+    printf(" #  %-14s %8s %20s %8s %10s\n", "politica", "Elo", "IC 95%", "placar", "ms/lance");
+    for (int p = 0; p < t->n; p++)
+    {
+        int i = ordem[p];
+        const double *a = &amostras[(size_t)i * AMOSTRAS_BOOTSTRAP];
+        long long lances = atomic_load(&t->cronometros[i].lances);
+        printf("%2d  %-14s %+8.1f   [%+7.1f, %+7.1f] %7.1f%% %10.4f\n", p + 1, t->competidores[i].nome,
+               fabs(elo[i]) < 0.05 ? 0.0 : elo[i],
+               a[(int)(0.025 * AMOSTRAS_BOOTSTRAP)], a[(int)(0.975 * AMOSTRAS_BOOTSTRAP) - 1],
+               100.0 * placar[i] / (4.0 * t->pares * (t->n - 1)),
+               lances > 0 ? atomic_load(&t->cronometros[i].nanossegundos) / 1e6 / lances : 0.0);
+    }
+
+    // Placar de cada linha contra cada coluna
+    printf("\nPlacar (linha contra coluna, %%):\n%-14s", "");
+    for (int p = 0; p < t->n; p++)
+        printf(" %7.7s", t->competidores[ordem[p]].nome);
+    printf("\n");
+    for (int p = 0; p < t->n; p++)
+    {
+        int i = ordem[p];
+        printf("%-14s", t->competidores[i].nome);
+        for (int q = 0; q < t->n; q++)
+        {
+            int j = ordem[q];
+            double x = -1;
+            for (int c = 0; c < t->numConfrontos; c++)
+                if (t->confronto[c][0] == i && t->confronto[c][1] == j)
+                    x = pontos[c] / (4.0 * t->pares);
+                else if (t->confronto[c][0] == j && t->confronto[c][1] == i)
+                    x = 1.0 - pontos[c] / (4.0 * t->pares);
+            if (x < 0)
+                printf(" %7s", "-");
+            else
+                printf(" %7.1f", 100.0 * x);
+        }
+        printf("\n");
+    }
+    free(amostras);
+}
+
+int jogarTorneio(Politica **lista, int n, int pares, int threads, uint64_t semente, const char *arquivo)
+{
+    if (n < 2 || n > MAX_TORNEIO || pares < 1 || threads < 1)
+        return 1;
+    Torneio *t = calloc(1, sizeof(Torneio));
+    if (!t)
+        return 1;
+    t->n = n;
+    t->pares = pares;
+    t->semente = semente;
+    for (int i = 0; i < n; i++)
+    {
+        t->cronometros[i].base = lista[i];
+        t->competidores[i] = (Politica){lista[i]->nome, politicaCronometrada, &t->cronometros[i]};
+        for (int j = i + 1; j < n; j++)
+        {
+            t->confronto[t->numConfrontos][0] = i;
+            t->confronto[t->numConfrontos][1] = j;
+            t->numConfrontos++;
+        }
+    }
+    t->porPar = calloc((size_t)t->numConfrontos * pares, 1);
+    t->saida = fopen(arquivo, "w");
+    if (!t->porPar || !t->saida)
+    {
+        printf("Nao foi possivel criar %s\n", arquivo);
+        if (t->saida)
+            fclose(t->saida);
+        free(t->porPar);
+        free(t);
+        return 1;
+    }
+    pthread_mutex_init(&t->trava, NULL);
+    fprintf(t->saida, "confronto,par,troca,jogador0,jogador1,vencedor,pontos0,pontos1,segundos\n");
+
+    long long partidas = 2LL * t->numConfrontos * pares;
+    printf("Torneio: %d politicas, %d confrontos x %d pares = %lld partidas, %d threads -> %s\n", n,
+           t->numConfrontos, pares, partidas, threads, arquivo);
+    Torneio **args = malloc(threads * sizeof(Torneio *));
+    if (!args)
+    {
+        printf("Nao foi possivel alocar %d threads para o torneio\n", threads);
+        fclose(t->saida);
+        pthread_mutex_destroy(&t->trava);
+        free(t->porPar);
+        free(t);
+        return 1;
+    }
+    for (int i = 0; i < threads; i++)
+        args[i] = t;
+    double inicio = agoraSegundos();
+    executarEmThreads(threads, trabalharTorneio, args, sizeof(Torneio *));
+    double total = agoraSegundos() - inicio;
+    free(args);
+    fclose(t->saida);
+
+    printf("Partidas: %lld em %.1fs (%.0f partidas/s)\n", partidas, total, total > 0 ? partidas / total : 0.0);
+    imprimirRatings(t);
+    for (int i = 0; i < n; i++)
+        if (lista[i] == &politicaModeloTorneio)
+            printf("\nModelo: %lld chamadas, %lld respostas invalidas ou ausentes (jogou a primeira legal)\n",
+                   atomic_load(&configModelo.chamadas), atomic_load(&configModelo.invalidas));
+    pthread_mutex_destroy(&t->trava);
+    free(t->porPar);
+    free(t);
+    return 0;
+}
+
+// ===== Níveis de dificuldade =====
+// Cada nível é um orçamento de computação para a IA: qual motor joga, quanto
+// ele pode buscar, se acompanha o que o humano comprou/passou, se consulta a
+// tablebase e o livro de aberturas (jogo perfeito de graça, que não cabe nos
+// níveis baratos) e se a análise de segundo plano roda. O teto é o tempo máximo de uma jogada da IA: a busca
+// e o MCTS param no prazo e a chamada à API desiste (e cai no fallback local).
+typedef struct
+{
+    const char *nome;
+    MotorIA motor;
+    double teto;        // segundos por jogada
+    int profundidade;   // busca: profundidade máxima
+    int mundos;         // busca: mundos sorteados por jogada
+    int playouts;       // mcts: máximo por jogada (0 = só o tempo)
+    int threads;        // mcts: 0 = todos os núcleos
+    int usarCrenca;     // restringe os mundos pelas compras/passes do humano
+    int tablebase;      // finais resolvidos pela tablebase (se carregada)
+    int livro;          // primeiro lance pelo livro de aberturas (se carregado)
+    int analise;        // análise ao vivo, dicas e análise de erros
+    const char *modelo; // modelo de linguagem (só com MOTOR_GROQ)
+} NivelDificuldade;
+
+// Do mais barato ao mais caro; FACIL quase não usa CPU (quiosques)
+NivelDificuldade niveis[] = {
+    {"FACIL", MOTOR_HEURISTICA, 0.01, 0, 0, 0, 1, 0, 0, 0, 0, NULL},
+    {"MEDIO", MOTOR_BUSCA, 0.1, 4, 4, 0, 1, 1, 0, 0, 1, NULL},
+    {"DIFICIL", MOTOR_MCTS, 0.5, 0, 0, 20000, 0, 1, 1, 1, 1, NULL},
+    {"MESTRE", MOTOR_MCTS, 1.5, 0, 0, 0, 0, 1, 1, 1, 1, NULL},
+    {"IA RAPIDA", MOTOR_GROQ, 4.0, 0, 0, 0, 1, 1, 1, 1, 1, GROQ_MODEL_RAPIDO},
+    {"IA", MOTOR_GROQ, 10.0, 0, 0, 0, 1, 1, 1, 1, 1, GROQ_MODEL},
+};
+#define NUM_NIVEIS ((int)(sizeof(niveis) / sizeof(niveis[0])))
+
+int nivelAtual = NUM_NIVEIS - 1;
+
+// Reconfigura os motores da IA para o orçamento do nível
+void aplicarNivel(int n)
+{
+    const NivelDificuldade *nv = &niveis[n];
+    nivelAtual = n;
+    motorIA = nv->motor;
+    // Só a configuração do motor do nível muda: DOMINO_MOTOR continua com os padrões.
+    // Margem de 10% para a crença, o sorteio dos mundos e o join das threads
+    if (nv->motor == MOTOR_BUSCA)
+    {
+        configBuscaIA.tempoLimite = nv->teto * 0.9;
+        configBuscaIA.profundidadeMax = nv->profundidade;
+        configBuscaIA.mundos = nv->mundos;
+        configBuscaIA.usarCrenca = nv->usarCrenca;
+    }
+    else if (nv->motor == MOTOR_MCTS)
+    {
+        configMctsIA.tempoLimite = nv->teto * 0.9;
+        configMctsIA.maxIteracoes = nv->playouts;
+        configMctsIA.threads = nv->threads;
+        configMctsIA.usarCrenca = nv->usarCrenca;
+    }
+    else if (nv->motor == MOTOR_GROQ)
+    {
+        modeloGroq = nv->modelo;
+        tetoGroq = nv->teto;
+    }
+}
+
+// Nível pelo nome (DOMINO_NIVEL); -1 se não existir
+int nivelPorNome(const char *nome)
+{
+    for (int i = 0; i < NUM_NIVEIS; i++)
+        if (strcasecmp(niveis[i].nome, nome) == 0)
+            return i;
+    return -1;
+}
+
+// ===== Análise ao vivo (chance de vitória do humano e dicas) =====
+// Uma thread em segundo plano joga partidas a partir da posição atual, com as
+// peças ocultas sorteadas do ponto de vista do humano (mundos determinizados)
+// e a heurística jogando pelos dois lados. Com as dicas ligadas, cada lance
+// legal do humano também recebe suas partidas, em rodízio, e a classificação
+// vai ficando mais precisa enquanto durar a vez.
+// O resultado é publicado num seqlock: o laço de desenho lê sem travar e sem
+// esperar a thread. Cada mudança de posição incrementa a versão, o que cancela
+// a análise em andamento; o progresso fica num cache pela chave da posição,
+// então voltar a uma posição (ou religar as dicas) continua de onde parou.
+#define PLAYOUTS_POR_LOTE_AO_VIVO 64
+#define PLAYOUTS_POR_LANCE_AO_VIVO 16 // por lance, em cada volta do rodízio
+#define MAX_PLAYOUTS_AO_VIVO 200000 // depois disso a estimativa já não muda
+#define MAX_PLAYOUTS_DICA 50000
+#define TAM_CACHE_AO_VIVO 64
+
+typedef struct
+{
+    Lance lance;
+    float vitoria; // chance de vitória do humano depois do lance
+    float margem;
+} DicaLance;
+
+typedef struct
+{
+    unsigned versao;   // posição a que o placar se refere
+    unsigned playouts;
+    float vitoria;     // probabilidade de vitória do humano (empate conta meio)
+    float margem;      // diferença de pontos esperada a favor do humano
+    int numDicas;      // lances do humano, do melhor para o pior
+    unsigned playoutsDica;
+    DicaLance dicas[MAX_LANCES];
+} PlacarAoVivo;
+
+// Progresso acumulado de uma posição (só a thread da análise usa)
+typedef struct
+{
+    uint64_t chave;
+    double pontos, margem;
+    unsigned playouts;
+    int numLances;
+    Lance lances[MAX_LANCES];
+    double pontosLance[MAX_LANCES], margemLance[MAX_LANCES];
+    unsigned playoutsLance;
+} EntradaAoVivo;
+
+typedef struct
+{
+    pthread_t thread;
+    pthread_mutex_t trava;
+    pthread_cond_t sinal;
+    int iniciada, encerrar;   // protegidos pela trava
+    EstadoMotor posicao;      // protegidos pela trava
+    Crenca crenca;
+    atomic_uint versao;       // muda a cada posição nova ou pausa
+    atomic_int ativa;         // 0 = nenhuma posição para analisar
+    atomic_int dicas;         // 1 = avaliar também cada lance do humano
+    uint64_t chave;           // última posição publicada (só o laço principal usa)
+    EntradaAoVivo cache[TAM_CACHE_AO_VIVO];
+    // Placar publicado (seqlock: número ímpar = escrita em andamento)
+    atomic_uint sequencia;
+    atomic_uint placarVersao, placarPlayouts, placarPlayoutsDica;
+    _Atomic float placarVitoria, placarMargem;
+    atomic_int placarNumDicas;
+    atomic_uint_least64_t placarDicas[MAX_LANCES]; // DicaLance compactada
+} AnaliseAoVivo;
+
+AnaliseAoVivo analiseAoVivo = {.trava = PTHREAD_MUTEX_INITIALIZER, .sinal = PTHREAD_COND_INITIALIZER};
+
+// Uma dica cabe em 64 bits: peça, lado, vitória em 1/65535 e margem em décimos
+static uint64_t compactarDica(const DicaLance *d)
+{
+    int margem = (int)lrintf(d->margem * 10.0f);
+    margem = margem < -32768 ? -32768 : (margem > 32767 ? 32767 : margem);
+    return (uint64_t)(uint8_t)d->lance.peca | (uint64_t)(uint8_t)d->lance.lado << 8 |
+           (uint64_t)(uint16_t)lrintf(d->vitoria * 65535.0f) << 16 | (uint64_t)(uint16_t)margem << 32;
+}
+
+static DicaLance expandirDica(uint64_t x)
+{
+    DicaLance d;
+    d.lance.peca = (int8_t)(x & 0xFF);
+    d.lance.lado = (int8_t)(x >> 8 & 0xFF);
+    d.vitoria = (float)(x >> 16 & 0xFFFF) / 65535.0f;
+    d.margem = (int16_t)(x >> 32 & 0xFFFF) / 10.0f;
+    return d;
+}
+
+static void publicarPlacarAoVivo(AnaliseAoVivo *a, const PlacarAoVivo *p)
+{
+    unsigned s = atomic_load_explicit(&a->sequencia, memory_order_relaxed);
+    atomic_store_explicit(&a->sequencia, s + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&a->placarVersao, p->versao, memory_order_relaxed);
+    atomic_store_explicit(&a->placarPlayouts, p->playouts, memory_order_relaxed);
+    atomic_store_explicit(&a->placarVitoria, p->vitoria, memory_order_relaxed);
+    atomic_store_explicit(&a->placarMargem, p->margem, memory_order_relaxed);
+    atomic_store_explicit(&a->placarNumDicas, p->numDicas, memory_order_relaxed);
+    atomic_store_explicit(&a->placarPlayoutsDica, p->playoutsDica, memory_order_relaxed);
+    for (int i = 0; i < p->numDicas; i++)
+        atomic_store_explicit(&a->placarDicas[i], compactarDica(&p->dicas[i]), memory_order_relaxed);
+    atomic_store_explicit(&a->sequencia, s + 2, memory_order_release);
+}
+
+// Cópia consistente do último placar publicado (nunca bloqueia)
+PlacarAoVivo lerPlacarAoVivo(AnaliseAoVivo *a)
+{
+    PlacarAoVivo p;
+    unsigned antes, depois;
+    do
+    {
+        antes = atomic_load_explicit(&a->sequencia, memory_order_acquire);
+        p.versao = atomic_load_explicit(&a->placarVersao, memory_order_relaxed);
+        p.playouts = atomic_load_explicit(&a->placarPlayouts, memory_order_relaxed);
+        p.vitoria = atomic_load_explicit(&a->placarVitoria, memory_order_relaxed);
+        p.margem = atomic_load_explicit(&a->placarMargem, memory_order_relaxed);
+        p.numDicas = atomic_load_explicit(&a->placarNumDicas, memory_order_relaxed);
+        p.playoutsDica = atomic_load_explicit(&a->placarPlayoutsDica, memory_order_relaxed);
+        if (p.numDicas < 0 || p.numDicas > MAX_LANCES)
+            p.numDicas = 0; // leitura no meio de uma escrita: o laço repete
+        for (int i = 0; i < p.numDicas; i++)
+            p.dicas[i] = expandirDica(atomic_load_explicit(&a->placarDicas[i], memory_order_relaxed));
+        atomic_thread_fence(memory_order_acquire);
+        depois = atomic_load_explicit(&a->sequencia, memory_order_relaxed);
+    } while ((antes & 1) || antes != depois);
+    return p;
+}
+
+// Uma partida até o fim num mundo sorteado para o humano (jogador 0).
+// Retorna a margem final a favor dele; *resultado recebe fimMotor()
+static int playoutAoVivo(const EstadoMotor *posicao, const Crenca *crenca, uint64_t *semente, int *resultado)
+{
+    // amostrarMundo esconde a mão de quem não está na vez: o humano vira a
+    // vez só para o sorteio, mesmo quando a posição é no turno da IA
+    EstadoMotor visto = *posicao, e;
+    visto.vez = 0;
+    amostrarMundo(&visto, crenca, &e, semente);
+    e.vez = posicao->vez;
+    e.chave = calcularChaveMotor(&e);
+
+    while ((*resultado = fimMotor(&e)) == 0)
+    {
+        Lance l = politicaHeuristica(&e, NULL, &pesosHeuristica, semente);
+        if (l.peca == LANCE_COMPRAR)
+            comprarPecaMotor(&e, sortearPeca(e.monte, semente));
+        else
+            aplicarLance(&e, l);
+    }
+    return pontosFinaisMotor(&e, 1) - pontosFinaisMotor(&e, 0);
+}
+
+static void lotePlayoutsAoVivo(const EstadoMotor *posicao, const Crenca *crenca, int n, uint64_t *semente,
+                               double *pontos, double *margem)
+{
+    for (int i = 0; i < n; i++)
+    {
+        int fim;
+        *margem += playoutAoVivo(posicao, crenca, semente, &fim);
+        *pontos += fim == 1 ? 1.0 : (fim == 3 ? 0.5 : 0.0);
+    }
+}
+
+static int compararDicas(const void *x, const void *y)
+{
+    const DicaLance *a = (const DicaLance *)x, *b = (const DicaLance *)y;
+    if (a->vitoria != b->vitoria)
+        return a->vitoria < b->vitoria ? 1 : -1;
+    return (a->margem < b->margem) - (a->margem > b->margem);
+}
+
+static void publicarEntradaAoVivo(AnaliseAoVivo *a, unsigned versao, const EntradaAoVivo *c)
+{
+    PlacarAoVivo p;
+    p.versao = versao;
+    p.playouts = c->playouts;
+    p.vitoria = c->playouts ? (float)(c->pontos / c->playouts) : 0.5f;
+    p.margem = c->playouts ? (float)(c->margem / c->playouts) : 0.0f;
+    p.numDicas = c->playoutsLance ? c->numLances : 0;
+    p.playoutsDica = c->playoutsLance;
+    for (int i = 0; i < p.numDicas; i++)
+        p.dicas[i] = (DicaLance){c->lances[i], (float)(c->pontosLance[i] / c->playoutsLance),
+                                 (float)(c->margemLance[i] / c->playoutsLance)};
+    qsort(p.dicas, p.numDicas, sizeof(DicaLance), compararDicas);
+    publicarPlacarAoVivo(a, &p);
+}
+
+static EntradaAoVivo *entradaAoVivo(AnaliseAoVivo *a, const EstadoMotor *posicao)
+{
+    EntradaAoVivo *c = &a->cache[posicao->chave % TAM_CACHE_AO_VIVO];
+    if (c->chave != posicao->chave || (!c->playouts && !c->playoutsLance))
+    {
+        memset(c, 0, sizeof(*c));
+        c->chave = posicao->chave;
+        // Só há dicas na vez do humano e com mais de uma escolha
+        if (posicao->vez == 0)
+        {
+            c->numLances = gerarLances(posicao, c->lances);
+            if (c->numLances < 2 || c->lances[0].peca < 0)
+                c->numLances = 0;
+        }
+    }
+    return c;
+}
+
+static void *trabalharAnaliseAoVivo(void *arg)
+{
+    AnaliseAoVivo *a = (AnaliseAoVivo *)arg;
+    uint64_t semente = 0xA0A0 ^ (uint64_t)time(NULL);
+    unsigned analisada = 0;
+
+    for (;;)
+    {
+        EstadoMotor posicao;
+        Crenca crenca;
+        unsigned versao;
+        pthread_mutex_lock(&a->trava);
+        while (!a->encerrar && (!atomic_load(&a->ativa) || (versao = atomic_load(&a->versao)) == analisada))
+            pthread_cond_wait(&a->sinal, &a->trava);
+        if (a->encerrar)
+        {
+            pthread_mutex_unlock(&a->trava);
+            return NULL;
+        }
+        posicao = a->posicao;
+        crenca = a->crenca;
+        pthread_mutex_unlock(&a->trava);
+
+        int dicas = atomic_load(&a->dicas);
+        EntradaAoVivo *c = entradaAoVivo(a, &posicao);
+        publicarEntradaAoVivo(a, versao, c);
+
+        // Lotes curtos: entre um e outro confere se a posição mudou
+        while (atomic_load_explicit(&a->versao, memory_order_relaxed) == versao)
+        {
+            int falta = c->playouts < MAX_PLAYOUTS_AO_VIVO;
+            if (falta)
+            {
+                lotePlayoutsAoVivo(&posicao, &crenca, PLAYOUTS_POR_LOTE_AO_VIVO, &semente, &c->pontos, &c->margem);
+                c->playouts += PLAYOUTS_POR_LOTE_AO_VIVO;
+            }
+            if (dicas && c->numLances && c->playoutsLance < MAX_PLAYOUTS_DICA)
+            {
+                for (int i = 0; i < c->numLances; i++)
+                {
+                    EstadoMotor filho = posicao;
+                    aplicarLance(&filho, c->lances[i]);
+                    lotePlayoutsAoVivo(&filho, &crenca, PLAYOUTS_POR_LANCE_AO_VIVO, &semente, &c->pontosLance[i],
+                                       &c->margemLance[i]);
+                }
+                c->playoutsLance += PLAYOUTS_POR_LANCE_AO_VIVO;
+                falta = 1;
+            }
+            if (!falta)
+                break;
+            publicarEntradaAoVivo(a, versao, c);
+        }
+        analisada = versao;
+    }
+}
+
+// Chamada a cada quadro com estadoDoJogo(): se a posição mudou, cancela a
+// análise anterior e entrega a nova à thread (que é criada na primeira vez)
+void atualizarAnaliseAoVivo(AnaliseAoVivo *a, EstadoMotor e)
+{
+    if (atomic_load_explicit(&a->ativa, memory_order_relaxed) && e.chave == a->chave)
+        return;
+
+    pthread_mutex_lock(&a->trava);
+    if (!a->iniciada)
+        a->iniciada = pthread_create(&a->thread, NULL, trabalharAnaliseAoVivo, a) == 0;
+    a->posicao = e;
+    crencaDoHistorico(&historico, 1, &a->crenca);
+    a->chave = e.chave;
+    atomic_fetch_add(&a->versao, 1);
+    atomic_store(&a->ativa, 1);
+    pthread_cond_signal(&a->sinal);
+    pthread_mutex_unlock(&a->trava);
+}
+
+// Fora da partida (ou no turno da IA, para não disputar núcleos com o MCTS)
+// a thread fica parada esperando uma posição
+void pausarAnaliseAoVivo(AnaliseAoVivo *a)
+{
+    if (!atomic_load_explicit(&a->ativa, memory_order_relaxed))
+        return;
+    pthread_mutex_lock(&a->trava);
+    atomic_store(&a->ativa, 0);
+    atomic_fetch_add(&a->versao, 1);
+    pthread_mutex_unlock(&a->trava);
+}
+
+// Liga/desliga as dicas; a posição é reenviada e o cache guarda o que já foi
+// calculado, então alternar não perde trabalho
+void alternarDicasAoVivo(AnaliseAoVivo *a)
+{
+    atomic_store(&a->dicas, !atomic_load(&a->dicas));
+    pausarAnaliseAoVivo(a);
+}
+
+void encerrarAnaliseAoVivo(AnaliseAoVivo *a)
+{
+    pthread_mutex_lock(&a->trava);
+    a->encerrar = 1;
+    pthread_cond_signal(&a->sinal);
+    int iniciada = a->iniciada;
+    pthread_mutex_unlock(&a->trava);
+    if (iniciada)
+        pthread_join(a->thread, NULL);
+}
+
+// Último placar, se ele for da posição atual
+int placarAtualAoVivo(AnaliseAoVivo *a, PlacarAoVivo *p)
+{
+    *p = lerPlacarAoVivo(a);
+    return atomic_load_explicit(&a->ativa, memory_order_relaxed) &&
+           p->versao == atomic_load_explicit(&a->versao, memory_order_relaxed);
+}
+
+// Melhor dica para a peça (em qualquer lado se lado < 0); as dicas já vêm ordenadas
+const DicaLance *dicaDaPeca(const PlacarAoVivo *p, Peca peca, int lado)
+{
+    int indice = indicePeca[peca.lado1][peca.lado2];
+    for (int i = 0; i < p->numDicas; i++)
+        if (p->dicas[i].lance.peca == indice && (lado < 0 || p->dicas[i].lance.lado == lado))
+            return &p->dicas[i];
+    return NULL;
+}
+
+void desenharAnaliseAoVivo(AnaliseAoVivo *a)
+{
+    PlacarAoVivo p;
+    int x = SCREEN_WIDTH - 440, y = 580;
+    DrawText("CHANCE DE VITORIA", x, y, 18, WHITE);
+    if (!placarAtualAoVivo(a, &p) || p.playouts == 0)
+    {
+        DrawText("calculando...", x, y + 25, 18, LIGHTGRAY);
+        return;
+    }
+    DrawRectangle(x, y + 25, 200, 18, RED);
+    DrawRectangle(x, y + 25, (int)(200 * p.vitoria), 18, GREEN);
+    DrawRectangleLines(x, y + 25, 200, 18, BLACK);
+    DrawText(TextFormat("%.0f%%", 100.0f * p.vitoria), x + 210, y + 25, 18, WHITE);
+    DrawText(TextFormat("Margem esperada: %+.1f pts (%u partidas)", p.margem, p.playouts), x, y + 50, 16, LIGHTGRAY);
+}
+
+// ===== Análise de erros da partida =====
+// No fim da partida o histórico é refeito lance a lance a partir das mãos
+// iniciais (mãos finais + peças jogadas - peças compradas). Cada jogada com
+// mais de uma opção é avaliada pela busca, do ponto de vista de quem jogou
+// (mundos sorteados com a crença que ele tinha naquele momento), e as
+// posições são divididas entre as threads. Uma jogada é um erro quando o
+// melhor lance valia mais que o jogado por mais do que o limiar.
+#define MAX_POSICOES_ANALISE MAX_JOGADAS
+#define MAX_ERROS_ANALISE 6           // os mais graves aparecem na tela de fim
+#define LIMIAR_ERRO_ANALISE (VALOR_VITORIA * 3 / 20) // ~7,5% de chance de vitória
+#define ORCAMENTO_ANALISE 1.0         // segundos para a partida inteira
+
+typedef struct
+{
+    int jogada, jogador; // posição no histórico e quem jogou (1 = humano, 2 = IA)
+    Lance jogado, melhor;
+    int perda;           // valor do melhor lance menos o do jogado
+} ErroPartida;
+
+typedef struct
+{
+    EstadoMotor estado;
+    Crenca crenca;
+    ErroPartida resultado;
+} PosicaoAnalise;
+
+typedef struct
+{
+    pthread_t thread;
+    int iniciada;       // só o laço principal usa
+    atomic_int pronta;  // os campos abaixo só são lidos depois dela
+    Historico historico;
+    EstadoMotor final;
+    int posicoes, numErros;
+    ErroPartida erros[MAX_ERROS_ANALISE];
+    double segundos;
+} AnalisePartida;
+
+typedef struct
+{
+    PosicaoAnalise *posicoes;
+    int quantidade;
+    atomic_int *proxima;
+    ConfigBusca cfg;
+    uint64_t semente;
+} TrabalhoAnalise;
+
+AnalisePartida analisePartida;
+int analisarPartidas = 1; // DOMINO_ANALISE=0 desliga
+
+// Desfaz o histórico sobre o estado final para achar as mãos e o monte do começo
+static void estadoInicialDoHistorico(const Historico *h, const EstadoMotor *final, EstadoMotor *e)
+{
+    memset(e, 0, sizeof(*e));
+    e->mao[0] = final->mao[0];
+    e->mao[1] = final->mao[1];
+    e->monte = final->monte;
+    for (int i = 0; i <= h->topo; i++)
+    {
+        const Jogada *j = &h->jogadas[i];
+        MascaraPecas bit = BIT_PECA(indicePeca[j->peca.lado1][j->peca.lado2]);
+        if (j->tipo == 'J')
+            e->mao[j->jogador - 1] |= bit;
+        else if (j->tipo == 'C')
+        {
+            e->mao[j->jogador - 1] &= ~bit;
+            e->monte |= bit;
+        }
+    }
+    e->pontas[0] = e->pontas[1] = -1;
+    e->vez = h->topo >= 0 ? h->jogadas[0].jogador - 1 : 0;
+    e->chave = calcularChaveMotor(e);
+}
+
+// Lance do motor correspondente a uma jogada do histórico; na mesa vazia ou
+// com pontas iguais o motor só gera um dos lados
+static int lanceDaJogada(const EstadoMotor *e, const Jogada *j, Lance *lances, int n)
+{
+    int peca = indicePeca[j->peca.lado1][j->peca.lado2], lado = (j->lado == 'E' || j->lado == 'e') ? 0 : 1, achou = -1;
+    for (int i = 0; i < n; i++)
+        if (lances[i].peca == peca && (achou < 0 || lances[i].lado == lado))
+            achou = i;
+    return achou;
+}
+
+static void *trabalharAnalisePartida(void *arg)
+{
+    TrabalhoAnalise *t = (TrabalhoAnalise *)arg;
+    Buscador *b = criarBuscador();
+    if (!b)
+        return NULL;
+    int i;
+    while ((i = atomic_fetch_add(t->proxima, 1)) < t->quantidade)
+    {
+        PosicaoAnalise *p = &t->posicoes[i];
+        Lance lances[MAX_LANCES];
+        int valores[MAX_LANCES], melhor = 0;
+        uint64_t semente = misturar64(t->semente + i);
+        int n = avaliarLancesBusca(b, &p->estado, &p->crenca, &t->cfg, &semente, lances, valores, NULL);
+        int jogado = 0;
+        for (int k = 0; k < n; k++)
+        {
+            if (valores[k] > valores[melhor])
+                melhor = k;
+            if (mesmoLance(lances[k], p->resultado.jogado))
+                jogado = k;
+        }
+        p->resultado.melhor = lances[melhor];
+        p->resultado.perda = valores[melhor] - valores[jogado];
+    }
+    liberarBuscador(b);
+    return NULL;
+}
+
+static int compararErros(const void *x, const void *y)
+{
+    return ((const PosicaoAnalise *)y)->resultado.perda - ((const PosicaoAnalise *)x)->resultado.perda;
+}
+
+// Avalia todas as decisões da partida; guarda até maxErros jogadas com perda
+// acima do limiar (da pior para a menos grave) e retorna quantas foram avaliadas
+int analisarHistorico(const Historico *h, const EstadoMotor *final, int limiar, int threads,
+                      ErroPartida *erros, int maxErros, int *numErros)
+{
+    PosicaoAnalise *posicoes = malloc(MAX_POSICOES_ANALISE * sizeof(PosicaoAnalise));
+    Historico *prefixo = malloc(sizeof(Historico));
+    *numErros = 0;
+    if (!posicoes || !prefixo)
+    {
+        free(posicoes);
+        free(prefixo);
+        return 0;
+    }
+
+    EstadoMotor e;
+    estadoInicialDoHistorico(h, final, &e);
+    *prefixo = *h;
+    int n = 0;
+    for (int i = 0; i <= h->topo; i++)
+    {
+        const Jogada *j = &h->jogadas[i];
+        e.vez = j->jogador - 1;
+        if (j->tipo == 'C')
+        {
+            comprarPecaMotor(&e, indicePeca[j->peca.lado1][j->peca.lado2]);
+            continue;
+        }
+        Lance lances[MAX_LANCES];
+        int k = gerarLances(&e, lances), escolhido = j->tipo == 'J' ? lanceDaJogada(&e, j, lances, k) : -1;
+        if (escolhido < 0)
+        {
+            aplicarLance(&e, (Lance){LANCE_PASSAR, 0});
+            continue;
+        }
+        if (k > 1 && n < MAX_POSICOES_ANALISE)
+        {
+            prefixo->topo = i - 1;
+            posicoes[n].estado = e;
+            crencaDoHistorico(prefixo, j->jogador, &posicoes[n].crenca);
+            posicoes[n].resultado = (ErroPartida){i, j->jogador, lances[escolhido], lances[escolhido], 0};
+            n++;
+        }
+        aplicarLance(&e, lances[escolhido]);
+    }
+    free(prefixo);
+
+    // O orçamento da partida é dividido entre as posições de cada thread
+    if (threads < 1)
+        threads = 1;
+    double tempo = n ? ORCAMENTO_ANALISE * threads / n : 0;
+    TrabalhoAnalise *trabalhos = malloc(threads * sizeof(TrabalhoAnalise));
+    atomic_int proxima = 0;
+    if (trabalhos && n)
+    {
+        for (int t = 0; t < threads; t++)
+            trabalhos[t] = (TrabalhoAnalise){posicoes, n, &proxima,
+                                             {40, tempo < 0.01 ? 0.01 : (tempo > 0.25 ? 0.25 : tempo), 8, 1},
+                                             0xA11A ^ final->chave};
+        executarEmThreads(threads, trabalharAnalisePartida, trabalhos, sizeof(TrabalhoAnalise));
+    }
+    free(trabalhos);
+
+    qsort(posicoes, n, sizeof(PosicaoAnalise), compararErros);
+    for (int i = 0; i < n && *numErros < maxErros && posicoes[i].resultado.perda > limiar; i++)
+        erros[(*numErros)++] = posicoes[i].resultado;
+    free(posicoes);
+    return n;
+}
+
+static void *trabalharAnaliseFim(void *arg)
+{
+    AnalisePartida *a = (AnalisePartida *)arg;
+    double inicio = agoraSegundos();
+    a->posicoes = analisarHistorico(&a->historico, &a->final, LIMIAR_ERRO_ANALISE, numeroNucleos(), a->erros,
+                                    MAX_ERROS_ANALISE, &a->numErros);
+    a->segundos = agoraSegundos() - inicio;
+    atomic_store_explicit(&a->pronta, 1, memory_order_release);
+    return NULL;
+}
+
+// Chamada ao entrar na tela de fim com estadoDoJogo(): a análise roda numa
+// thread própria e a tela mostra "analisando" até ela terminar
+void iniciarAnalisePartida(AnalisePartida *a, const Historico *h, EstadoMotor final)
+{
+    if (a->iniciada || !analisarPartidas || !niveis[nivelAtual].analise)
+        return;
+    a->historico = *h;
+    a->final = final;
+    atomic_store(&a->pronta, 0);
+    a->iniciada = pthread_create(&a->thread, NULL, trabalharAnaliseFim, a) == 0;
+}
+
+// Espera a análise anterior (se houver) antes de uma partida nova ou da saída
+void encerrarAnalisePartida(AnalisePartida *a)
+{
+    if (a->iniciada)
+        pthread_join(a->thread, NULL);
+    a->iniciada = 0;
+}
+
+void desenharAnalisePartida(AnalisePartida *a)
+{
+    int x = SCREEN_WIDTH / 2 - 300, y = 520;
+    if (!a->iniciada)
+        return;
+    DrawText("ANALISE DA PARTIDA", x, y, 22, GOLD);
+    if (!atomic_load_explicit(&a->pronta, memory_order_acquire))
+    {
+        DrawText("Analisando as jogadas...", x, y + 30, 18, LIGHTGRAY);
+        return;
+    }
+    if (a->numErros == 0)
+    {
+        DrawText(TextFormat("Nenhum erro grave em %d decisoes (%.1fs)", a->posicoes, a->segundos), x, y + 30, 18,
+                 LIGHTGRAY);
+        return;
+    }
+    for (int i = 0; i < a->numErros; i++)
+    {
+        const ErroPartida *erro = &a->erros[i];
+        Peca jogada = pecaMotor[erro->jogado.peca], melhor = pecaMotor[erro->melhor.peca];
+        DrawText(TextFormat("Lance %d (%s): [%d|%d] %c, melhor [%d|%d] %c - perda ~%.0f%%", erro->jogada + 1,
+                            erro->jogador == 1 ? "voce" : "IA", jogada.lado1, jogada.lado2,
+                            erro->jogado.lado ? 'D' : 'E', melhor.lado1, melhor.lado2, erro->melhor.lado ? 'D' : 'E',
+                            100.0 * erro->perda / (2 * VALOR_VITORIA)),
+                 x, y + 30 + 22 * i, 18, erro->jogador == 1 ? ORANGE : LIGHTGRAY);
+    }
+}
+
+void desenharPeca(int x, int y, Peca peca, Color cor)
+{
+    DrawRectangle(x, y, PECA_WIDTH, PECA_HEIGHT, cor);
+    DrawRectangleLines(x, y, PECA_WIDTH, PECA_HEIGHT, BLACK);
+    DrawLine(x, y + PECA_HEIGHT / 2, x + PECA_WIDTH, y + PECA_HEIGHT / 2, BLACK);
+    DrawText(TextFormat("%d", peca.lado1), x + PECA_WIDTH / 2 - 10, y + 20, 30, BLACK);
+    DrawText(TextFormat("%d", peca.lado2), x + PECA_WIDTH / 2 - 10, y + PECA_HEIGHT / 2 + 20, 30, BLACK);
+}
+
+void desenharTabuleiro()
+{
+    DrawRectangle(0, 0, SCREEN_WIDTH, 200, DARKGREEN);
+    DrawText("MESA", 20, 20, 30, WHITE);
+
+    if (!tabuleiro.inicio)
+    {
+        DrawText("Mesa vazia - Primeira jogada", 350, 90, 25, YELLOW);
+        return;
+    }
+
+    int totalPecas = 0, x = 50;
+    for (No *c = tabuleiro.inicio; c; c = c->prox)
+        totalPecas++;
+
+    if (totalPecas <= 8)
+    {
+        for (No *atual = tabuleiro.inicio; atual; atual = atual->prox, x += PECA_WIDTH + 10)
+            desenharPeca(x, 50, atual->peca, WHITE);
+    }
+    else
+    {
+        No *atual = tabuleiro.inicio;
+        for (int i = 0; i < 3 && atual; i++, atual = atual->prox, x += PECA_WIDTH + 10)
+            desenharPeca(x, 50, atual->peca, WHITE);
+        DrawText("...", x + 10, 90, 40, WHITE);
+        x += 50;
+        No *temp[3] = {NULL, NULL, NULL};
+        No *p = tabuleiro.fim;
+        for (int i = 2; i >= 0 && p; i--, p = p->ant)
+            temp[i] = p;
+        for (int i = 0; i < 3; i++)
+            if (temp[i])
+            {
+                desenharPeca(x, 50, temp[i]->peca, WHITE);
+                x += PECA_WIDTH + 10;
+            }
+    }
+
+    DrawText(TextFormat("Pontas: [%d] e [%d]", tabuleiro.pontoInicio, tabuleiro.pontoFim), 850, 20, 25, YELLOW);
+    DrawText(TextFormat("Total: %d pecas", totalPecas), 850, 55, 20, LIGHTGRAY);
+}
+
+void desenharMaoHumano()
+{
+    DrawText("SUA MAO", 20, 220, 30, WHITE);
+    DrawText(TextFormat("Pecas: %d | Pontos: %d", maoHumano.quantidade, calcularPontos(&maoHumano)), 20, 260, 20, LIGHTGRAY);
+
+    // Com as dicas ligadas, cada peça jogável mostra sua melhor chance de
+    // vitória e a melhor de todas ganha o marcador dourado
+    PlacarAoVivo placar;
+    int comDicas = atomic_load(&analiseAoVivo.dicas) && turnoAtual == 1 &&
+                   placarAtualAoVivo(&analiseAoVivo, &placar) && placar.numDicas > 0;
+
+    int x = 50, i = 0;
+    for (NoMao *atual = maoHumano.pecas; atual; atual = atual->proximo, i++, x += PECA_WIDTH + 15)
+    {
+        desenharPeca(x, 300, atual->peca, i == pecaSelecionada ? YELLOW : LIGHTGRAY);
+        if (!encaixa(&tabuleiro, atual->peca))
+            continue;
+        const DicaLance *dica = comDicas ? dicaDaPeca(&placar, atual->peca, -1) : NULL;
+        Color cor = dica == &placar.dicas[0] ? GOLD : GREEN;
+        DrawCircle(x + PECA_WIDTH - 10, 310, 8, dica ? cor : GREEN);
+        if (dica)
+            DrawText(TextFormat("%.0f%%", 100.0f * dica->vitoria), x + 8, 300 + PECA_HEIGHT + 6, 18, cor);
+    }
+}
+
+void desenharMaoIA()
+{
+    DrawText("MAO DA IA", SCREEN_WIDTH - 200, 220, 25, WHITE);
+    DrawText(TextFormat("Pecas: %d", maoIA.quantidade), SCREEN_WIDTH - 200, 260, 20, LIGHTGRAY);
+    for (int i = 0; i < maoIA.quantidade && i < 6; i++)
+    {
+        DrawRectangle(SCREEN_WIDTH - 200, 300 + i * 25, 50, 20, GRAY);
+        DrawRectangleLines(SCREEN_WIDTH - 200, 300 + i * 25, 50, 20, BLACK);
+    }
+}
+
+void desenharBotoes()
+{
+    Color corE = (ladoEscolhido == 'E') ? GREEN : LIGHTGRAY;
+    DrawRectangle(50, 500, 150, 50, corE);
+    DrawText("ESQUERDA (E)", 60, 515, 20, BLACK);
+
+    Color corD = (ladoEscolhido == 'D') ? GREEN : LIGHTGRAY;
+    DrawRectangle(220, 500, 150, 50, corD);
+    DrawText("DIREITA (D)", 235, 515, 20, BLACK);
+
+    DrawRectangle(50, 570, 150, 50, BLUE);
+    DrawText("JOGAR", 90, 585, 25, WHITE);
+
+    DrawRectangle(220, 570, 150, 50, ORANGE);
+    DrawText("COMPRAR", 245, 585, 20, WHITE);
+
+    DrawRectangle(SCREEN_WIDTH - 180, 500, 160, 50, RED);
+    DrawText("VOLTAR MENU", SCREEN_WIDTH - 165, 515, 20, WHITE);
+
+    DrawText(TextFormat("Monte: %d", monte.topo + 1), 50, 640, 20, WHITE);
+
+    int dicas = niveis[nivelAtual].analise && atomic_load(&analiseAoVivo.dicas);
+    if (niveis[nivelAtual].analise)
+    {
+        DrawRectangle(390, 570, 150, 50, dicas ? GOLD : GRAY);
+        DrawText(dicas ? "DICAS: ON (H)" : "DICAS: OFF (H)", 400, 587, 18, BLACK);
+    }
+
+    // Chance de vitória da peça selecionada em cada lado
+    PlacarAoVivo placar;
+    if (dicas && turnoAtual == 1 && pecaSelecionada >= 0 && placarAtualAoVivo(&analiseAoVivo, &placar))
+    {
+        NoMao *atual = maoHumano.pecas;
+        for (int i = 0; i < pecaSelecionada && atual; i++)
+            atual = atual->proximo;
+        for (int lado = 0; atual && lado < 2; lado++)
+        {
+            // Mesa vazia ou pontas iguais: os dois lados são o mesmo lance
+            const DicaLance *dica = dicaDaPeca(&placar, atual->peca, lado);
+            if (!dica && (!tabuleiro.inicio || tabuleiro.pontoInicio == tabuleiro.pontoFim))
+                dica = dicaDaPeca(&placar, atual->peca, -1);
+            if (dica)
+                DrawText(TextFormat("%.0f%% (%+.1f)", 100.0f * dica->vitoria, dica->margem), 60 + 170 * lado, 476, 18,
+                         dica == &placar.dicas[0] ? GOLD : WHITE);
+        }
+        if (placar.numDicas)
+            DrawText(TextFormat("%u partidas por lance", placar.playoutsDica), 390, 625, 16, LIGHTGRAY);
+    }
+}
+
+void desenharMensagem()
+{
+    if (tempoMensagem-- > 0)
+    {
+        DrawRectangle(SCREEN_WIDTH / 2 - 250, SCREEN_HEIGHT - 100, 500, 60, Fade(BLACK, 0.8f));
+        DrawText(mensagem, SCREEN_WIDTH / 2 - 240, SCREEN_HEIGHT - 85, 20, WHITE);
+    }
+}
+
+// Renderiza a tela do menu principal
+// Interface gráfica criada com funções de desenho da Raylib
+void desenharMenu()
+{
+    DrawText("DOMINÓ CLASH", SCREEN_WIDTH / 2 - 200, 80, 60, GOLD);
+    DrawText("Humano vs IA Estrategica", SCREEN_WIDTH / 2 - 150, 160, 25, WHITE);
+
+    // Seletor de nível: clique nas setas (ou use as setas do teclado)
+    const char *nivel = TextFormat("NIVEL: %s", niveis[nivelAtual].nome);
+    DrawText("<", SCREEN_WIDTH / 2 - 150, 200, 30, GOLD);
+    DrawText(nivel, SCREEN_WIDTH / 2 - MeasureText(nivel, 22) / 2, 204, 22, WHITE);
+    DrawText(">", SCREEN_WIDTH / 2 + 135, 200, 30, GOLD);
+
+    DrawRectangle(SCREEN_WIDTH / 2 - 150, 240, 300, 60, BLUE);
+    DrawText("JOGAR", SCREEN_WIDTH / 2 - 60, 258, 30, WHITE);
+
+    DrawRectangle(SCREEN_WIDTH / 2 - 150, 320, 300, 60, GREEN);
+    DrawText("REGRAS", SCREEN_WIDTH / 2 - 70, 338, 30, WHITE);
+
+    DrawRectangle(SCREEN_WIDTH / 2 - 150, 400, 300, 60, ORANGE);
+    DrawText("DESAFIOS", SCREEN_WIDTH / 2 - 75, 418, 30, WHITE);
+
+    DrawRectangle(SCREEN_WIDTH / 2 - 150, 480, 300, 60, PURPLE);
+    DrawText("SOBRE", SCREEN_WIDTH / 2 - 60, 498, 30, WHITE);
+
+    DrawRectangle(SCREEN_WIDTH / 2 - 150, 560, 300, 50, RED);
+    DrawText("SAIR", SCREEN_WIDTH / 2 - 35, 575, 25, WHITE);
+
+    DrawText("Nova(Velha) InfancIA - 2025", SCREEN_WIDTH / 2 - 150, 660, 18, LIGHTGRAY);
+}
+
+// Exibe as regras do jogo de forma visual e organizada
+void desenharRegras()
+{
+    DrawText("REGRAS DO DOMINÓ", SCREEN_WIDTH / 2 - 200, 50, 40, GOLD);
+
+    DrawText("OBJETIVO:", 50, 120, 25, WHITE);
+    DrawText("Ser o primeiro a ficar sem pecas", 50, 150, 20, LIGHTGRAY);
+
+    DrawText("COMO JOGAR:", 50, 200, 25, WHITE);
+    DrawText(TextFormat("- Cada jogador comeca com %d pecas", PECAS_POR_MAO), 50, 230, 20, LIGHTGRAY);
+    DrawText("- Encaixe pecas pelos numeros iguais", 50, 260, 20, LIGHTGRAY);
+    DrawText("- Escolha ESQUERDA ou DIREITA para jogar", 50, 290, 20, LIGHTGRAY);
+    DrawText("- Sem jogadas validas? Compre do monte", 50, 320, 20, LIGHTGRAY);
+
+    DrawText("VITORIA:", 50, 370, 25, WHITE);
+    DrawText("- Vence quem ficar sem pecas primeiro", 50, 400, 20, LIGHTGRAY);
+    DrawText("- Se o monte acabar, vence quem tiver", 50, 430, 20, LIGHTGRAY);
+    DrawText("  menos pontos nas pecas restantes", 50, 460, 20, LIGHTGRAY);
+
+    DrawRectangle(SCREEN_WIDTH / 2 - 100, 550, 200, 50, BLUE);
+    DrawText("VOLTAR", SCREEN_WIDTH / 2 - 50, 565, 25, WHITE);
+}
+
+// Tela de desafios: finais com as duas mãos à vista e um único lance vencedor
+typedef struct
+{
+    Desafio *lista;
+    int quantidade, atual, carregado;
+    int resposta; // 0 = ainda não respondeu, 1 = acertou, 2 = errou
+} TelaDesafios;
+
+TelaDesafios telaDesafios;
+
+void abrirTelaDesafios()
+{
+    if (!telaDesafios.carregado)
+    {
+        const char *arquivo = getenv("DOMINO_DESAFIOS");
+        telaDesafios.lista = malloc(MAX_DESAFIOS * sizeof(Desafio));
+        if (telaDesafios.lista)
+            telaDesafios.quantidade = carregarDesafios(arquivo ? arquivo : "desafios.txt", telaDesafios.lista, MAX_DESAFIOS);
+        telaDesafios.carregado = 1;
+    }
+    telaDesafios.resposta = 0;
+    pecaSelecionada = -1;
+    ladoEscolhido = 'E';
+}
+
+// Peça da mão do desafio na posição 'indice' (na ordem dos bits), ou -1
+int pecaDoDesafio(const Desafio *d, int indice)
+{
+    MascaraPecas m = d->mao[0];
+    for (int i = 0; m && i < indice; i++)
+        m &= m - 1;
+    return m ? primeiraPeca(m) : -1;
+}
+
+void responderDesafio()
+{
+    const Desafio *d = &telaDesafios.lista[telaDesafios.atual];
+    int peca = pecaDoDesafio(d, pecaSelecionada);
+    if (peca < 0)
+    {
+        mostrarMensagem("Selecione uma peca!");
+        return;
+    }
+    Peca p = pecaMotor[peca];
+    int lado = ladoEscolhido == 'D', ponta = d->pontas[lado];
+    if (p.lado1 != ponta && p.lado2 != ponta)
+    {
+        mostrarMensagem("Peca nao encaixa desse lado!");
+        return;
+    }
+    // Com as pontas iguais os dois lados são o mesmo lance
+    Lance certo = d->solucao[0];
+    int acertou = certo.peca == peca && (certo.lado == lado || d->pontas[0] == d->pontas[1]);
+    telaDesafios.resposta = acertou ? 1 : 2;
+}
+
+void desenharDesafios()
+{
+    if (telaDesafios.quantidade == 0)
+    {
+        DrawText("DESAFIOS", SCREEN_WIDTH / 2 - 110, 50, 40, GOLD);
+        DrawText("Nenhum desafio encontrado.", 50, 150, 25, WHITE);
+        DrawText("Gere o arquivo com: domino_clash --gerar-desafios desafios.txt", 50, 190, 20, LIGHTGRAY);
+        DrawRectangle(SCREEN_WIDTH - 180, 500, 160, 50, RED);
+        DrawText("VOLTAR MENU", SCREEN_WIDTH - 165, 515, 20, WHITE);
+        return;
+    }
+
+    const Desafio *d = &telaDesafios.lista[telaDesafios.atual];
+    DrawText(TextFormat("DESAFIO %d/%d", telaDesafios.atual + 1, telaDesafios.quantidade), 20, 15, 30, GOLD);
+    DrawText("Monte vazio, pecas do adversario a vista: so um lance vence!", 330, 22, 20, WHITE);
+
+    DrawText("ADVERSARIO", 20, 60, 20, LIGHTGRAY);
+    int x = 50;
+    for (MascaraPecas m = d->mao[1]; m; m &= m - 1, x += PECA_WIDTH + 10)
+        desenharPeca(x, 85, pecaMotor[primeiraPeca(m)], WHITE);
+    DrawText(TextFormat("Pontas: [%d] e [%d]", d->pontas[0], d->pontas[1]), 850, 120, 25, YELLOW);
+
+    DrawText("SUA MAO", 20, 220, 30, WHITE);
+    x = 50;
+    int i = 0;
+    for (MascaraPecas m = d->mao[0]; m; m &= m - 1, i++, x += PECA_WIDTH + 15)
+        desenharPeca(x, 300, pecaMotor[primeiraPeca(m)], i == pecaSelecionada ? YELLOW : LIGHTGRAY);
+
+    DrawRectangle(50, 500, 150, 50, ladoEscolhido == 'E' ? GREEN : LIGHTGRAY);
+    DrawText("ESQUERDA (E)", 60, 515, 20, BLACK);
+    DrawRectangle(220, 500, 150, 50, ladoEscolhido == 'D' ? GREEN : LIGHTGRAY);
+    DrawText("DIREITA (D)", 235, 515, 20, BLACK);
+    DrawRectangle(50, 570, 150, 50, BLUE);
+    DrawText("RESPONDER", 65, 585, 22, WHITE);
+    DrawRectangle(220, 570, 150, 50, ORANGE);
+    DrawText("PROXIMO", 250, 585, 22, WHITE);
+    DrawRectangle(SCREEN_WIDTH - 180, 500, 160, 50, RED);
+    DrawText("VOLTAR MENU", SCREEN_WIDTH - 165, 515, 20, WHITE);
+
+    if (telaDesafios.resposta)
+    {
+        // Linha da solução: os lances dos dois lados até o fim
+        char linha[256] = "";
+        for (int k = 0; k < d->numLances; k++)
+        {
+            Lance l = d->solucao[k];
+            size_t usado = strlen(linha);
+            if (l.peca < 0)
+                snprintf(linha + usado, sizeof(linha) - usado, "%spassa", k ? " " : "");
+            else
+                snprintf(linha + usado, sizeof(linha) - usado, "%s[%d|%d]%c", k ? " " : "", pecaMotor[l.peca].lado1,
+                         pecaMotor[l.peca].lado2, l.lado ? 'D' : 'E');
+        }
+        DrawText(telaDesafios.resposta == 1 ? "CORRETO!" : "ERROU!", 400, 505, 30, telaDesafios.resposta == 1 ? GREEN : RED);
+        DrawText(TextFormat("Solucao: %s", linha), 400, 545, 18, WHITE);
+    }
+    desenharMensagem();
+}
+
+void desenharSobre()
+{
+    DrawText("SOBRE O PROJETO", SCREEN_WIDTH / 2 - 220, 20, 40, GOLD);
+
+    DrawText("AUTORES:", 50, 70, 23, WHITE);
+    DrawText("Davi Santiago e Jose Jorge", 50, 95, 18, LIGHTGRAY);
 
     DrawText("ESTRUTURAS DE DADOS:", 50, 135, 23, WHITE);
     DrawText("Lista Duplamente Encadeada - Tabuleiro", 50, 160, 17, LIGHTGRAY);
@@ -712,318 +6881,1514 @@ void desenharSobre()
     DrawText("  (ultima peca colocada eh a primeira comprada)", 50, 270, 15, DARKGRAY);
     DrawText("Bubble Sort - Ordenacao de pecas por valor", 50, 295, 17, LIGHTGRAY);
 
-    DrawText("TECNOLOGIAS:", 50, 335, 23, WHITE);
-    DrawText("Linguagem C - Codigo principal", 50, 360, 17, LIGHTGRAY);
-    DrawText("Raylib 5.0 - Interface grafica", 50, 382, 17, LIGHTGRAY);
-    DrawText("libcurl - Requisicoes HTTP para API", 50, 404, 17, LIGHTGRAY);
-    DrawText("cJSON - Parse de respostas JSON", 50, 426, 17, LIGHTGRAY);
+    DrawText("TECNOLOGIAS:", 50, 335, 23, WHITE);
+    DrawText("Linguagem C - Codigo principal", 50, 360, 17, LIGHTGRAY);
+    DrawText("Raylib 5.0 - Interface grafica", 50, 382, 17, LIGHTGRAY);
+    DrawText("libcurl - Requisicoes HTTP para API", 50, 404, 17, LIGHTGRAY);
+    DrawText("cJSON - Parse de respostas JSON", 50, 426, 17, LIGHTGRAY);
+
+    DrawText("INTELIGENCIA ARTIFICIAL:", 50, 466, 23, WHITE);
+    DrawText("Groq API - Servico de IA em nuvem", 50, 491, 17, LIGHTGRAY);
+    DrawText("Modelo: Llama 3.3 70B Versatile", 50, 513, 17, LIGHTGRAY);
+    DrawText("IA analisa pecas e decide melhor jogada", 50, 535, 17, LIGHTGRAY);
+
+    DrawRectangle(SCREEN_WIDTH / 2 - 100, 600, 200, 50, BLUE);
+    DrawText("VOLTAR", SCREEN_WIDTH / 2 - 50, 615, 25, WHITE);
+}
+
+// ===== Disputa na janela =====
+// Cada JOGAR começa uma disputa até disputa.alvo (DOMINO_ALVO, padrão 100);
+// as rodadas seguem pela tela de fim até alguém chegar lá
+typedef struct
+{
+    int alvo;
+    int pontos[2];      // 0 = humano, 1 = IA
+    int primeiro;       // quem sai na rodada atual
+    int rodadas, empates;
+    int vitorias[2];
+    int batidas[2];     // rodadas vencidas ficando sem peças (as outras fecharam)
+    int maiorRodada[2]; // mais pontos feitos numa rodada só
+    int registrada;     // a rodada atual já entrou no placar
+} Disputa;
+
+Disputa disputa = {ALVO_PADRAO};
+
+// Equidade da disputa para a busca da IA. Sai ao começar a disputa, e só quando o
+// alvo muda, para que as 20000 rodadas de autojogo não caiam dentro de uma jogada
+TabelaDisputa tabelaDisputaJanela = {0};
+
+void iniciarDisputa(int alvo)
+{
+    disputa = (Disputa){alvo};
+    if (tabelaDisputaJanela.alvo != alvo)
+        construirTabelaDisputa(&tabelaDisputaJanela, alvo, acharPolitica("gulosa"), 20000, 1);
+}
+
+int disputaEncerrada()
+{
+    return disputa.pontos[0] >= disputa.alvo || disputa.pontos[1] >= disputa.alvo;
+}
+
+// Leva ao placar a rodada que terminou com 'vencedor' (como verificarVitoria()):
+// quem venceu marca os pontos da mão do outro. Só conta uma vez por rodada.
+void registrarRodadaDisputa(int vencedor)
+{
+    if (disputa.registrada)
+        return;
+    disputa.registrada = 1;
+    disputa.rodadas++;
+    if (vencedor != 1 && vencedor != 2)
+    {
+        disputa.empates++;
+        return;
+    }
+    int j = vencedor - 1;
+    Mao *venceu = j ? &maoIA : &maoHumano, *perdeu = j ? &maoHumano : &maoIA;
+    int pontos = calcularPontos(perdeu);
+    disputa.pontos[j] += pontos;
+    disputa.vitorias[j]++;
+    if (venceu->quantidade == 0)
+        disputa.batidas[j]++;
+    if (pontos > disputa.maiorRodada[j])
+        disputa.maiorRodada[j] = pontos;
+}
+
+void desenharTelaFim()
+{
+    int encerrada = disputaEncerrada();
+    DrawText(encerrada ? "FIM DA DISPUTA!" : TextFormat("FIM DA RODADA %d", disputa.rodadas),
+             SCREEN_WIDTH / 2 - 220, 60, 50, GOLD);
+
+    if (vencedor == 1)
+    {
+        DrawText("VOCE VENCEU A RODADA!", SCREEN_WIDTH / 2 - 240, 140, 40, GREEN);
+    }
+    else if (vencedor == 2)
+    {
+        DrawText("IA VENCEU A RODADA!", SCREEN_WIDTH / 2 - 210, 140, 40, RED);
+    }
+    else
+    {
+        DrawText("EMPATE!", SCREEN_WIDTH / 2 - 90, 140, 40, YELLOW);
+    }
+
+    DrawText(TextFormat("Sua pontuacao: %d pts (%d pecas)",
+                        calcularPontos(&maoHumano), maoHumano.quantidade),
+             SCREEN_WIDTH / 2 - 220, 200, 23, WHITE);
+    DrawText(TextFormat("IA: %d pts (%d pecas)",
+                        calcularPontos(&maoIA), maoIA.quantidade),
+             SCREEN_WIDTH / 2 - 220, 235, 23, WHITE);
+
+    DrawText(TextFormat("PLACAR: Voce %d x %d IA (disputa ate %d)", disputa.pontos[0], disputa.pontos[1], disputa.alvo),
+             SCREEN_WIDTH / 2 - 260, 285, 26, GOLD);
+    DrawText(TextFormat("Rodadas: %d | Vitorias: %d x %d | Empates: %d", disputa.rodadas, disputa.vitorias[0],
+                        disputa.vitorias[1], disputa.empates),
+             SCREEN_WIDTH / 2 - 260, 325, 20, LIGHTGRAY);
+    DrawText(TextFormat("Batidas: %d x %d | Maior rodada: %d x %d pts", disputa.batidas[0], disputa.batidas[1],
+                        disputa.maiorRodada[0], disputa.maiorRodada[1]),
+             SCREEN_WIDTH / 2 - 260, 352, 20, LIGHTGRAY);
+    if (encerrada)
+        DrawText(disputa.pontos[0] >= disputa.alvo ? "VOCE VENCEU A DISPUTA!" : "A IA VENCEU A DISPUTA!",
+                 SCREEN_WIDTH / 2 - 200, 392, 32, disputa.pontos[0] >= disputa.alvo ? GREEN : RED);
+
+    if (encerrada)
+    {
+        DrawRectangle(SCREEN_WIDTH / 2 - 100, 450, 200, 50, BLUE);
+        DrawText("MENU", SCREEN_WIDTH / 2 - 40, 465, 25, WHITE);
+    }
+    else
+    {
+        DrawRectangle(SCREEN_WIDTH / 2 - 210, 450, 200, 50, DARKBLUE);
+        DrawText("PROXIMA", SCREEN_WIDTH / 2 - 165, 465, 25, WHITE);
+        DrawRectangle(SCREEN_WIDTH / 2 + 10, 450, 200, 50, BLUE);
+        DrawText("MENU", SCREEN_WIDTH / 2 + 70, 465, 25, WHITE);
+    }
+
+    desenharAnalisePartida(&analisePartida);
+}
+
+// Começa uma rodada da disputa atual com disputa.primeiro na saída
+void iniciarJogo()
+{
+    encerrarAnalisePartida(&analisePartida);
+    inicializar(&tabuleiro, &maoHumano, &maoIA, &monte, &historico);
+    distribuir(&maoHumano, &maoIA, &monte);
+    ordenarMao(&maoHumano);
+    ordenarMao(&maoIA);
+    turnoAtual = disputa.primeiro + 1;
+    passadas = 0;
+    vencedor = 0;
+    disputa.registrada = 0;
+    pecaSelecionada = -1;
+    ladoEscolhido = 'E';
+    mostrarJogadaIA = 0;
+    tempoJogadaIA = 0;
+    ultimaPecaIA.lado1 = -1;
+    ultimaPecaIA.lado2 = -1;
+    ultimoLadoIA = '-';
+    mostrarMensagem(disputa.primeiro ? TextFormat("Rodada %d: a IA sai", disputa.rodadas + 1)
+                                     : TextFormat("Rodada %d: sua vez!", disputa.rodadas + 1));
+}
+
+// Verifica as condições de vitória do jogo
+// Retorna: 1 = humano venceu, 2 = IA venceu, 3 = empate, 0 = jogo continua
+// Com o jogo travado a partida termina na hora: quem está na vez teria de
+// comprar o monte inteiro e os dois passariam, então as compras são feitas aqui
+int verificarVitoria()
+{
+    if (maoHumano.quantidade == 0)
+        return 1;
+    if (maoIA.quantidade == 0)
+        return 2;
+    int travado = jogoTravado(&tabuleiro);
+    if (travado)
+    {
+        Mao *mao = turnoAtual == 1 ? &maoHumano : &maoIA;
+        Peca nova;
+        while (comprar(&monte, &nova))
+        {
+            adicionarPeca(mao, nova);
+            registrar(&historico, turnoAtual, nova, '-', 'C');
+        }
+        ordenarMao(mao);
+    }
+    if (passadas >= 2 || travado)
+    {
+        int pts1 = calcularPontos(&maoHumano);
+        int pts2 = calcularPontos(&maoIA);
+        if (pts1 < pts2)
+            return 1;
+        if (pts2 < pts1)
+            return 2;
+        return 3;
+    }
+    return 0;
+}
+
+// Converte as listas do jogo (mãos, mesa e monte) para o estado compacto do motor
+EstadoMotor estadoDoJogo()
+{
+    EstadoMotor e;
+    memset(&e, 0, sizeof(e));
+    for (NoMao *atual = maoHumano.pecas; atual; atual = atual->proximo)
+        e.mao[0] |= BIT_PECA(indicePeca[atual->peca.lado1][atual->peca.lado2]);
+    for (NoMao *atual = maoIA.pecas; atual; atual = atual->proximo)
+        e.mao[1] |= BIT_PECA(indicePeca[atual->peca.lado1][atual->peca.lado2]);
+    for (int i = 0; i <= monte.topo; i++)
+        e.monte |= BIT_PECA(indicePeca[monte.pecas[i].lado1][monte.pecas[i].lado2]);
+    for (No *atual = tabuleiro.inicio; atual; atual = atual->prox)
+        e.mesa |= BIT_PECA(indicePeca[atual->peca.lado1][atual->peca.lado2]);
+    e.pontas[0] = tabuleiro.inicio ? tabuleiro.pontoInicio : -1;
+    e.pontas[1] = tabuleiro.inicio ? tabuleiro.pontoFim : -1;
+    e.vez = turnoAtual - 1;
+    e.passadas = passadas > 2 ? 2 : passadas;
+    e.chave = calcularChaveMotor(&e);
+    return e;
+}
+
+// Backend local do turno da IA: busca expectiminimax sobre o motor compacto
+int escolherJogadaBusca(Peca *peca, char *lado)
+{
+    static Buscador *buscador = NULL;
+    if (!buscador)
+        buscador = criarBuscador();
+    if (!buscador)
+        return 0;
+
+    // Joga pela equidade da disputa com a tabela montada em iniciarDisputa()
+    ContextoDisputa contexto = {&tabelaDisputaJanela,
+                                {disputa.alvo - disputa.pontos[0], disputa.alvo - disputa.pontos[1]},
+                                disputa.primeiro};
+    definirDisputaBuscador(buscador, tabelaDisputaJanela.alvo == disputa.alvo ? &contexto : NULL);
+
+    // Semente derivada de rand(): com srand() fixo a busca sorteia os mesmos mundos
+    uint64_t semente = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+    EstadoMotor e = estadoDoJogo();
+    Crenca crenca;
+    crencaDoHistorico(&historico, 2, &crenca);
+    RelatorioBusca rel;
+    Lance l = buscarLance(buscador, &e, &crenca, &configBuscaIA, &semente, &rel);
+    if (l.peca < 0)
+        return 0;
+
+    if (rel.nos > 0)
+        printf("[IA] Busca: profundidade %d, %lld nos em %.3fs (%.0f nos/s)\n", rel.profundidade,
+               rel.nos, rel.segundos, rel.segundos > 0 ? rel.nos / rel.segundos : 0.0);
+    *peca = pecaMotor[l.peca];
+    *lado = l.lado ? 'D' : 'E';
+    return 1;
+}
+
+// Backend local do turno da IA com MCTS em todos os núcleos
+int escolherJogadaMcts(Peca *peca, char *lado)
+{
+    uint64_t semente = ((uint64_t)rand() << 32) ^ (uint64_t)rand();
+    EstadoMotor e = estadoDoJogo();
+    Crenca crenca;
+    crencaDoHistorico(&historico, 2, &crenca);
+    RelatorioMcts rel;
+    Lance l = buscarLanceMcts(&e, &crenca, &configMctsIA, &semente, &rel);
+    if (l.peca < 0)
+        return 0;
+
+    if (rel.iteracoes > 0)
+        printf("[IA] MCTS (%s, %d threads): %lld playouts em %.3fs (%.0f/s), vitoria estimada %.0f%%\n",
+               configMctsIA.modo == MCTS_RAIZ ? "raiz" : "arvore", rel.threads, rel.iteracoes, rel.segundos,
+               rel.segundos > 0 ? rel.iteracoes / rel.segundos : 0.0, rel.valor * 100.0);
+    *peca = pecaMotor[l.peca];
+    *lado = l.lado ? 'D' : 'E';
+    return 1;
+}
+
+// Backend local do turno da IA com uma política instantânea do registro
+// (heurística de pesos ajustados ou política destilada)
+int escolherJogadaPolitica(FuncaoPolitica escolher, void *config, Peca *peca, char *lado)
+{
+    uint64_t semente = 0;
+    EstadoMotor e = estadoDoJogo();
+    Crenca crenca;
+    crencaDoHistorico(&historico, 2, &crenca);
+    Lance l = escolher(&e, niveis[nivelAtual].usarCrenca ? &crenca : NULL, config, &semente);
+    if (l.peca < 0)
+        return 0;
+    *peca = pecaMotor[l.peca];
+    *lado = l.lado ? 'D' : 'E';
+    return 1;
+}
+
+// Processa o turno da IA: chama API Groq ou usa fallback local
+void processarTurnoIA()
+{
+    // Sem jogada válida a IA compra até poder jogar - a vez continua com ela,
+    // como no botão COMPRAR e em comprarPecaMotor(); com o monte vazio, passa
+    int compradas = 0;
+    while (contarJogadas(&maoIA, &tabuleiro) == 0)
+    {
+        Peca nova;
+        if (!comprar(&monte, &nova))
+        {
+            mostrarMensagem(compradas ? TextFormat("IA comprou %d pecas e passou a vez", compradas)
+                                      : "IA passou a vez");
+            passadas++;
+            registrar(&historico, 2, (Peca){0, 0}, '-', 'P');
+            turnoAtual = 1;
+            return;
+        }
+        adicionarPeca(&maoIA, nova);
+        ordenarMao(&maoIA);
+        registrar(&historico, 2, nova, '-', 'C');
+        compradas++;
+    }
+    if (compradas)
+        printf("[IA] Comprou %d peca(s)\n", compradas);
+
+    printf("[IA] Processando turno (nivel %s)...\n", niveis[nivelAtual].nome);
+    double inicioTurno = agoraSegundos();
+
+    Peca pecaEscolhida;
+    char ladoEscolhido;
+    char *resposta_json = NULL;
+    int escolheu = 0;
+    const char *origem = motorIA == MOTOR_GROQ ? "API" : "busca local";
+
+    // Final de jogo já resolvido: uma consulta à tablebase no lugar da busca ou da API.
+    // A busca joga pela equidade da disputa e a tablebase só conhece a rodada, então fica de fora
+    if (tablebase.dados && niveis[nivelAtual].tablebase && motorIA != MOTOR_BUSCA)
+    {
+        EstadoMotor e = estadoDoJogo();
+        Lance l;
+        int valor = consultarTablebase(&tablebase, &e, &l);
+        if (valor && l.peca >= 0)
+        {
+            pecaEscolhida = pecaMotor[l.peca];
+            ladoEscolhido = l.lado ? 'D' : 'E';
+            escolheu = 1;
+            origem = "tablebase";
+            printf("[IA] Tablebase: final %s\n", valor == 3 ? "ganho" : (valor == 2 ? "empatado" : "perdido"));
+        }
+    }
+
+    // Abertura: o livro já tem o lance para a mão inteira da IA
+    if (!escolheu && livroAbertura.entradas && niveis[nivelAtual].livro)
+    {
+        EstadoMotor e = estadoDoJogo();
+        Lance l;
+        double vitoria;
+        if (consultarLivroAbertura(&livroAbertura, &e, &l, &vitoria))
+        {
+            pecaEscolhida = pecaMotor[l.peca];
+            ladoEscolhido = 'E';
+            escolheu = 1;
+            origem = "livro de aberturas";
+            printf("[IA] Livro de aberturas: vitoria estimada %.0f%%\n", vitoria * 100.0);
+        }
+    }
+
+    // Backend da jogada: busca local (sem rede) ou modelo de linguagem na Groq
+    if (!escolheu && motorIA == MOTOR_BUSCA)
+        escolheu = escolherJogadaBusca(&pecaEscolhida, &ladoEscolhido);
+    else if (!escolheu && motorIA == MOTOR_MCTS)
+        escolheu = escolherJogadaMcts(&pecaEscolhida, &ladoEscolhido);
+    else if (!escolheu && motorIA == MOTOR_HEURISTICA)
+        escolheu = escolherJogadaPolitica(politicaHeuristica, &pesosHeuristica, &pecaEscolhida, &ladoEscolhido);
+    else if (!escolheu && motorIA == MOTOR_DESTILADA)
+        escolheu = escolherJogadaPolitica(politicaDestilada, &modeloDestilado, &pecaEscolhida, &ladoEscolhido);
+    else if (!escolheu)
+    {
+        char *prompt = construirPromptIA(&maoIA, &tabuleiro);
+        resposta_json = chamarGroqAPI(prompt, PRIORIDADE_MESA);
+    }
+
+    double gasto = agoraSegundos() - inicioTurno;
+    if (gasto > niveis[nivelAtual].teto)
+        printf("[IA] Jogada levou %.3fs, acima do teto de %.3fs\n", gasto, niveis[nivelAtual].teto);
+
+    // Sistema de fallback triplo: garante que a IA sempre faça uma jogada válida
+    // Fallback 1: Se a API não responder, usa algoritmo local
+    if (!escolheu && motorIA == MOTOR_GROQ && !resposta_json)
+    {
+        printf("[IA] Falha na API - usando fallback local\n");
+
+        // IA local simples: joga primeira peça válida que encontrar
+        NoMao *atual = maoIA.pecas;
+        while (atual)
+        {
+            if (encaixa(&tabuleiro, atual->peca))
+            {
+                char lado = 'D';
+                if (tabuleiro.inicio)
+                {
+                    if (atual->peca.lado1 == tabuleiro.pontoInicio ||
+                        atual->peca.lado2 == tabuleiro.pontoInicio)
+                    {
+                        lado = 'E';
+                    }
+                }
+
+                if (inserir(&tabuleiro, atual->peca, lado))
+                {
+                    ultimaPecaIA = atual->peca;
+                    ultimoLadoIA = lado;
+                    mostrarJogadaIA = 1;
+                    tempoJogadaIA = 180;
+
+                    printf("[IA] Jogada executada (fallback)\n");
+
+                    registrar(&historico, 2, atual->peca, lado, 'J');
+                    removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
+                    passadas = 0;
+                    break;
+                }
+            }
+            atual = atual->proximo;
+        }
+        turnoAtual = 1;
+        return;
+    }
+
+    // Valida se a resposta da API é uma jogada válida
+    // Verifica se a peça existe na mão da IA e se pode ser encaixada
+    if (escolheu || parseResposta(resposta_json, &pecaEscolhida, &ladoEscolhido))
+    {
+        int temPeca = 0;
+        for (NoMao *atual = maoIA.pecas; atual; atual = atual->proximo)
+        {
+            if ((atual->peca.lado1 == pecaEscolhida.lado1 && atual->peca.lado2 == pecaEscolhida.lado2) ||
+                (atual->peca.lado1 == pecaEscolhida.lado2 && atual->peca.lado2 == pecaEscolhida.lado1))
+            {
+                temPeca = 1;
+                break;
+            }
+        }
+
+        if (temPeca && encaixa(&tabuleiro, pecaEscolhida))
+        {
+            if (inserir(&tabuleiro, pecaEscolhida, ladoEscolhido))
+            {
+                ultimaPecaIA = pecaEscolhida;
+                ultimoLadoIA = ladoEscolhido;
+                mostrarJogadaIA = 1;
+                tempoJogadaIA = 180;
+
+                printf("[IA] Jogada validada (%s)\n", origem);
+
+                char msg[128];
+                snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
+                         pecaEscolhida.lado1, pecaEscolhida.lado2,
+                         ladoEscolhido == 'E' ? "ESQUERDA" : "DIREITA");
+                mostrarMensagem(msg);
+
+                registrar(&historico, 2, pecaEscolhida, ladoEscolhido, 'J');
+                removerPeca(&maoIA, pecaEscolhida.lado1, pecaEscolhida.lado2);
+                passadas = 0;
+            }
+            else
+            {
+                printf("[IA] Resposta invalida da API - usando fallback\n");
+                NoMao *atual = maoIA.pecas;
+                while (atual)
+                {
+                    if (encaixa(&tabuleiro, atual->peca))
+                    {
+                        char lado = 'D';
+                        if (tabuleiro.inicio)
+                        {
+                            if (atual->peca.lado1 == tabuleiro.pontoInicio ||
+                                atual->peca.lado2 == tabuleiro.pontoInicio)
+                            {
+                                lado = 'E';
+                            }
+                        }
+
+                        if (inserir(&tabuleiro, atual->peca, lado))
+                        {
+                            char msg[128];
+                            snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
+                                     atual->peca.lado1, atual->peca.lado2,
+                                     lado == 'E' ? "ESQUERDA" : "DIREITA");
+                            mostrarMensagem(msg);
+
+                            registrar(&historico, 2, atual->peca, lado, 'J');
+                            removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
+                            passadas = 0;
+                            break;
+                        }
+                    }
+                    atual = atual->proximo;
+                }
+            }
+        }
+        else
+        {
+            printf("[IA] Erro ao validar peca - usando fallback\n");
+            NoMao *atual = maoIA.pecas;
+            while (atual)
+            {
+                if (encaixa(&tabuleiro, atual->peca))
+                {
+                    char lado = 'D';
+                    if (tabuleiro.inicio)
+                    {
+                        if (atual->peca.lado1 == tabuleiro.pontoInicio ||
+                            atual->peca.lado2 == tabuleiro.pontoInicio)
+                        {
+                            lado = 'E';
+                        }
+                    }
+
+                    if (inserir(&tabuleiro, atual->peca, lado))
+                    {
+                        char msg[128];
+                        snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
+                                 atual->peca.lado1, atual->peca.lado2,
+                                 lado == 'E' ? "ESQUERDA" : "DIREITA");
+                        mostrarMensagem(msg);
+
+                        registrar(&historico, 2, atual->peca, lado, 'J');
+                        removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
+                        passadas = 0;
+                        break;
+                    }
+                }
+                atual = atual->proximo;
+            }
+        }
+    }
+    else
+    {
+        printf("[IA] Erro ao parsear resposta - usando fallback\n");
+        NoMao *atual = maoIA.pecas;
+        while (atual)
+        {
+            if (encaixa(&tabuleiro, atual->peca))
+            {
+                char lado = 'D';
+                if (tabuleiro.inicio)
+                {
+                    if (atual->peca.lado1 == tabuleiro.pontoInicio ||
+                        atual->peca.lado2 == tabuleiro.pontoInicio)
+                    {
+                        lado = 'E';
+                    }
+                }
+
+                if (inserir(&tabuleiro, atual->peca, lado))
+                {
+                    char msg[128];
+                    snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
+                             atual->peca.lado1, atual->peca.lado2,
+                             lado == 'E' ? "ESQUERDA" : "DIREITA");
+                    mostrarMensagem(msg);
+
+                    registrar(&historico, 2, atual->peca, lado, 'J');
+                    removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
+                    passadas = 0;
+                    break;
+                }
+            }
+            atual = atual->proximo;
+        }
+    }
 
-    DrawText("INTELIGENCIA ARTIFICIAL:", 50, 466, 23, WHITE);
-    DrawText("Groq API - Servico de IA em nuvem", 50, 491, 17, LIGHTGRAY);
-    DrawText("Modelo: Llama 3.3 70B Versatile", 50, 513, 17, LIGHTGRAY);
-    DrawText("IA analisa pecas e decide melhor jogada", 50, 535, 17, LIGHTGRAY);
+    free(resposta_json);
+    turnoAtual = 1;
+}
 
-    DrawRectangle(SCREEN_WIDTH / 2 - 100, 600, 200, 50, BLUE);
-    DrawText("VOLTAR", SCREEN_WIDTH / 2 - 50, 615, 25, WHITE);
+// Jogador humano automático para execuções sem janela: joga a primeira peça
+// válida; sem jogada, compra ou passa - as mesmas ações dos botões da tela
+void jogarHumanoAutomatico()
+{
+    for (NoMao *atual = maoHumano.pecas; atual; atual = atual->proximo)
+    {
+        if (!encaixa(&tabuleiro, atual->peca))
+            continue;
+        Peca peca = atual->peca;
+        char lado = 'D';
+        if (tabuleiro.inicio && (peca.lado1 == tabuleiro.pontoInicio || peca.lado2 == tabuleiro.pontoInicio))
+            lado = 'E';
+        if (inserir(&tabuleiro, peca, lado))
+        {
+            registrar(&historico, 1, peca, lado, 'J');
+            removerPeca(&maoHumano, peca.lado1, peca.lado2);
+            ordenarMao(&maoHumano);
+            passadas = 0;
+            turnoAtual = 2;
+            return;
+        }
+    }
+
+    Peca nova;
+    if (comprar(&monte, &nova))
+    {
+        adicionarPeca(&maoHumano, nova);
+        ordenarMao(&maoHumano);
+        registrar(&historico, 1, nova, '-', 'C');
+        return;
+    }
+    passadas++;
+    turnoAtual = 2;
+    registrar(&historico, 1, (Peca){0, 0}, '-', 'P');
 }
 
-void desenharTelaFim()
+// Benchmark de ponta a ponta do turno da IA: prompt, API, parse, validação e fallback
+// Com a fita em REPRODUZIR não há rede e cada execução repete exatamente as mesmas jogadas
+int benchmarkTurnoIA(int partidas, unsigned semente)
 {
-    DrawText("FIM DE JOGO!", SCREEN_WIDTH / 2 - 180, 100, 50, GOLD);
+    int capacidade = 256, turnos = 0, vitoriasIA = 0;
+    double *tempos = malloc(capacidade * sizeof(double));
+    double inicioTotal = agoraSegundos();
 
-    if (vencedor == 1)
+    for (int p = 0; p < partidas; p++)
     {
-        DrawText("VOCE VENCEU!", SCREEN_WIDTH / 2 - 150, 200, 40, GREEN);
+        srand(semente + p);
+        iniciarJogo();
+        while ((vencedor = verificarVitoria()) == 0)
+        {
+            if (turnoAtual == 1)
+            {
+                jogarHumanoAutomatico();
+                continue;
+            }
+            double inicio = agoraSegundos();
+            processarTurnoIA();
+            if (turnos == capacidade)
+                tempos = realloc(tempos, (capacidade *= 2) * sizeof(double));
+            tempos[turnos++] = agoraSegundos() - inicio;
+        }
+        if (vencedor == 2)
+            vitoriasIA++;
     }
-    else if (vencedor == 2)
+
+    double total = agoraSegundos() - inicioTotal, soma = 0;
+    for (int i = 0; i < turnos; i++)
+        soma += tempos[i];
+    qsort(tempos, turnos, sizeof(double), compararDouble);
+
+    printf("\n=== BENCHMARK DO TURNO DA IA ===\n");
+    printf("Partidas: %d (semente %u) | Vitorias da IA: %d\n", partidas, semente, vitoriasIA);
+    printf("Turnos da IA: %d | Tempo total: %.3fs\n", turnos, total);
+    if (turnos > 0)
+        printf("Por turno: media %.3fms | p50 %.3fms | p95 %.3fms | max %.3fms\n",
+               soma / turnos * 1000.0, tempos[turnos / 2] * 1000.0,
+               tempos[(int)(turnos * 0.95)] * 1000.0, tempos[turnos - 1] * 1000.0);
+    if (fita.modo == FITA_REPRODUZIR)
+        printf("Fita: %d respostas reproduzidas, %d prompts sem gravacao\n", fita.acertos, fita.faltas);
+    if (estatisticasRede.chamadas > 0)
+        printf("Rede: %ld chamadas | media %lld bytes enviados, %lld recebidos (%lld descomprimidos)\n",
+               estatisticasRede.chamadas, estatisticasRede.enviados / estatisticasRede.chamadas,
+               estatisticasRede.recebidos / estatisticasRede.chamadas,
+               estatisticasRede.descomprimidos / estatisticasRede.chamadas);
+    free(tempos);
+    return 0;
+}
+
+// Simulador sem janela: pares de partidas com a mesma distribuição e os
+// lugares trocados, para que nenhuma política seja favorecida pelas peças
+int simularConfronto(Politica *a, Politica *b, int pares, uint64_t semente)
+{
+    int vitoriasA = 0, vitoriasB = 0, empates = 0;
+    double inicio = agoraSegundos();
+    totalBuscaThread = (RelatorioBusca){0, 0, 0, 0};
+
+    for (int k = 0; k < pares; k++)
+        for (int troca = 0; troca < 2; troca++)
+        {
+            Politica *jogadores[2] = {troca ? b : a, troca ? a : b};
+            int fim = simularPartidaMotor(jogadores, semente + k, NULL);
+            if (fim == 3)
+                empates++;
+            else if ((fim == 1) != troca)
+                vitoriasA++;
+            else
+                vitoriasB++;
+        }
+
+    double total = agoraSegundos() - inicio;
+    printf("\n=== %s x %s ===\n", a->nome, b->nome);
+    printf("Partidas: %d (%d pares) em %.2fs (%.0f partidas/s)\n", 2 * pares, pares, total,
+           total > 0 ? 2 * pares / total : 0.0);
+    printf("%s: %d vitorias | %s: %d vitorias | empates: %d\n", a->nome, vitoriasA, b->nome, vitoriasB, empates);
+    if (totalBuscaThread.nos > 0)
+        printf("Busca: %lld nos em %.2fs (%.0f nos/s)\n", totalBuscaThread.nos, totalBuscaThread.segundos,
+               totalBuscaThread.segundos > 0 ? totalBuscaThread.nos / totalBuscaThread.segundos : 0.0);
+    return 0;
+}
+
+// Escalabilidade do MCTS: a mesma posição com 1, 2, 4... threads até todos os
+// núcleos, nos dois modos de paralelismo, com o mesmo tempo por jogada
+int benchmarkMcts(double segundos, int modo, int maxThreads, uint64_t semente)
+{
+    EstadoMotor e;
+    uint64_t sorteio = semente;
+    distribuirMotor(&e, &sorteio);
+    Crenca crenca;
+    iniciarCrenca(&crenca, PECAS_POR_MAO);
+    if (maxThreads <= 0)
+        maxThreads = numeroNucleos();
+
+    printf("\n=== BENCHMARK DO MCTS ===\n");
+    printf("Nucleos: %d | %.2fs por medicao | semente %llu\n", numeroNucleos(), segundos, (unsigned long long)semente);
+    for (int m = MCTS_RAIZ; m <= MCTS_ARVORE; m++)
     {
-        DrawText("IA VENCEU!", SCREEN_WIDTH / 2 - 120, 200, 40, RED);
+        if (modo >= 0 && m != modo)
+            continue;
+        printf("Modo %s:\n", m == MCTS_RAIZ ? "raiz" : "arvore");
+        double base = 0;
+        for (int t = 1;; t = t * 2 < maxThreads ? t * 2 : maxThreads)
+        {
+            ConfigMcts cfg = configMctsIA;
+            cfg.modo = (ModoMcts)m;
+            cfg.threads = t;
+            cfg.tempoLimite = segundos;
+            cfg.maxIteracoes = 0;
+            RelatorioMcts rel;
+            uint64_t s = semente;
+            Lance l = buscarLanceMcts(&e, &crenca, &cfg, &s, &rel);
+            double taxa = rel.segundos > 0 ? rel.iteracoes / rel.segundos : 0;
+            if (t == 1)
+                base = taxa;
+            printf("  %2d threads: %9lld playouts (%9.0f/s) | speedup %5.2fx | %7d nos | lance [%d|%d] %s | vitoria %.0f%%\n",
+                   t, rel.iteracoes, taxa, base > 0 ? taxa / base : 0.0, rel.nos,
+                   pecaMotor[l.peca].lado1, pecaMotor[l.peca].lado2, l.lado ? "D" : "E", rel.valor * 100.0);
+            if (t == maxThreads)
+                break;
+        }
     }
-    else
+    return 0;
+}
+
+// Perft: percorre a árvore de lances até 'prof' sobre as próprias listas do
+// jogo, só com fazerJogada/desfazerJogada, e conta as folhas. Confere que cada
+// desfazer devolve exatamente a chave anterior. Jogar ou passar troca a vez;
+// comprar mantém a vez (compra até poder jogar).
+long long perftJogo(Partida *p, int jogador, int prof, long long *erros)
+{
+    if (prof == 0 || !p->maos[0]->quantidade || !p->maos[1]->quantidade || *p->passadas >= 2 || jogoTravado(p->tab))
+        return 1;
+
+    Peca pecas[2 * NUM_PECAS];
+    char lados[2 * NUM_PECAS];
+    int n = 0;
+    Tabuleiro *tab = p->tab;
+    for (NoMao *atual = p->maos[jogador - 1]->pecas; atual; atual = atual->proximo)
     {
-        DrawText("EMPATE!", SCREEN_WIDTH / 2 - 90, 200, 40, YELLOW);
+        Peca pc = atual->peca;
+        if (!tab->inicio)
+        {
+            pecas[n] = pc, lados[n++] = 'E';
+            continue;
+        }
+        if (pc.lado1 == tab->pontoInicio || pc.lado2 == tab->pontoInicio)
+            pecas[n] = pc, lados[n++] = 'E';
+        if ((pc.lado1 == tab->pontoFim || pc.lado2 == tab->pontoFim) && tab->pontoFim != tab->pontoInicio)
+            pecas[n] = pc, lados[n++] = 'D';
     }
 
-    DrawText(TextFormat("Sua pontuacao: %d pts (%d pecas)",
-                        calcularPontos(&maoHumano), maoHumano.quantidade),
-             SCREEN_WIDTH / 2 - 220, 300, 23, WHITE);
-    DrawText(TextFormat("IA: %d pts (%d pecas)",
-                        calcularPontos(&maoIA), maoIA.quantidade),
-             SCREEN_WIDTH / 2 - 220, 340, 23, WHITE);
+    uint64_t antes = chavePartida(p, jogador);
+    long long total = 0;
+    if (n == 0)
+    {
+        char tipo = p->monte->topo >= 0 ? 'C' : 'P';
+        fazerJogada(p, jogador, (Peca){0, 0}, '-', tipo);
+        total = perftJogo(p, tipo == 'C' ? jogador : 3 - jogador, prof - 1, erros);
+        desfazerJogada(p);
+        if (chavePartida(p, jogador) != antes)
+            (*erros)++;
+        return total;
+    }
 
-    DrawRectangle(SCREEN_WIDTH / 2 - 100, 450, 200, 50, BLUE);
-    DrawText("MENU", SCREEN_WIDTH / 2 - 40, 465, 25, WHITE);
+    for (int i = 0; i < n; i++)
+    {
+        if (!fazerJogada(p, jogador, pecas[i], lados[i], 'J'))
+        {
+            (*erros)++;
+            continue;
+        }
+        total += perftJogo(p, 3 - jogador, prof - 1, erros);
+        desfazerJogada(p);
+        if (chavePartida(p, jogador) != antes)
+            (*erros)++;
+    }
+    return total;
 }
 
-void iniciarJogo()
+// Refaz no motor de bits o histórico de uma partida jogada pelas listas (tela,
+// IA e humano automático), partindo do estado 'inicio'. Cada jogada precisa
+// estar entre os lances de gerarLances(), compra e passe só valem quando são
+// o único lance, e a vez tem de bater lance a lance. As compras que encerram
+// um jogo travado (verificarVitoria) são aceitas depois do fim. No fim, o
+// estado e o resultado têm de ser os mesmos do jogo.
+// Retorna -1 se tudo bate, ou o índice do primeiro lance divergente
+int conferirPartidaMotor(EstadoMotor e, const Historico *hist, const EstadoMotor *final, int vencedor)
 {
-    inicializar(&tabuleiro, &maoHumano, &maoIA, &monte, &historico);
-    distribuir(&maoHumano, &maoIA, &monte);
-    ordenarMao(&maoHumano);
-    ordenarMao(&maoIA);
-    turnoAtual = 1;
-    passadas = 0;
-    vencedor = 0;
-    pecaSelecionada = -1;
-    ladoEscolhido = 'E';
-    mostrarJogadaIA = 0;
-    tempoJogadaIA = 0;
-    ultimaPecaIA.lado1 = -1;
-    ultimaPecaIA.lado2 = -1;
-    ultimoLadoIA = '-';
-    mostrarMensagem("Jogo iniciado! Sua vez!");
+    for (int i = 0; i <= hist->topo; i++)
+    {
+        const Jogada *j = &hist->jogadas[i];
+        int peca = indicePeca[j->peca.lado1][j->peca.lado2];
+        if (j->jogador - 1 != e.vez)
+            return i;
+        if (fimMotor(&e))
+        {
+            // Acerto do jogo travado: quem tem a vez leva o monte
+            if (j->tipo != 'C' || !(e.monte & BIT_PECA(peca)))
+                return i;
+            comprarPecaMotor(&e, peca);
+            continue;
+        }
+
+        Lance lances[MAX_LANCES];
+        int n = gerarLances(&e, lances), achou = 0;
+        if (j->tipo == 'C' || j->tipo == 'P')
+        {
+            int esperado = j->tipo == 'C' ? LANCE_COMPRAR : LANCE_PASSAR;
+            if (lances[0].peca != esperado)
+                return i;
+            if (j->tipo == 'C')
+            {
+                if (!(e.monte & BIT_PECA(peca)))
+                    return i;
+                comprarPecaMotor(&e, peca);
+            }
+            else
+                aplicarLance(&e, lances[0]);
+            continue;
+        }
+
+        // Com as pontas iguais o motor só gera o lado esquerdo
+        int lado = (j->lado == 'D' || j->lado == 'd') && e.pontas[0] != e.pontas[1];
+        for (int k = 0; k < n && !achou; k++)
+            if (lances[k].peca == peca && (e.pontas[0] < 0 || lances[k].lado == lado))
+            {
+                aplicarLance(&e, lances[k]);
+                achou = 1;
+            }
+        if (!achou)
+            return i;
+    }
+
+    if (e.mao[0] != final->mao[0] || e.mao[1] != final->mao[1] || e.monte != final->monte ||
+        e.mesa != final->mesa || fimMotor(&e) != vencedor)
+        return hist->topo + 1;
+    // Pontas só se comparam como conjunto: o motor joga sempre à esquerda com pontas iguais
+    if (!((e.pontas[0] == final->pontas[0] && e.pontas[1] == final->pontas[1]) ||
+          (e.pontas[0] == final->pontas[1] && e.pontas[1] == final->pontas[0])))
+        return hist->topo + 1;
+    return -1;
 }
 
-// Verifica as condições de vitória do jogo
-// Retorna: 1 = humano venceu, 2 = IA venceu, 3 = empate, 0 = jogo continua
-int verificarVitoria()
+// Conferência da crença por força bruta, num baralho pequeno: enumera todas
+// as trajetórias da mão do adversário (mão inicial, cada compra, cada jogada)
+// compatíveis com os eventos e compara a frequência de cada peça na mão final
+// com probabilidadesCrenca() e probabilidadeSeguirCrenca()
+typedef struct
 {
-    if (maoHumano.quantidade == 0)
-        return 1;
-    if (maoIA.quantidade == 0)
-        return 2;
-    if (passadas >= 2)
+    char tipo; // 'V' vazio, 'C' compra, 'J' jogada
+    int a, b, peca;
+} EventoCrenca;
+
+typedef struct
+{
+    EventoCrenca eventos[32];
+    int numEventos;
+    MascaraPecas universo; // peças que podem ter passado pela mão dele
+    double mundos, naMao[NUM_PECAS], seguir[NUM_PONTOS];
+} ForcaBrutaCrenca;
+
+static void trajetoriasCrenca(ForcaBrutaCrenca *f, int i, MascaraPecas mao, MascaraPecas vistas)
+{
+    if (i == f->numEventos)
     {
-        int pts1 = calcularPontos(&maoHumano);
-        int pts2 = calcularPontos(&maoIA);
-        if (pts1 < pts2)
+        f->mundos += 1;
+        for (MascaraPecas m = mao; m; m &= m - 1)
+            f->naMao[primeiraPeca(m)] += 1;
+        for (int p = 0; p < NUM_PONTOS; p++)
+            if (mao & pecasComPonto[p])
+                f->seguir[p] += 1;
+        return;
+    }
+    const EventoCrenca *ev = &f->eventos[i];
+    if (ev->tipo == 'V' && !(mao & (pecasComPonto[ev->a] | pecasComPonto[ev->b])))
+        trajetoriasCrenca(f, i + 1, mao, vistas);
+    else if (ev->tipo == 'J' && (mao & BIT_PECA(ev->peca)))
+        trajetoriasCrenca(f, i + 1, mao & ~BIT_PECA(ev->peca), vistas);
+    else if (ev->tipo == 'C')
+        for (MascaraPecas m = f->universo & ~vistas; m; m &= m - 1)
+            trajetoriasCrenca(f, i + 1, mao | BIT_PECA(primeiraPeca(m)), vistas | BIT_PECA(primeiraPeca(m)));
+}
+
+static void maosIniciaisCrenca(ForcaBrutaCrenca *f, MascaraPecas resto, int faltam, MascaraPecas mao)
+{
+    if (faltam == 0)
+    {
+        trajetoriasCrenca(f, 0, mao, mao);
+        return;
+    }
+    if (!resto)
+        return;
+    int p = primeiraPeca(resto);
+    maosIniciaisCrenca(f, resto & ~BIT_PECA(p), faltam - 1, mao | BIT_PECA(p));
+    maosIniciaisCrenca(f, resto & ~BIT_PECA(p), faltam, mao);
+}
+
+// Cenários aleatórios com 8 a 11 peças ocultas e mão inicial de 2 a 4;
+// os eventos saem de uma partida de verdade, então são sempre consistentes
+int conferirCrenca(int cenarios, uint64_t semente)
+{
+    static ForcaBrutaCrenca f;
+    double piorPeca = 0, piorSeguir = 0;
+    for (int c = 0; c < cenarios; c++)
+    {
+        int tamanho = 8 + aleatorioAte(&semente, 4), inicial = 2 + aleatorioAte(&semente, 3);
+        int ordem[NUM_PECAS], n = 0, topo = 0;
+        memset(&f, 0, sizeof(f));
+        while (contarPecas(f.universo) < tamanho)
+            f.universo |= BIT_PECA(aleatorioAte(&semente, NUM_PECAS));
+        for (MascaraPecas m = f.universo; m; m &= m - 1)
+            ordem[n++] = primeiraPeca(m);
+        for (int i = n - 1; i > 0; i--)
+        {
+            int j = aleatorioAte(&semente, i + 1), t = ordem[i];
+            ordem[i] = ordem[j];
+            ordem[j] = t;
+        }
+
+        MascaraPecas mao = 0, jogadas = 0;
+        for (; topo < inicial; topo++)
+            mao |= BIT_PECA(ordem[topo]);
+        Crenca crenca;
+        iniciarCrenca(&crenca, inicial);
+        for (int passo = 5 + aleatorioAte(&semente, 6); passo > 0; passo--)
+        {
+            EventoCrenca *ev = &f.eventos[f.numEventos];
+            int acao = aleatorioAte(&semente, 3);
+            if (acao == 0)
+            {
+                int a = aleatorioAte(&semente, NUM_PONTOS), b = aleatorioAte(&semente, NUM_PONTOS);
+                if (mao & (pecasComPonto[a] | pecasComPonto[b]))
+                    continue;
+                *ev = (EventoCrenca){'V', a, b, 0};
+                crencaVazio(&crenca, a, b);
+            }
+            else if (acao == 1 && topo < n)
+            {
+                mao |= BIT_PECA(ordem[topo++]);
+                *ev = (EventoCrenca){'C', 0, 0, 0};
+                crencaCompra(&crenca);
+            }
+            else if (acao == 2 && mao)
+            {
+                int p = sortearPeca(mao, &semente);
+                mao &= ~BIT_PECA(p);
+                jogadas |= BIT_PECA(p);
+                *ev = (EventoCrenca){'J', 0, 0, p};
+                crencaJogada(&crenca, p);
+            }
+            else
+                continue;
+            f.numEventos++;
+        }
+
+        maosIniciaisCrenca(&f, f.universo, inicial, 0);
+        MascaraPecas ocultas = f.universo & ~jogadas;
+        double prob[NUM_PECAS];
+        probabilidadesCrenca(&crenca, ocultas, prob);
+        for (MascaraPecas m = ocultas; m; m &= m - 1)
+        {
+            int p = primeiraPeca(m);
+            piorPeca = fmax(piorPeca, fabs(prob[p] - f.naMao[p] / f.mundos));
+        }
+        for (int p = 0; p < NUM_PONTOS; p++)
+            piorSeguir = fmax(piorSeguir, fabs(probabilidadeSeguirCrenca(&crenca, ocultas, (MascaraPontos)(1u << p)) -
+                                               f.seguir[p] / f.mundos));
+    }
+    printf("%d cenarios: maior diferenca %.2g por peca, %.2g para seguir num numero\n", cenarios, piorPeca, piorSeguir);
+    return piorPeca > 1e-9 || piorSeguir > 1e-9;
+}
+
+// Joga partidas completas pela tela (processarTurnoIA contra o humano
+// automático) e confere cada uma contra o motor com conferirPartidaMotor()
+int conferirRegras(int partidas, unsigned semente)
+{
+    MotorIA motorAntes = motorIA;
+    int primeiroAntes = disputa.primeiro, divergentes = 0, lances = 0, compras = 0;
+    motorIA = MOTOR_HEURISTICA;
+    for (int p = 0; p < partidas; p++)
+    {
+        srand(semente + p);
+        disputa.primeiro = p & 1;
+        iniciarJogo();
+        EstadoMotor inicio = estadoDoJogo();
+        while ((vencedor = verificarVitoria()) == 0)
+        {
+            if (turnoAtual == 1)
+                jogarHumanoAutomatico();
+            else
+                processarTurnoIA();
+        }
+        // verificarVitoria() deixa as compras do jogo travado com a vez de antes
+        EstadoMotor final = estadoDoJogo();
+        int erro = conferirPartidaMotor(inicio, &historico, &final, vencedor);
+        for (int i = 0; i <= historico.topo; i++)
+            compras += historico.jogadas[i].tipo == 'C';
+        lances += historico.topo + 1;
+        if (erro >= 0)
+        {
+            divergentes++;
+            if (erro <= historico.topo)
+            {
+                const Jogada *j = &historico.jogadas[erro];
+                printf("Partida %d: lance %d (jogador %d, %c [%d|%d] %c) diverge do motor\n", p, erro,
+                       j->jogador, j->tipo, j->peca.lado1, j->peca.lado2, j->lado);
+            }
+            else
+                printf("Partida %d: estado final ou resultado diferente do motor\n", p);
+        }
+    }
+    motorIA = motorAntes;
+    disputa.primeiro = primeiroAntes;
+    printf("%d partidas, %d lances (%d compras): %d divergente(s)\n", partidas, lances, compras, divergentes);
+    return divergentes ? 1 : 0;
+}
+
+// Modos sem janela, usados para benchmarks e ferramentas
+//   --bench-ia <fita> [partidas] [--gravar] [--latencia] [--semente N]
+//   --simular <politicaA> <politicaB> [pares] [--semente N]
+//   --perft <profundidade> [--semente N]
+//   --conferir-regras [partidas] [--semente N]
+//   --conferir-crenca [cenarios] [--semente N]
+//   --bench-mcts [segundos] [--modo raiz|arvore] [--threads N] [--semente N]
+//   --gerar-tablebase <arquivo> [pecas por mao] [--threads N]
+//   --gerar-livro <arquivo> [playouts por mao] [--maos N] [--threads N]
+//   --tunar <arquivo> [iteracoes] [--pares N] [--threads N] [--semente N]
+//   --sprt <politicaA> <politicaB> [--elo0 X] [--elo1 Y] [--alfa a] [--beta b] [--max N] [--threads N] [--semente N]
+//   --destilar <arquivo> [partidas] [--professor P] [--epocas N] [--threads N] [--semente N]
+//   --gerar-desafios <arquivo> [quantidade] [--min-pecas N] [--threads N] [--semente N]
+//   --cfr <3|4> [iteracoes] [--mao N] [--abstracao exata|mesa] [--a-cada N] [--checkpoint arq] [--retomar arq]
+//         [--sem-explorabilidade] [--bits N] [--threads N] [--semente N]
+//   --duplas <A> <B> [pares] [--lugares 2|4] [--threads N] [--semente N]
+//   --disputa <A> <B> [pares] [--alvo N] [--threads N] [--semente N]
+//   --torneio [politicas...] [--pares N] [--threads N] [--semente N] [--saida arq] [--fita arq [--gravar]]
+int executarLinhaComando(int argc, char **argv)
+{
+    if (strcmp(argv[1], "--gerar-desafios") == 0 && argc >= 3)
+    {
+        int quantidade = 1000, minPecas = 6, threads = numeroNucleos();
+        uint64_t semente = 1;
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--min-pecas") == 0 && i + 1 < argc)
+                minPecas = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else
+                quantidade = atoi(argv[i]);
+        }
+        if (quantidade < 1 || threads < 1 || !gerarDesafios(argv[2], quantidade, minPecas, threads, semente))
+        {
+            printf("Nao foi possivel gerar %s\n", argv[2]);
             return 1;
-        if (pts2 < pts1)
-            return 2;
-        return 3;
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--destilar") == 0 && argc >= 3)
+    {
+        Politica *professor = acharPolitica("mcts");
+        int partidas = 2000, epocas = 8, threads = numeroNucleos();
+        uint64_t semente = 1;
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--professor") == 0 && i + 1 < argc)
+                professor = acharPolitica(argv[++i]);
+            else if (strcmp(argv[i], "--epocas") == 0 && i + 1 < argc)
+                epocas = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else
+                partidas = atoi(argv[i]);
+        }
+        if (!professor || partidas < 1 || epocas < 1 || threads < 1 ||
+            !destilarPolitica(argv[2], professor, partidas, epocas, threads, semente))
+        {
+            printf("Nao foi possivel destilar para %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+
+    if (strcmp(argv[1], "--cfr") == 0 && argc >= 3)
+    {
+        ConfigCfr cfg = {atoi(argv[2]), 2, ABSTRACAO_EXATA, 100000, 20000, numeroNucleos(), 1, 20, NULL, NULL, 1};
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--mao") == 0 && i + 1 < argc)
+                cfg.tamanhoMao = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--abstracao") == 0 && i + 1 < argc)
+                cfg.abstracao = strcmp(argv[++i], "mesa") == 0 ? ABSTRACAO_MESA : ABSTRACAO_EXATA;
+            else if (strcmp(argv[i], "--a-cada") == 0 && i + 1 < argc)
+                cfg.aCada = atoll(argv[++i]);
+            else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc)
+                cfg.checkpoint = argv[++i];
+            else if (strcmp(argv[i], "--retomar") == 0 && i + 1 < argc)
+                cfg.retomar = argv[++i];
+            else if (strcmp(argv[i], "--sem-explorabilidade") == 0)
+                cfg.calcularExplorabilidade = 0;
+            else if (strcmp(argv[i], "--bits") == 0 && i + 1 < argc)
+                cfg.bitsTabela = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                cfg.threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                cfg.semente = strtoull(argv[++i], NULL, 10);
+            else
+                cfg.iteracoes = atoll(argv[i]);
+        }
+        if (cfg.maxPonto < 2 || cfg.maxPonto > 4 || cfg.tamanhoMao < 1 || cfg.iteracoes < 1 || cfg.aCada < 1 ||
+            cfg.threads < 1 || cfg.bitsTabela < 10 || cfg.bitsTabela > 28 || resolverCfr(&cfg) != 0)
+        {
+            printf("Parametros invalidos para o CFR\n");
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "--sprt") == 0 && argc >= 4)
+    {
+        Politica *a = acharPolitica(argv[2]), *b = acharPolitica(argv[3]);
+        ConfigSprt cfg = {0.0, 10.0, 0.05, 0.05, 100000};
+        int threads = numeroNucleos();
+        uint64_t semente = 1;
+        for (int i = 4; i + 1 < argc; i += 2)
+        {
+            if (strcmp(argv[i], "--elo0") == 0)
+                cfg.elo0 = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--elo1") == 0)
+                cfg.elo1 = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--alfa") == 0)
+                cfg.alfa = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--beta") == 0)
+                cfg.beta = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--max") == 0)
+                cfg.maxPares = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--threads") == 0)
+                threads = atoi(argv[i + 1]);
+            else if (strcmp(argv[i], "--semente") == 0)
+                semente = strtoull(argv[i + 1], NULL, 10);
+        }
+        if (!a || !b || threads < 1 || cfg.maxPares < 1 || cfg.alfa <= 0 || cfg.beta <= 0 || cfg.elo1 <= cfg.elo0)
+        {
+            printf("Parametros invalidos. Politicas:");
+            for (int i = 0; i < NUM_POLITICAS; i++)
+                printf(" %s", politicas[i].nome);
+            printf("\n");
+            return 1;
+        }
+        return executarSprt(a, b, &cfg, threads, semente);
+    }
+    if (strcmp(argv[1], "--tunar") == 0 && argc >= 3)
+    {
+        int iteracoes = 200, pares = 200, threads = numeroNucleos();
+        uint64_t semente = 1;
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--pares") == 0 && i + 1 < argc)
+                pares = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else
+                iteracoes = atoi(argv[i]);
+        }
+        if (iteracoes < 1 || pares < 1 || threads < 1 || !tunarPesos(argv[2], iteracoes, pares, threads, semente))
+        {
+            printf("Nao foi possivel gravar %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "--gerar-livro") == 0 && argc >= 3)
+    {
+        int iteracoes = 20000, threads = numeroNucleos();
+        uint64_t maos = 0;
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--maos") == 0 && i + 1 < argc)
+                maos = strtoull(argv[++i], NULL, 10);
+            else
+                iteracoes = atoi(argv[i]);
+        }
+        if (iteracoes < 1 || threads < 1 || !gerarLivroAbertura(argv[2], iteracoes, maos, threads))
+        {
+            printf("Nao foi possivel gerar %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "--gerar-tablebase") == 0 && argc >= 3)
+    {
+        int maxPecas = 2, threads = numeroNucleos();
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else
+                maxPecas = atoi(argv[i]);
+        }
+        if (maxPecas < 1 || maxPecas > MAX_PECAS_TABLEBASE || threads < 1)
+        {
+            printf("Pecas por mao: 1 a %d\n", MAX_PECAS_TABLEBASE);
+            return 1;
+        }
+        if (!gerarTablebase(argv[2], maxPecas, threads))
+        {
+            printf("Nao foi possivel gravar %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "--perft") == 0 && argc >= 3)
+    {
+        int prof = atoi(argv[2]);
+        unsigned semente = (argc >= 5 && strcmp(argv[3], "--semente") == 0) ? (unsigned)atoi(argv[4]) : 1;
+        srand(semente);
+        iniciarJogo();
+        for (int d = 1; d <= prof; d++)
+        {
+            long long erros = 0;
+            double inicio = agoraSegundos();
+            long long folhas = perftJogo(&partidaAtual, turnoAtual, d, &erros);
+            double t = agoraSegundos() - inicio;
+            printf("perft(%d) = %lld folhas em %.3fs (%.0f/s) | erros ao desfazer: %lld\n",
+                   d, folhas, t, t > 0 ? folhas / t : 0.0, erros);
+        }
+        return 0;
+    }
+    if (strcmp(argv[1], "--conferir-regras") == 0)
+    {
+        int partidas = 200;
+        unsigned semente = 1;
+        for (int i = 2; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = (unsigned)atoi(argv[++i]);
+            else
+                partidas = atoi(argv[i]);
+        }
+        return conferirRegras(partidas, semente);
+    }
+    if (strcmp(argv[1], "--conferir-crenca") == 0)
+    {
+        int cenarios = 2000;
+        uint64_t semente = 1;
+        for (int i = 2; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else
+                cenarios = atoi(argv[i]);
+        }
+        return conferirCrenca(cenarios, semente);
     }
-    return 0;
-}
-
-// Processa o turno da IA: chama API Groq ou usa fallback local
-void processarTurnoIA()
-{
-    // Se IA não tem jogadas válidas, compra ou passa
-    if (contarJogadas(&maoIA, &tabuleiro) == 0)
+    if (strcmp(argv[1], "--simular") == 0 && argc >= 4)
     {
-        Peca nova;
-        if (comprar(&monte, &nova))
+        Politica *a = acharPolitica(argv[2]), *b = acharPolitica(argv[3]);
+        int pares = 100;
+        uint64_t semente = 1;
+        for (int i = 4; i < argc; i++)
         {
-            adicionarPeca(&maoIA, nova);
-            ordenarMao(&maoIA);
-            mostrarMensagem("IA comprou uma peca");
-            registrar(&historico, 2, nova, '-', 'C');
+            if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else
+                pares = atoi(argv[i]);
         }
-        else
+        if (!a || !b)
         {
-            mostrarMensagem("IA passou a vez");
-            passadas++;
-            registrar(&historico, 2, (Peca){0, 0}, '-', 'P');
+            printf("Politica desconhecida. Disponiveis:");
+            for (int i = 0; i < NUM_POLITICAS; i++)
+                printf(" %s", politicas[i].nome);
+            printf("\n");
+            return 1;
         }
-        turnoAtual = 1;
-        return;
+        return simularConfronto(a, b, pares, semente);
     }
-
-    printf("[IA] Processando turno...\n");
-
-    char *prompt = construirPromptIA(&maoIA, &tabuleiro);
-    char *resposta_json = chamarGroqAPI(prompt);
-
-    // Sistema de fallback triplo: garante que a IA sempre faça uma jogada válida
-    // Fallback 1: Se a API não responder, usa algoritmo local
-    if (!resposta_json)
+    if (strcmp(argv[1], "--duplas") == 0 && argc >= 4)
     {
-        printf("[IA] Falha na API - usando fallback local\n");
-
-        // IA local simples: joga primeira peça válida que encontrar
-        NoMao *atual = maoIA.pecas;
-        while (atual)
+        PoliticaMesa *a = acharPoliticaMesa(argv[2]), *b = acharPoliticaMesa(argv[3]);
+        int pares = 1000, lugares = 4, threads = numeroNucleos();
+        uint64_t semente = 1;
+        for (int i = 4; i < argc; i++)
         {
-            if (encaixa(&tabuleiro, atual->peca))
-            {
-                char lado = 'D';
-                if (tabuleiro.inicio)
-                {
-                    if (atual->peca.lado1 == tabuleiro.pontoInicio ||
-                        atual->peca.lado2 == tabuleiro.pontoInicio)
-                    {
-                        lado = 'E';
-                    }
-                }
-
-                if (inserir(&tabuleiro, atual->peca, lado))
-                {
-                    ultimaPecaIA = atual->peca;
-                    ultimoLadoIA = lado;
-                    mostrarJogadaIA = 1;
-                    tempoJogadaIA = 180;
-
-                    printf("[IA] Jogada executada (fallback)\n");
-
-                    registrar(&historico, 2, atual->peca, lado, 'J');
-                    removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
-                    passadas = 0;
-                    break;
-                }
-            }
-            atual = atual->proximo;
+            if (strcmp(argv[i], "--lugares") == 0 && i + 1 < argc)
+                lugares = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else
+                pares = atoi(argv[i]);
         }
-        turnoAtual = 1;
-        return;
+        if (!a || !b || (lugares != 2 && lugares != 4) || threads < 1)
+        {
+            printf("Uso: --duplas A B [pares] [--lugares 2|4] [--threads N] [--semente N]. Politicas:");
+            for (int i = 0; i < NUM_POLITICAS_MESA; i++)
+                printf(" %s", politicasMesa[i].nome);
+            printf("\n");
+            return 1;
+        }
+        return simularDuplas(a, b, lugares, pares, semente, threads);
     }
-
-    Peca pecaEscolhida;
-    char ladoEscolhido;
-
-    // Valida se a resposta da API é uma jogada válida
-    // Verifica se a peça existe na mão da IA e se pode ser encaixada
-    if (parseResposta(resposta_json, &pecaEscolhida, &ladoEscolhido))
+    if (strcmp(argv[1], "--torneio") == 0)
     {
-        int temPeca = 0;
-        for (NoMao *atual = maoIA.pecas; atual; atual = atual->proximo)
+        Politica *lista[MAX_TORNEIO];
+        int n = 0, pares = 200, threads = numeroNucleos(), gravar = 0;
+        uint64_t semente = 1;
+        const char *saida = "torneio.csv", *arquivoFita = NULL;
+        for (int i = 2; i < argc; i++)
         {
-            if ((atual->peca.lado1 == pecaEscolhida.lado1 && atual->peca.lado2 == pecaEscolhida.lado2) ||
-                (atual->peca.lado1 == pecaEscolhida.lado2 && atual->peca.lado2 == pecaEscolhida.lado1))
+            if (strcmp(argv[i], "--pares") == 0 && i + 1 < argc)
+                pares = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else if (strcmp(argv[i], "--saida") == 0 && i + 1 < argc)
+                saida = argv[++i];
+            else if (strcmp(argv[i], "--fita") == 0 && i + 1 < argc)
+                arquivoFita = argv[++i];
+            else if (strcmp(argv[i], "--gravar") == 0)
+                gravar = 1;
+            else if (n < MAX_TORNEIO && (lista[n] = acharCompetidor(argv[i])) != NULL)
+                n++;
+            else
             {
-                temPeca = 1;
-                break;
+                printf("Politica desconhecida ou demais: %s. Disponiveis: modelo", argv[i]);
+                for (int j = 0; j < NUM_POLITICAS; j++)
+                    printf(" %s", politicas[j].nome);
+                printf("\n");
+                return 1;
             }
         }
-
-        if (temPeca && encaixa(&tabuleiro, pecaEscolhida))
+        if (arquivoFita && !configurarFita(&fita, gravar ? FITA_GRAVAR : FITA_REPRODUZIR, arquivoFita, 0))
         {
-            if (inserir(&tabuleiro, pecaEscolhida, ladoEscolhido))
-            {
-                ultimaPecaIA = pecaEscolhida;
-                ultimoLadoIA = ladoEscolhido;
-                mostrarJogadaIA = 1;
-                tempoJogadaIA = 180;
-
-                printf("[IA] Jogada validada pela API\n");
-
-                char msg[128];
-                snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
-                         pecaEscolhida.lado1, pecaEscolhida.lado2,
-                         ladoEscolhido == 'E' ? "ESQUERDA" : "DIREITA");
-                mostrarMensagem(msg);
-
-                registrar(&historico, 2, pecaEscolhida, ladoEscolhido, 'J');
-                removerPeca(&maoIA, pecaEscolhida.lado1, pecaEscolhida.lado2);
-                passadas = 0;
-            }
+            printf("Nao foi possivel abrir a fita %s\n", arquivoFita);
+            return 1;
+        }
+        // Sem lista: o fallback, a gulosa, a heurística e o MCTS em três
+        // orçamentos; o modelo entra quando há fita ou servidor próprio
+        if (n == 0)
+        {
+            const char *padrao[] = {"primeira", "gulosa", "heuristica", "mcts-1k", "mcts-10k", "mcts"};
+            for (int i = 0; i < (int)(sizeof(padrao) / sizeof(padrao[0])); i++)
+                lista[n++] = acharCompetidor(padrao[i]);
+            if (arquivoFita || strcmp(urlGroq, GROQ_API_URL) != 0)
+                lista[n++] = &politicaModeloTorneio;
+        }
+        if (n < 2 || pares < 1 || threads < 1)
+        {
+            printf("Uso: --torneio [politicas...] [--pares N] [--threads N] [--semente N] [--saida arq] [--fita arq [--gravar]]\n");
+            return 1;
+        }
+        int codigo = jogarTorneio(lista, n, pares, threads, semente, saida);
+        if (fita.modo == FITA_REPRODUZIR)
+            printf("Fita: %d respostas reproduzidas, %d prompts sem gravacao\n", fita.acertos, fita.faltas);
+        return codigo;
+    }
+    if (strcmp(argv[1], "--disputa") == 0 && argc >= 4)
+    {
+        Politica *a = acharPolitica(argv[2]), *b = acharPolitica(argv[3]);
+        int pares = 100, alvo = ALVO_PADRAO, threads = numeroNucleos();
+        uint64_t semente = 1;
+        for (int i = 4; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--alvo") == 0 && i + 1 < argc)
+                alvo = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
             else
-            {
-                printf("[IA] Resposta invalida da API - usando fallback\n");
-                NoMao *atual = maoIA.pecas;
-                while (atual)
-                {
-                    if (encaixa(&tabuleiro, atual->peca))
-                    {
-                        char lado = 'D';
-                        if (tabuleiro.inicio)
-                        {
-                            if (atual->peca.lado1 == tabuleiro.pontoInicio ||
-                                atual->peca.lado2 == tabuleiro.pontoInicio)
-                            {
-                                lado = 'E';
-                            }
-                        }
-
-                        if (inserir(&tabuleiro, atual->peca, lado))
-                        {
-                            char msg[128];
-                            snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
-                                     atual->peca.lado1, atual->peca.lado2,
-                                     lado == 'E' ? "ESQUERDA" : "DIREITA");
-                            mostrarMensagem(msg);
-
-                            registrar(&historico, 2, atual->peca, lado, 'J');
-                            removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
-                            passadas = 0;
-                            break;
-                        }
-                    }
-                    atual = atual->proximo;
-                }
-            }
+                pares = atoi(argv[i]);
         }
-        else
+        if (!a || !b || threads < 1)
         {
-            printf("[IA] Erro ao validar peca - usando fallback\n");
-            NoMao *atual = maoIA.pecas;
-            while (atual)
-            {
-                if (encaixa(&tabuleiro, atual->peca))
-                {
-                    char lado = 'D';
-                    if (tabuleiro.inicio)
-                    {
-                        if (atual->peca.lado1 == tabuleiro.pontoInicio ||
-                            atual->peca.lado2 == tabuleiro.pontoInicio)
-                        {
-                            lado = 'E';
-                        }
-                    }
-
-                    if (inserir(&tabuleiro, atual->peca, lado))
-                    {
-                        char msg[128];
-                        snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
-                                 atual->peca.lado1, atual->peca.lado2,
-                                 lado == 'E' ? "ESQUERDA" : "DIREITA");
-                        mostrarMensagem(msg);
-
-                        registrar(&historico, 2, atual->peca, lado, 'J');
-                        removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
-                        passadas = 0;
-                        break;
-                    }
-                }
-                atual = atual->proximo;
-            }
+            printf("Uso: --disputa A B [pares] [--alvo N] [--threads N] [--semente N]. Politicas:");
+            for (int i = 0; i < NUM_POLITICAS; i++)
+                printf(" %s", politicas[i].nome);
+            printf("\n");
+            return 1;
         }
+        return simularDisputa(a, b, alvo, pares, semente, threads);
     }
-    else
+
+    if (strcmp(argv[1], "--bench-mcts") == 0)
     {
-        printf("[IA] Erro ao parsear resposta - usando fallback\n");
-        NoMao *atual = maoIA.pecas;
-        while (atual)
+        double segundos = 1.0;
+        int modo = -1, threads = 0;
+        uint64_t semente = 1;
+        for (int i = 2; i < argc; i++)
         {
-            if (encaixa(&tabuleiro, atual->peca))
+            if (strcmp(argv[i], "--modo") == 0 && i + 1 < argc)
             {
-                char lado = 'D';
-                if (tabuleiro.inicio)
-                {
-                    if (atual->peca.lado1 == tabuleiro.pontoInicio ||
-                        atual->peca.lado2 == tabuleiro.pontoInicio)
-                    {
-                        lado = 'E';
-                    }
-                }
-
-                if (inserir(&tabuleiro, atual->peca, lado))
-                {
-                    char msg[128];
-                    snprintf(msg, sizeof(msg), "IA jogou [%d|%d] na %s",
-                             atual->peca.lado1, atual->peca.lado2,
-                             lado == 'E' ? "ESQUERDA" : "DIREITA");
-                    mostrarMensagem(msg);
-
-                    registrar(&historico, 2, atual->peca, lado, 'J');
-                    removerPeca(&maoIA, atual->peca.lado1, atual->peca.lado2);
-                    passadas = 0;
-                    break;
-                }
+                i++;
+                modo = strcmp(argv[i], "raiz") == 0 ? MCTS_RAIZ : MCTS_ARVORE;
             }
-            atual = atual->proximo;
+            else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+                threads = atoi(argv[++i]);
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = strtoull(argv[++i], NULL, 10);
+            else
+                segundos = atof(argv[i]);
         }
+        return benchmarkMcts(segundos, modo, threads, semente);
     }
 
-    free(resposta_json);
-    turnoAtual = 1;
+    if (strcmp(argv[1], "--bench-ia") == 0 && argc >= 3)
+    {
+        int partidas = 10, gravar = 0, latencia = 0;
+        unsigned semente = 1;
+        for (int i = 3; i < argc; i++)
+        {
+            if (strcmp(argv[i], "--gravar") == 0)
+                gravar = 1;
+            else if (strcmp(argv[i], "--latencia") == 0)
+                latencia = 1;
+            else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc)
+                semente = (unsigned)atoi(argv[++i]);
+            else
+                partidas = atoi(argv[i]);
+        }
+        if (!configurarFita(&fita, gravar ? FITA_GRAVAR : FITA_REPRODUZIR, argv[2], latencia))
+        {
+            printf("Nao foi possivel abrir a fita %s\n", argv[2]);
+            return 1;
+        }
+        return benchmarkTurnoIA(partidas, semente);
+    }
+
+    printf("Uso:\n");
+    printf("  domino_clash --bench-ia <fita> [partidas] [--gravar] [--latencia] [--semente N]\n");
+    printf("  domino_clash --simular <politicaA> <politicaB> [pares] [--semente N]\n");
+    printf("  domino_clash --perft <profundidade> [--semente N]\n");
+    printf("  domino_clash --conferir-regras [partidas] [--semente N]\n");
+    printf("  domino_clash --conferir-crenca [cenarios] [--semente N]\n");
+    printf("  domino_clash --bench-mcts [segundos] [--modo raiz|arvore] [--threads N] [--semente N]\n");
+    printf("  domino_clash --gerar-tablebase <arquivo> [pecas por mao] [--threads N]\n");
+    printf("  domino_clash --gerar-livro <arquivo> [playouts por mao] [--maos N] [--threads N]\n");
+    printf("  domino_clash --tunar <arquivo> [iteracoes] [--pares N] [--threads N] [--semente N]\n");
+    printf("  domino_clash --sprt <politicaA> <politicaB> [--elo0 X] [--elo1 Y] [--alfa a] [--beta b] [--max N]\n");
+    printf("  domino_clash --destilar <arquivo> [partidas] [--professor P] [--epocas N] [--threads N]\n");
+    printf("  domino_clash --gerar-desafios <arquivo> [quantidade] [--min-pecas N] [--threads N]\n");
+    printf("  domino_clash --cfr <3|4> [iteracoes] [--mao N] [--abstracao exata|mesa] [--checkpoint arq] [--retomar arq]\n");
+    printf("  domino_clash --duplas <A> <B> [pares] [--lugares 2|4] [--threads N] [--semente N]\n");
+    printf("  domino_clash --disputa <A> <B> [pares] [--alvo N] [--threads N] [--semente N]\n");
+    printf("  domino_clash --torneio [politicas...] [--pares N] [--threads N] [--saida arq] [--fita arq [--gravar]]\n");
+    return 1;
 }
 
 // Função principal: inicializa janela e loop do jogo
-int main()
+// Com argumentos na linha de comando roda um dos modos sem janela
+int main(int argc, char **argv)
 {
+    srand(time(NULL)); // Inicializa gerador de números aleatórios
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    inicializarMotor();
+    const char *motor = getenv("DOMINO_MOTOR");
+    const char *arquivoTablebase = getenv("DOMINO_TABLEBASE");
+    if (abrirTablebase(arquivoTablebase ? arquivoTablebase : "finais.dtb", &tablebase))
+        printf("[IA] Tablebase carregada: ate %d pecas por mao\n", tablebase.maxPecas);
+    const char *arquivoLivro = getenv("DOMINO_LIVRO");
+    if (abrirLivroAbertura(arquivoLivro ? arquivoLivro : "aberturas.dab", &livroAbertura))
+        printf("[IA] Livro de aberturas carregado (%u playouts por mao)\n", livroAbertura.iteracoes);
+    const char *url = getenv("GROQ_URL");
+    if (url && url[0])
+        urlGroq = url;
+    const char *nivel = getenv("DOMINO_NIVEL");
+    aplicarNivel(nivel && nivelPorNome(nivel) >= 0 ? nivelPorNome(nivel) : nivelAtual);
+    const char *alvo = getenv("DOMINO_ALVO");
+    if (alvo && atoi(alvo) >= 1 && atoi(alvo) <= MAX_ALVO_DISPUTA)
+        disputa.alvo = atoi(alvo);
+    if (motor && strcmp(motor, "busca") == 0)
+        motorIA = MOTOR_BUSCA;
+    else if (motor && strcmp(motor, "mcts") == 0)
+        motorIA = MOTOR_MCTS;
+    else if (motor && strcmp(motor, "heuristica") == 0)
+        motorIA = MOTOR_HEURISTICA;
+    else if (motor && strcmp(motor, "destilada") == 0)
+        motorIA = MOTOR_DESTILADA;
+    const char *arquivoModelo = getenv("DOMINO_MODELO");
+    if (carregarModeloDestilado(arquivoModelo ? arquivoModelo : "destilada.mod", &modeloDestilado))
+        printf("[IA] Politica destilada carregada\n");
+    else if (motorIA == MOTOR_DESTILADA)
+    {
+        printf("[IA] Politica destilada sem modelo - usando a heuristica\n");
+        motorIA = MOTOR_HEURISTICA;
+    }
+    const char *arquivoPesos = getenv("DOMINO_PESOS");
+    if (carregarPesos(arquivoPesos ? arquivoPesos : "pesos.cfg", &pesosHeuristica))
+        printf("[IA] Pesos da heuristica carregados\n");
+    const char *analise = getenv("DOMINO_ANALISE");
+    if (analise && strcmp(analise, "0") == 0)
+        analisarPartidas = 0;
+    const char *modoMcts = getenv("DOMINO_MCTS");
+    if (modoMcts && strcmp(modoMcts, "raiz") == 0)
+        configMctsIA.modo = MCTS_RAIZ;
+
+    if (argc > 1)
+    {
+        int codigo = executarLinhaComando(argc, argv);
+        fecharTablebase(&tablebase);
+        fecharLivroAbertura(&livroAbertura);
+        curl_global_cleanup();
+        return codigo;
+    }
+
     InitWindow(SCREEN_WIDTH, SCREEN_HEIGHT, "Domino Clash - Nova(Velha) InfancIA");
     SetTargetFPS(60);
-    srand(time(NULL)); // Inicializa gerador de números aleatórios
 
     while (!WindowShouldClose())
     {
@@ -1034,8 +8399,13 @@ int main()
             switch (estadoAtual)
             {
             case TELA_MENU:
-                if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 150, 240, 300, 60}))
+                if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 160, 195, 40, 40}))
+                    aplicarNivel((nivelAtual + NUM_NIVEIS - 1) % NUM_NIVEIS);
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 + 120, 195, 40, 40}))
+                    aplicarNivel((nivelAtual + 1) % NUM_NIVEIS);
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 150, 240, 300, 60}))
                 {
+                    iniciarDisputa(disputa.alvo);
                     iniciarJogo();
                     estadoAtual = TELA_JOGO;
                 }
@@ -1044,11 +8414,18 @@ int main()
                     estadoAtual = TELA_REGRAS;
                 }
                 else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 150, 400, 300, 60}))
+                {
+                    abrirTelaDesafios();
+                    estadoAtual = TELA_DESAFIOS;
+                }
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 150, 480, 300, 60}))
                 {
                     estadoAtual = TELA_SOBRE;
                 }
-                else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 150, 480, 300, 50}))
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 150, 560, 300, 50}))
                 {
+                    encerrarAnaliseAoVivo(&analiseAoVivo);
+                    encerrarAnalisePartida(&analisePartida);
                     CloseWindow();
                     return 0;
                 }
@@ -1060,6 +8437,11 @@ int main()
                     estadoAtual = TELA_MENU;
                     break;
                 }
+                if (niveis[nivelAtual].analise && CheckCollisionPointRec(mousePos, (Rectangle){390, 570, 150, 50}))
+                {
+                    alternarDicasAoVivo(&analiseAoVivo);
+                    break;
+                }
 
                 // Processamento de cliques do jogador humano
                 if (turnoAtual == 1)
@@ -1115,8 +8497,14 @@ int main()
                     }
                     else if (CheckCollisionPointRec(mousePos, (Rectangle){220, 570, 150, 50}))
                     {
+                        // Pela regra só compra quem não tem jogada - a IA deduz
+                        // da compra que o jogador não tem os números das pontas
                         Peca nova;
-                        if (comprar(&monte, &nova))
+                        if (contarJogadas(&maoHumano, &tabuleiro) > 0)
+                        {
+                            mostrarMensagem("Voce tem jogada valida!");
+                        }
+                        else if (comprar(&monte, &nova))
                         {
                             adicionarPeca(&maoHumano, nova);
                             ordenarMao(&maoHumano);
@@ -1125,17 +8513,10 @@ int main()
                         }
                         else
                         {
-                            if (contarJogadas(&maoHumano, &tabuleiro) == 0)
-                            {
-                                mostrarMensagem("Passou a vez");
-                                passadas++;
-                                turnoAtual = 2;
-                                registrar(&historico, 1, (Peca){0, 0}, '-', 'P');
-                            }
-                            else
-                            {
-                                mostrarMensagem("Monte vazio!");
-                            }
+                            mostrarMensagem("Passou a vez");
+                            passadas++;
+                            turnoAtual = 2;
+                            registrar(&historico, 1, (Peca){0, 0}, '-', 'P');
                         }
                     }
                 }
@@ -1146,23 +8527,78 @@ int main()
                     estadoAtual = TELA_MENU;
                 break;
 
+            case TELA_DESAFIOS:
+                if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH - 180, 500, 160, 50}))
+                {
+                    estadoAtual = TELA_MENU;
+                    break;
+                }
+                if (telaDesafios.quantidade == 0)
+                    break;
+                for (int i = 0, x = 50; pecaDoDesafio(&telaDesafios.lista[telaDesafios.atual], i) >= 0;
+                     i++, x += PECA_WIDTH + 15)
+                    if (CheckCollisionPointRec(mousePos, (Rectangle){x, 300, PECA_WIDTH, PECA_HEIGHT}))
+                        pecaSelecionada = i;
+                if (CheckCollisionPointRec(mousePos, (Rectangle){50, 500, 150, 50}))
+                    ladoEscolhido = 'E';
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){220, 500, 150, 50}))
+                    ladoEscolhido = 'D';
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){50, 570, 150, 50}))
+                    responderDesafio();
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){220, 570, 150, 50}))
+                {
+                    telaDesafios.atual = (telaDesafios.atual + 1) % telaDesafios.quantidade;
+                    abrirTelaDesafios();
+                }
+                break;
+
             case TELA_SOBRE:
                 if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 100, 580, 200, 50}))
                     estadoAtual = TELA_MENU;
                 break;
 
             case TELA_FIM:
-                if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 100, 450, 200, 50}))
+                if (disputaEncerrada())
+                {
+                    if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 100, 450, 200, 50}))
+                        estadoAtual = TELA_MENU;
+                }
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 - 210, 450, 200, 50}))
+                {
+                    // A saída alterna a cada rodada
+                    disputa.primeiro ^= 1;
+                    iniciarJogo();
+                    estadoAtual = TELA_JOGO;
+                }
+                else if (CheckCollisionPointRec(mousePos, (Rectangle){SCREEN_WIDTH / 2 + 10, 450, 200, 50}))
                     estadoAtual = TELA_MENU;
                 break;
             }
         }
 
+        if (estadoAtual == TELA_MENU && IsKeyPressed(KEY_LEFT))
+            aplicarNivel((nivelAtual + NUM_NIVEIS - 1) % NUM_NIVEIS);
+        if (estadoAtual == TELA_MENU && IsKeyPressed(KEY_RIGHT))
+            aplicarNivel((nivelAtual + 1) % NUM_NIVEIS);
+        if (estadoAtual == TELA_JOGO && niveis[nivelAtual].analise && IsKeyPressed(KEY_H))
+            alternarDicasAoVivo(&analiseAoVivo);
+
+        // A análise ao vivo só roda no turno do humano (e nos níveis que a pagam)
+        if (estadoAtual == TELA_JOGO && turnoAtual == 1 && niveis[nivelAtual].analise)
+            atualizarAnaliseAoVivo(&analiseAoVivo, estadoDoJogo());
+        else
+            pausarAnaliseAoVivo(&analiseAoVivo);
+
         if (estadoAtual == TELA_JOGO && turnoAtual == 2)
         {
-            WaitTime(1.5);
-            processarTurnoIA();
+            // O lance do humano pode ter encerrado (ou travado) a partida
             vencedor = verificarVitoria();
+            if (vencedor == 0)
+            {
+                WaitTime(1.5);
+                processarTurnoIA();
+                vencedor = verificarVitoria();
+            }
             if (vencedor != 0)
                 estadoAtual = TELA_FIM;
         }
@@ -1174,6 +8610,12 @@ int main()
                 estadoAtual = TELA_FIM;
         }
 
+        if (estadoAtual == TELA_FIM)
+            registrarRodadaDisputa(vencedor);
+
+        if (estadoAtual == TELA_FIM)
+            iniciarAnalisePartida(&analisePartida, &historico, estadoDoJogo());
+
         BeginDrawing();
         ClearBackground(DARKGREEN);
 
@@ -1195,6 +8637,8 @@ int main()
             }
             else
             {
+                if (niveis[nivelAtual].analise)
+                    desenharAnaliseAoVivo(&analiseAoVivo);
                 DrawRectangle(SCREEN_WIDTH / 2 - 120, SCREEN_HEIGHT - 60, 240, 50, Fade(GREEN, 0.9f));
                 DrawText("SUA VEZ!", SCREEN_WIDTH / 2 - 60, SCREEN_HEIGHT - 45, 22, WHITE);
             }
@@ -1202,6 +8646,9 @@ int main()
         case TELA_REGRAS:
             desenharRegras();
             break;
+        case TELA_DESAFIOS:
+            desenharDesafios();
+            break;
         case TELA_SOBRE:
             desenharSobre();
             break;
@@ -1213,6 +8660,11 @@ int main()
         EndDrawing();
     }
 
+    encerrarAnaliseAoVivo(&analiseAoVivo);
+    encerrarAnalisePartida(&analisePartida);
     CloseWindow();
+    fecharTablebase(&tablebase);
+    fecharLivroAbertura(&livroAbertura);
+    curl_global_cleanup();
     return 0;
 }
\ No newline at end of file